@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "AutoBaud.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+
+/*
+ * Console output is expected to be ASCII text with escape sequences (colors, cursor).
+ */
+static bool IsPlausibleByte(const unsigned char c) {
+	return ((c >= 0x20) && (c <= 0x7e)) || (c == '\r') || (c == '\n') || (c == '\t') || (c == '\b') || (c == 0x1b);
+}
+
+double SimpleCom::ScoreBaudSample(const TBaudSample& sample) {
+	size_t len = sample.data.length();
+	if (len < autobaud_min_bytes) {
+		return 0.0;
+	}
+
+	size_t plausible = 0;
+	size_t newlines = 0;
+	for (const char c : sample.data) {
+		if (IsPlausibleByte(static_cast<unsigned char>(c))) {
+			plausible++;
+		}
+		if (c == '\n') {
+			newlines++;
+		}
+	}
+
+	// Garbage at wrong baud rate rarely contains newlines at the interval of console lines.
+	double printable_ratio = static_cast<double>(plausible) / len;
+	double newline_score = ((newlines > 0) && ((len / newlines) <= autobaud_max_line_len)) ? 1.0 : 0.0;
+	double error_ratio = (sample.slices == 0) ? 0.0 : static_cast<double>(sample.error_slices) / sample.slices;
+
+	return (0.9 * printable_ratio + 0.1 * newline_score) * (1.0 - error_ratio);
+}
+
+SimpleCom::SerialBaudSampler::SerialBaudSampler(HANDLE hSerial, const DCB& dcb) : _hSerial(hSerial) {
+	CopyMemory(&_dcb, &dcb, sizeof(_dcb));
+	_hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_hEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for auto-baud"));
+	}
+}
+
+SimpleCom::SerialBaudSampler::~SerialBaudSampler() {
+	CloseHandle(_hEvent);
+}
+
+void SimpleCom::SerialBaudSampler::SetBaudRate(DWORD baud_rate) {
+	_dcb.BaudRate = baud_rate;
+	if (!SetCommState(_hSerial, &_dcb)) {
+		throw SerialAPIException(GetLastError(), _T("SetCommState for auto-baud"));
+	}
+
+	// Data and errors at the previous baud rate should not be scored.
+	if (!PurgeComm(_hSerial, PURGE_RXABORT | PURGE_RXCLEAR)) {
+		throw SerialAPIException(GetLastError(), _T("PurgeComm for auto-baud"));
+	}
+	DWORD errors;
+	if (!ClearCommError(_hSerial, &errors, nullptr)) {
+		throw SerialAPIException(GetLastError(), _T("ClearCommError for auto-baud"));
+	}
+}
+
+void SimpleCom::SerialBaudSampler::Read(std::string& data, DWORD len) {
+	size_t pos = data.length();
+	data.resize(pos + len);
+
+	OVERLAPPED overlapped = { 0 };
+	overlapped.hEvent = _hEvent;
+	DWORD nBytesRead;
+	if (!ReadFile(_hSerial, data.data() + pos, len, &nBytesRead, &overlapped)) {
+		if (GetLastError() != ERROR_IO_PENDING) {
+			throw SerialAPIException(GetLastError(), _T("ReadFile for auto-baud"));
+		}
+		if (!GetOverlappedResult(_hSerial, &overlapped, &nBytesRead, TRUE)) {
+			throw SerialAPIException(GetLastError(), _T("GetOverlappedResult for auto-baud"));
+		}
+	}
+
+	data.resize(pos + nBytesRead);
+}
+
+SimpleCom::TBaudSample SimpleCom::SerialBaudSampler::Sample(DWORD duration_ms) {
+	TBaudSample sample = { .data = "", .slices = 0, .error_slices = 0 };
+
+	// ClearCommError() reports whether errors occurred, not the count. So errors are counted per slice.
+	for (DWORD elapsed = 0; elapsed < duration_ms; elapsed += autobaud_slice_ms) {
+		Sleep(autobaud_slice_ms);
+
+		DWORD errors;
+		COMSTAT comstat;
+		if (!ClearCommError(_hSerial, &errors, &comstat)) {
+			throw SerialAPIException(GetLastError(), _T("ClearCommError for auto-baud"));
+		}
+		sample.slices++;
+		if (errors & (CE_FRAME | CE_RXPARITY | CE_BREAK)) {
+			sample.error_slices++;
+		}
+		if (comstat.cbInQue > 0) {
+			Read(sample.data, comstat.cbInQue);
+		}
+	}
+
+	return sample;
+}
+
+SimpleCom::AutoBaudDetector::AutoBaudDetector(BaudSampler& sampler, const std::vector<DWORD>& candidates, std::function<ULONGLONG()> clock) :
+	_sampler(sampler),
+	_candidates(candidates),
+	_clock(clock),
+	_scores()
+{
+	if (_candidates.empty()) {
+		throw std::invalid_argument("Candidates of baud rate should not be empty");
+	}
+}
+
+DWORD SimpleCom::AutoBaudDetector::Detect(DWORD timeout_ms) {
+	ULONGLONG deadline = _clock() + timeout_ms;
+
+	do {
+		_scores.clear();
+		for (const DWORD baud_rate : _candidates) {
+			_sampler.SetBaudRate(baud_rate);
+			TBaudSample sample = _sampler.Sample(autobaud_sample_ms);
+			TBaudScore score = {
+				.baud_rate = baud_rate,
+				.bytes = sample.data.length(),
+				.error_slices = sample.error_slices,
+				.score = ScoreBaudSample(sample)
+			};
+			debug::log(LogLevel::DBG, _T("Auto-baud: {} baud: {} bytes, {} error slices, score {}"), score.baud_rate, score.bytes, score.error_slices, score.score);
+			_scores.push_back(score);
+		}
+
+		// The first candidate wins if scores are same.
+		const TBaudScore* best = &_scores[0];
+		for (const TBaudScore& score : _scores) {
+			if (score.score > best->score) {
+				best = &score;
+			}
+		}
+		if (best->score >= autobaud_min_score) {
+			return best->baud_rate;
+		}
+	} while (_clock() < deadline);
+
+	return 0;
+}
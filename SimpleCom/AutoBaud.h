@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Baud rates which would be tried by auto-baud detection.
+static constexpr DWORD autobaud_candidates[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600 };
+
+// RX is sampled for this period at each candidate, so one round finishes in less than a second.
+static constexpr DWORD autobaud_sample_ms = 100;
+
+// Line errors are checked at this interval while sampling.
+static constexpr DWORD autobaud_slice_ms = 10;
+
+// Sample less than this size would not be scored because it is not enough to decide.
+static constexpr size_t autobaud_min_bytes = 16;
+
+// Line longer than this is not plausible as console output.
+static constexpr size_t autobaud_max_line_len = 256;
+
+// Baud rate would be accepted only if the score is higher than this.
+static constexpr double autobaud_min_score = 0.8;
+
+// Detection would be given up after this period if the peripheral does not send enough data.
+static constexpr DWORD autobaud_timeout_ms = 5000;
+
+namespace SimpleCom {
+
+	/*
+	 * Received data at one baud rate.
+	 * error_slices is the number of slices which have framing, parity, or break error in slices.
+	 */
+	typedef struct {
+		std::string data;
+		DWORD slices;
+		DWORD error_slices;
+	} TBaudSample;
+
+	typedef struct {
+		DWORD baud_rate;
+		size_t bytes;
+		DWORD error_slices;
+		double score;
+	} TBaudScore;
+
+	/*
+	 * Score how plausible the sample is as console output (0.0 - 1.0).
+	 * It is calculated from the ratio of printable ASCII characters, frequency of newlines, and the ratio of slices with line errors.
+	 * Sample less than autobaud_min_bytes would be scored as 0.0.
+	 */
+	double ScoreBaudSample(const TBaudSample& sample);
+
+	/*
+	 * Serial port which can switch the baud rate. It can be replaced with fake port for testing.
+	 */
+	class BaudSampler
+	{
+	public:
+		virtual ~BaudSampler() {};
+
+		virtual void SetBaudRate(DWORD baud_rate) = 0;
+		virtual TBaudSample Sample(DWORD duration_ms) = 0;
+	};
+
+	/*
+	 * Samples RX from the serial handle with changing DCB.BaudRate live. The port does not need to be reopened.
+	 * The handle should be opened with FILE_FLAG_OVERLAPPED, and should not be read by others while sampling.
+	 * SerialAPIException would be thrown if the function fails.
+	 */
+	class SerialBaudSampler : public BaudSampler
+	{
+	private:
+		HANDLE _hSerial;
+		DCB _dcb;
+		HANDLE _hEvent;
+
+		void Read(std::string& data, DWORD len);
+
+	public:
+		SerialBaudSampler(HANDLE hSerial, const DCB& dcb);
+		virtual ~SerialBaudSampler();
+
+		virtual void SetBaudRate(DWORD baud_rate) override;
+		virtual TBaudSample Sample(DWORD duration_ms) override;
+	};
+
+	/*
+	 * Tries all candidates in a round, and picks the baud rate which has the best score.
+	 * Rounds would be repeated until the score is enough or the timeout.
+	 * The clock can be replaced for testing. It should return time in milliseconds.
+	 */
+	class AutoBaudDetector
+	{
+	private:
+		BaudSampler& _sampler;
+		std::vector<DWORD> _candidates;
+		std::function<ULONGLONG()> _clock;
+		std::vector<TBaudScore> _scores;
+
+	public:
+		AutoBaudDetector(BaudSampler& sampler, const std::vector<DWORD>& candidates, std::function<ULONGLONG()> clock);
+		AutoBaudDetector(BaudSampler& sampler) : AutoBaudDetector(sampler, std::vector<DWORD>(std::begin(autobaud_candidates), std::end(autobaud_candidates)), &GetTickCount64) {};
+		virtual ~AutoBaudDetector() {};
+
+		// Returns detected baud rate, or 0 if it could not be detected in timeout_ms. The sampler is left at the last candidate.
+		DWORD Detect(DWORD timeout_ms);
+
+		// Scores of the last round.
+		inline const std::vector<TBaudScore>& GetScores() const {
+			return _scores;
+		}
+	};
+
+}
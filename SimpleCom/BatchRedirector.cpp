@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -18,18 +18,22 @@
  */
 #include "stdafx.h"
 #include "BatchRedirector.h"
+#include "WinAPIException.h"
+#include "debug.h"
 
-static void RedirectHandle(HANDLE hSource, HANDLE hDest) {
-	char buf[buf_sz];
-	DWORD nBytesRead;
-	while (ReadFile(hSource, buf, sizeof(buf), &nBytesRead, NULL)) {
-		DWORD nBytesWritten;
-		DWORD nBytesRemain = nBytesRead;
-		while (nBytesRemain > 0) {
-			if (WriteFile(hDest, &buf[nBytesRead - nBytesRemain], nBytesRemain, &nBytesWritten, nullptr)) {
-				nBytesRemain -= nBytesWritten;
-			}
-		}
+/*
+ * Pass data from the source to the destination via the session pipeline.
+ */
+static void RedirectStream(SimpleCom::AsyncStream& source, SimpleCom::AsyncStream& dest) {
+	SimpleCom::WriteStage writer(dest);
+	SimpleCom::SessionPipeline pipeline(source, buf_sz);
+	pipeline.AddStage(&writer);
+
+	try {
+		pipeline.Run().Wait();
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		SimpleCom::debug::log(SimpleCom::LogLevel::ERR, _T("{}"), e.GetErrorText());
 	}
 }
 
@@ -46,8 +50,8 @@ DWORD WINAPI BatchStdInRedirector(_In_ LPVOID lpParameter) {
 	mode &= ~ENABLE_LINE_INPUT;
 	SetConsoleMode(hStdIn, mode);
 
-	HANDLE hSerial = reinterpret_cast<HANDLE>(lpParameter);
-	RedirectHandle(hStdIn, hSerial);
+	SimpleCom::BlockingStream stdin_stream(hStdIn);
+	RedirectStream(stdin_stream, *reinterpret_cast<SimpleCom::OverlappedStream*>(lpParameter));
 	return 0;
 }
 
@@ -58,15 +62,21 @@ DWORD WINAPI BatchStdOutRedirector(_In_ LPVOID lpParameter) {
 		return -1;
 	}
 
-	HANDLE hSerial = reinterpret_cast<HANDLE>(lpParameter);
-	RedirectHandle(hSerial, hStdOut);
+	SimpleCom::BlockingStream stdout_stream(hStdOut);
+	RedirectStream(*reinterpret_cast<SimpleCom::OverlappedStream*>(lpParameter), stdout_stream);
 	return 0;
 }
 
+SimpleCom::BatchRedirector::~BatchRedirector() {
+	// Redirectors use _serial_stream, so they should be finished before it is destroyed.
+	CancelIoEx(_hSerial, NULL);
+	_tasks.Await();
+}
+
 std::tuple<LPTHREAD_START_ROUTINE, LPVOID> SimpleCom::BatchRedirector::GetStdInRedirector() {
-	return { &BatchStdInRedirector, _hSerial };
+	return { &BatchStdInRedirector, &_serial_stream };
 }
 
 std::tuple<LPTHREAD_START_ROUTINE, LPVOID> SimpleCom::BatchRedirector::GetStdOutRedirector() {
-	return { &BatchStdOutRedirector, _hSerial };
+	return { &BatchStdOutRedirector, &_serial_stream };
 }
\ No newline at end of file
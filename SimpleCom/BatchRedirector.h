@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -19,19 +19,24 @@
 #pragma once
 #include "stdafx.h"
 #include "TerminalRedirectorBase.h"
+#include "SessionPipeline.h"
 
 namespace SimpleCom {
 
     class BatchRedirector :
         public TerminalRedirectorBase
     {
+    private:
+        OverlappedStream _serial_stream;
+
     protected:
         virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdInRedirector() override;
         virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdOutRedirector() override;
 
     public:
-        BatchRedirector(HANDLE hSerial) : TerminalRedirectorBase(hSerial) {};
-        virtual ~BatchRedirector() {};
+        // hSerial should be opened with FILE_FLAG_OVERLAPPED. Reader and writer share it.
+        BatchRedirector(HANDLE hSerial) : TerminalRedirectorBase(hSerial), _serial_stream(hSerial) {};
+        virtual ~BatchRedirector();
     };
 
 }
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "BroadcastRing.h"
+#include "WinAPIException.h"
+
+
+SimpleCom::BroadcastConsumer::BroadcastConsumer(BroadcastRing* ring, TBroadcastHandler handler, OverflowPolicy policy, ULONGLONG cursor) :
+	_ring(ring),
+	_handler(handler),
+	_policy(policy),
+	_cursor(cursor),
+	_dropped(0),
+	_detached(false),
+	_scheduled(false)
+{
+	// Do nothing
+}
+
+SimpleCom::BroadcastConsumer::~BroadcastConsumer() {
+	// Do nothing
+}
+
+/*
+ * Pass published data to the handler until this consumer catches up with the head.
+ * Returns true if this consumer has finished.
+ */
+bool SimpleCom::BroadcastConsumer::Drain() {
+	const ULONGLONG capacity = _ring->_capacity;
+
+	while (!_ring->_aborted.load(std::memory_order_acquire)) {
+		ULONGLONG head = _ring->_head.load(std::memory_order_acquire);
+		ULONGLONG cursor = _cursor.load(std::memory_order_relaxed);
+
+		if ((_policy == OverflowPolicy::DROP) && (head - cursor > capacity)) {
+			// The producer has lapped this consumer. Skip to the oldest data in the ring.
+			_dropped.fetch_add(head - capacity - cursor, std::memory_order_relaxed);
+			cursor = head - capacity;
+		}
+
+		if (cursor == head) {
+			if (_ring->_closed.load(std::memory_order_acquire)) {
+				// Close() is called after the last Commit(), so we can finish if we have caught up with the head at this point.
+				if (cursor == _ring->_head.load(std::memory_order_acquire)) {
+					return true;
+				}
+				continue;
+			}
+			return false;
+		}
+
+		// Pass the data in place. It would be split into two calls if the data wraps around the end of the ring.
+		DWORD offset = static_cast<DWORD>(cursor & (capacity - 1));
+		DWORD len = static_cast<DWORD>(min(head - cursor, capacity - offset));
+		try {
+			_handler(&_ring->_buf[offset], len);
+		}
+		catch (WinAPIException& e) {
+			_detached.store(true, std::memory_order_release);
+			SetEvent(_ring->_hSpaceEvent);
+			if (_ring->_exception_handler) {
+				_ring->_exception_handler(e);
+			}
+			return true;
+		}
+
+		_cursor.store(cursor + len, std::memory_order_release);
+		if (_policy == OverflowPolicy::BLOCK) {
+			SetEvent(_ring->_hSpaceEvent);
+		}
+	}
+
+	return true;
+}
+
+bool SimpleCom::BroadcastConsumer::HasWork() const noexcept {
+	return _ring->_aborted.load() || _ring->_closed.load() || (_cursor.load() != _ring->_head.load());
+}
+
+void SimpleCom::BroadcastConsumer::Run() {
+	while (!Drain()) {
+		// Commit() would not submit this consumer while it is scheduled, so new data should be checked again after clearing the flag.
+		_scheduled.store(false);
+		if (!HasWork() || _scheduled.exchange(true)) {
+			return;
+		}
+	}
+
+	// The producer should not wait for this consumer anymore. It would not be scheduled again because the flag is kept.
+	_detached.store(true, std::memory_order_release);
+	SetEvent(_ring->_hSpaceEvent);
+}
+
+SimpleCom::BroadcastRing::BroadcastRing(DWORD capacity) :
+	_capacity(capacity),
+	_head(0),
+	_consumers(),
+	_aborted(false),
+	_closed(false),
+	_started(false),
+	_exception_handler(),
+	_tasks()
+{
+	if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+		throw std::invalid_argument("Capacity of BroadcastRing should be power of 2");
+	}
+
+	_hSpaceEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (_hSpaceEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for BroadcastRing"));
+	}
+	_hAbortEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_hAbortEvent == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_hSpaceEvent);
+		throw WinAPIException(error, _T("CreateEvent for BroadcastRing"));
+	}
+
+	_buf = new char[capacity];
+}
+
+SimpleCom::BroadcastRing::~BroadcastRing() {
+	Abort();
+	_tasks.Await();
+	for (auto consumer : _consumers) {
+		delete consumer;
+	}
+
+	CloseHandle(_hAbortEvent);
+	CloseHandle(_hSpaceEvent);
+	delete[] _buf;
+}
+
+SimpleCom::BroadcastConsumer* SimpleCom::BroadcastRing::Subscribe(TBroadcastHandler handler, OverflowPolicy policy) {
+	BroadcastConsumer* consumer = new BroadcastConsumer(this, handler, policy, _head.load(std::memory_order_acquire));
+	_consumers.push_back(consumer);
+	return consumer;
+}
+
+void SimpleCom::BroadcastRing::Schedule(BroadcastConsumer* consumer) {
+	if (consumer->_scheduled.exchange(true)) {
+		// The consumer is running, or it has finished.
+		return;
+	}
+
+	try {
+		Executor::Default().Submit(_tasks, [consumer] { consumer->Run(); });
+	}
+	catch (WinAPIException&) {
+		consumer->_scheduled.store(false);
+		throw;
+	}
+}
+
+void SimpleCom::BroadcastRing::Start() {
+	// Data which is committed before Start() would be passed in this turn.
+	_started.store(true);
+	for (auto consumer : _consumers) {
+		Schedule(consumer);
+	}
+}
+
+ULONGLONG SimpleCom::BroadcastRing::GetMinBlockingCursor() const noexcept {
+	ULONGLONG result = _head.load(std::memory_order_relaxed);
+	for (auto consumer : _consumers) {
+		if ((consumer->_policy == OverflowPolicy::BLOCK) && !consumer->_detached.load(std::memory_order_acquire)) {
+			result = min(result, consumer->_cursor.load(std::memory_order_acquire));
+		}
+	}
+	return result;
+}
+
+char* SimpleCom::BroadcastRing::Claim(DWORD len, DWORD* available) {
+	ULONGLONG head = _head.load(std::memory_order_relaxed);
+	DWORD offset = static_cast<DWORD>(head & (_capacity - 1));
+	DWORD contiguous = min(len, _capacity - offset);
+	HANDLE waiters[] = { _hSpaceEvent, _hAbortEvent };
+
+	while (!_aborted.load(std::memory_order_acquire)) {
+		DWORD free_space = _capacity - static_cast<DWORD>(head - GetMinBlockingCursor());
+		if (free_space > 0) {
+			*available = min(contiguous, free_space);
+			return &_buf[offset];
+		}
+
+		// Slowest BLOCK consumer is a full lap behind.
+		if (WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, INFINITE) == WAIT_FAILED) {
+			throw WinAPIException(GetLastError(), _T("WaitForMultipleObjects in BroadcastRing"));
+		}
+	}
+
+	*available = 0;
+	return nullptr;
+}
+
+void SimpleCom::BroadcastRing::Commit(DWORD len) {
+	if (len == 0) {
+		return;
+	}
+
+	_head.fetch_add(len);
+	if (_started.load()) {
+		for (auto consumer : _consumers) {
+			Schedule(consumer);
+		}
+	}
+}
+
+bool SimpleCom::BroadcastRing::Publish(const char* data, DWORD len) {
+	while (len > 0) {
+		DWORD available;
+		char* dest = Claim(len, &available);
+		if (dest == nullptr) {
+			return false;
+		}
+
+		CopyMemory(dest, data, available);
+		Commit(available);
+		data += available;
+		len -= available;
+	}
+
+	return true;
+}
+
+void SimpleCom::BroadcastRing::Close() {
+	_closed.store(true);
+	if (_started.load()) {
+		for (auto consumer : _consumers) {
+			Schedule(consumer);
+		}
+	}
+}
+
+void SimpleCom::BroadcastRing::Abort() {
+	// Running consumers would see the flag. Idle consumers do not have any task to finish.
+	_aborted.store(true);
+	SetEvent(_hAbortEvent);
+}
+
+void SimpleCom::BroadcastRing::Shutdown() {
+	Close();
+	_tasks.Await();
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "WinAPIException.h"
+#include "Executor.h"
+
+namespace SimpleCom {
+
+	/*
+	 * What happens when the producer catches up with a consumer.
+	 *   BLOCK: The producer waits until the consumer releases the data. Nothing would be lost.
+	 *   DROP:  The producer overwrites the data which the consumer has not read yet.
+	 *          The consumer skips to the oldest available data, and the skipped bytes are counted.
+	 *          Data which is being passed to the handler might be overwritten while the handler is running.
+	 */
+	enum class OverflowPolicy {
+		BLOCK,
+		DROP
+	};
+
+	typedef std::function<void(const char* data, const DWORD len)> TBroadcastHandler;
+
+	/* Forward declaration */
+	class BroadcastRing;
+
+	/*
+	 * Consumer of BroadcastRing.
+	 * Each consumer has its own cursor. It is submitted to the executor when new data is committed, and the handler is called on it.
+	 * The task finishes when the consumer catches up with the producer, so idle consumers do not occupy any worker.
+	 */
+	class BroadcastConsumer {
+		friend class BroadcastRing;
+
+	private:
+		BroadcastRing* _ring;
+		TBroadcastHandler _handler;
+		OverflowPolicy _policy;
+		std::atomic<ULONGLONG> _cursor;
+		std::atomic<ULONGLONG> _dropped;
+		std::atomic<bool> _detached;
+		std::atomic<bool> _scheduled;
+
+		bool Drain();
+		bool HasWork() const noexcept;
+
+	public:
+		BroadcastConsumer(BroadcastRing* ring, TBroadcastHandler handler, OverflowPolicy policy, ULONGLONG cursor);
+		virtual ~BroadcastConsumer();
+
+		void Run();
+
+		inline OverflowPolicy GetPolicy() const noexcept {
+			return _policy;
+		}
+
+		inline ULONGLONG GetCursor() const noexcept {
+			return _cursor.load(std::memory_order_acquire);
+		}
+
+		// Number of bytes which were overwritten before this consumer reads them (DROP only).
+		inline ULONGLONG GetDropped() const noexcept {
+			return _dropped.load(std::memory_order_relaxed);
+		}
+	};
+
+	/*
+	 * Single-producer, multi-consumer broadcast ring buffer.
+	 * The producer writes data once, and every consumer reads it in place via its own cursor.
+	 * Sequences are byte offsets from the beginning of the stream, so they never wrap.
+	 *
+	 * Claim() / Commit() / Publish() must be called from one thread only.
+	 * Subscribe() must be called before Start().
+	 */
+	class BroadcastRing
+	{
+		friend class BroadcastConsumer;
+
+	private:
+		char* _buf;
+		DWORD _capacity;
+		std::atomic<ULONGLONG> _head;
+		std::vector<BroadcastConsumer*> _consumers;
+		HANDLE _hSpaceEvent;
+		HANDLE _hAbortEvent;
+		std::atomic<bool> _aborted;
+		std::atomic<bool> _closed;
+		std::atomic<bool> _started;
+		std::function<void(const WinAPIException&)> _exception_handler;
+		TaskGroup _tasks;
+
+		ULONGLONG GetMinBlockingCursor() const noexcept;
+		void Schedule(BroadcastConsumer* consumer);
+
+	public:
+		// capacity should be power of 2.
+		BroadcastRing(DWORD capacity);
+		virtual ~BroadcastRing();
+
+		BroadcastConsumer* Subscribe(TBroadcastHandler handler, OverflowPolicy policy);
+
+		inline void SetExceptionHandler(std::function<void(const WinAPIException&)> handler) {
+			_exception_handler = handler;
+		}
+
+		void Start();
+
+		// Returns writable area which is contiguous in the ring, or nullptr if the ring is aborted.
+		// *available is set to the number of bytes which can be written, and it might be less than len.
+		char* Claim(DWORD len, DWORD* available);
+		void Commit(DWORD len);
+
+		// Copies data into the ring, and makes it visible to all consumers.
+		// Returns false if the ring is aborted.
+		bool Publish(const char* data, DWORD len);
+
+		// Consumers would be finished after they read all of published data.
+		void Close();
+
+		// Consumers would be finished immediately. Unread data would be discarded.
+		void Abort();
+
+		// Close() and wait for all of consumer tasks.
+		void Shutdown();
+
+		inline ULONGLONG GetHead() const noexcept {
+			return _head.load(std::memory_order_acquire);
+		}
+
+		inline DWORD GetCapacity() const noexcept {
+			return _capacity;
+		}
+	};
+
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "DeviceIndex.h"
+
+static constexpr LPCTSTR FTDIBUS_ENUMERATOR = _T("FTDIBUS\\");
+
+static TString ToUpper(const TString& str) {
+	TString result = str;
+	std::transform(result.begin(), result.end(), result.begin(), [](TCHAR c) { return static_cast<TCHAR>(_totupper(c)); });
+	return result;
+}
+
+void SimpleCom::DeviceIndex::ParseInstanceId(TDeviceInfo* info) {
+	const TString& id = info->instance_id;
+	info->vid.clear();
+	info->pid.clear();
+	info->serial.clear();
+
+	size_t vid_pos = id.find(_T("VID_"));
+	size_t pid_pos = (vid_pos == TString::npos) ? TString::npos : id.find(_T("PID_"), vid_pos);
+	if ((pid_pos == TString::npos) || (pid_pos + 8 > id.length())) {
+		// Not a USB device
+		return;
+	}
+	info->vid = id.substr(vid_pos + 4, 4);
+	info->pid = id.substr(pid_pos + 4, 4);
+
+	// USB\VID_0403&PID_6001\A50285BI (usbser, CDC ACM)
+	// FTDIBUS\VID_0403+PID_6001+A50285BIA\0000 (FTDI VCP driver)
+	size_t serial_pos;
+	if (id[pid_pos + 8] == _T('+')) {
+		serial_pos = pid_pos + 9;
+	}
+	else {
+		serial_pos = id.find(_T('\\'), pid_pos);
+		if (serial_pos == TString::npos) {
+			return;
+		}
+		serial_pos++;
+	}
+
+	TString serial = id.substr(serial_pos, id.find(_T('\\'), serial_pos) - serial_pos);
+	// Windows generates instance ID which contains `&` (e.g. 6&1A2B3C4D&0&2) if the device does not have serial number.
+	if (serial.find(_T('&')) == TString::npos) {
+		info->serial = serial;
+	}
+}
+
+TString SimpleCom::DeviceIndex::UsbKey(const TString& vid, const TString& pid, const TString& serial) {
+	return ToUpper(vid + _T(":") + pid + _T(":") + serial);
+}
+
+/*
+ * Keys of the serial number in the index. Serial number of the adapter is added for channel A of FTDI VCP driver.
+ */
+std::vector<TString> SimpleCom::DeviceIndex::SerialKeys(const TDeviceInfo& info) {
+	std::vector<TString> keys;
+	if (info.serial.empty()) {
+		return keys;
+	}
+
+	keys.push_back(ToUpper(info.serial));
+	if ((info.instance_id.compare(0, _tcslen(FTDIBUS_ENUMERATOR), FTDIBUS_ENUMERATOR) == 0) && (keys[0].length() > 1) && (keys[0].back() == _T('A'))) {
+		keys.push_back(keys[0].substr(0, keys[0].length() - 1));
+	}
+	return keys;
+}
+
+/*
+ * Look up the key. The key in the form of FTDI VCP driver (with channel A) would match the adapter which is bound to another driver.
+ */
+const SimpleCom::TDeviceInfo* SimpleCom::DeviceIndex::Find(const std::unordered_map<TString, TString>& index, const TString& key) const {
+	auto itr = index.find(key);
+	if ((itr == index.end()) && (key.length() > 1) && (key.back() == _T('A'))) {
+		itr = index.find(key.substr(0, key.length() - 1));
+	}
+	return (itr == index.end()) ? nullptr : FindByPort(itr->second);
+}
+
+void SimpleCom::DeviceIndex::Remove(std::map<TString, TDeviceInfo>::iterator itr) {
+	const TDeviceInfo& info = itr->second;
+
+	// Another port might be indexed with same serial number if the adapter has been re-enumerated.
+	for (const TString& serial : SerialKeys(info)) {
+		auto serial_itr = _port_by_serial.find(serial);
+		if ((serial_itr != _port_by_serial.end()) && (serial_itr->second == itr->first)) {
+			_port_by_serial.erase(serial_itr);
+		}
+		auto usb_itr = _port_by_usb.find(UsbKey(info.vid, info.pid, serial));
+		if ((usb_itr != _port_by_usb.end()) && (usb_itr->second == itr->first)) {
+			_port_by_usb.erase(usb_itr);
+		}
+	}
+
+	_devices.erase(itr);
+}
+
+bool SimpleCom::DeviceIndex::Sync(const TDeviceMap& ports) {
+	for (auto itr = _devices.begin(); itr != _devices.end(); ) {
+		auto port = ports.find(itr->first);
+		if ((port == ports.end()) || (port->second != itr->second.iface)) {
+			Remove(itr++);
+		}
+		else {
+			itr++;
+		}
+	}
+
+	return _devices.size() < ports.size();
+}
+
+void SimpleCom::DeviceIndex::Put(const TDeviceInfo& info) {
+	auto itr = _devices.find(info.port);
+	if (itr != _devices.end()) {
+		Remove(itr);
+	}
+
+	_devices[info.port] = info;
+	for (const TString& serial : SerialKeys(info)) {
+		_port_by_serial[serial] = info.port;
+		_port_by_usb[UsbKey(info.vid, info.pid, serial)] = info.port;
+	}
+}
+
+const SimpleCom::TDeviceInfo* SimpleCom::DeviceIndex::FindByPort(const TString& port) const {
+	auto itr = _devices.find(port);
+	return (itr == _devices.end()) ? nullptr : &itr->second;
+}
+
+const SimpleCom::TDeviceInfo* SimpleCom::DeviceIndex::FindBySerial(const TString& serial) const {
+	return Find(_port_by_serial, ToUpper(serial));
+}
+
+const SimpleCom::TDeviceInfo* SimpleCom::DeviceIndex::FindByUsb(const TString& vid, const TString& pid, const TString& serial) const {
+	return Find(_port_by_usb, UsbKey(vid, pid, serial));
+}
+
+TString SimpleCom::DeviceIndex::Resolve(const TString& selector) const {
+	static const size_t serial_prefix_len = _tcslen(PORT_SELECTOR_SERIAL);
+	static const size_t usb_prefix_len = _tcslen(PORT_SELECTOR_USB);
+	const TDeviceInfo* info = nullptr;
+
+	if (selector.compare(0, serial_prefix_len, PORT_SELECTOR_SERIAL) == 0) {
+		info = FindBySerial(selector.substr(serial_prefix_len));
+	}
+	else if (selector.compare(0, usb_prefix_len, PORT_SELECTOR_USB) == 0) {
+		// VID and PID are 4 hex digits, so the serial number starts at the fixed position.
+		if ((selector.length() > usb_prefix_len + 10) && (selector[usb_prefix_len + 4] == _T(':')) && (selector[usb_prefix_len + 9] == _T(':'))) {
+			info = FindByUsb(selector.substr(usb_prefix_len, 4), selector.substr(usb_prefix_len + 5, 4), selector.substr(usb_prefix_len + 10));
+		}
+	}
+	else {
+		// COM port would be opened as is even if it is not in the index.
+		return selector;
+	}
+
+	return (info == nullptr) ? TString() : info->port;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Port in command line can be specified with the serial number of the adapter with these prefixes.
+static constexpr LPCTSTR PORT_SELECTOR_SERIAL = _T("serial:");  // serial:[serial number]
+static constexpr LPCTSTR PORT_SELECTOR_USB = _T("usb:");        // usb:[VID]:[PID]:[serial number]
+
+namespace SimpleCom {
+
+	typedef std::map<TString, TString> TDeviceMap;
+
+	/*
+	 * Metadata of serial device. vid, pid, and serial are empty if they are not available.
+	 * serial is empty if it is generated by Windows (it is not stable across USB ports).
+	 */
+	typedef struct {
+		TString port;
+		TString iface;
+		TString instance_id;
+		TString description;
+		TString vid;
+		TString pid;
+		TString serial;
+	} TDeviceInfo;
+
+	/*
+	 * Cache of device metadata. It is keyed by port name, and is indexed by serial number of the adapter.
+	 * Metadata would be refreshed only for ports which are arrived or re-assigned, so large number of ports can be handled cheaply.
+	 *
+	 * Serial numbers are case insensitive. FTDI VCP driver appends the channel (A - D) to the serial number of the adapter
+	 * (e.g. A50285BIA for A50285BI), so both forms would be matched for channel A regardless of the driver.
+	 */
+	class DeviceIndex
+	{
+	private:
+		std::map<TString, TDeviceInfo> _devices;
+		std::unordered_map<TString, TString> _port_by_serial;
+		std::unordered_map<TString, TString> _port_by_usb;
+
+		static TString UsbKey(const TString& vid, const TString& pid, const TString& serial);
+		static std::vector<TString> SerialKeys(const TDeviceInfo& info);
+		const TDeviceInfo* Find(const std::unordered_map<TString, TString>& index, const TString& key) const;
+		void Remove(std::map<TString, TDeviceInfo>::iterator itr);
+
+	public:
+		DeviceIndex() : _devices(), _port_by_serial(), _port_by_usb() {};
+		virtual ~DeviceIndex() {};
+
+		// Set vid, pid, and serial from device instance ID (e.g. USB\VID_0403&PID_6001\A50285BI).
+		static void ParseInstanceId(TDeviceInfo* info);
+
+		/*
+		 * Drop ports which are not in ports, or which are assigned to another interface.
+		 * Returns true if some ports in ports need metadata via Put().
+		 */
+		bool Sync(const TDeviceMap& ports);
+
+		void Put(const TDeviceInfo& info);
+
+		// Returns nullptr if the port is not found.
+		const TDeviceInfo* FindByPort(const TString& port) const;
+		const TDeviceInfo* FindBySerial(const TString& serial) const;
+		const TDeviceInfo* FindByUsb(const TString& vid, const TString& pid, const TString& serial) const;
+
+		// Resolve port selector (COM[N], serial:[serial number], or usb:[VID]:[PID]:[serial number]) to port name.
+		// Returns empty string if the adapter is not found. This is called for each attempt of reconnection, so it is just a lookup of hash table.
+		TString Resolve(const TString& selector) const;
+
+		inline const std::map<TString, TDeviceInfo>& GetDevices() const {
+			return _devices;
+		}
+	};
+
+}
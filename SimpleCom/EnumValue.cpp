@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, Yasumasa Suenaga
+ * Copyright (C) 2023, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -36,4 +36,5 @@
 
 DECLARE_ENUM_INSTANCE(Parity, FOR_EACH_PARITY_ENUMS)
 DECLARE_ENUM_INSTANCE(FlowControl, FOR_EACH_FLOWCTL_ENUMS)
-DECLARE_ENUM_INSTANCE(StopBits, FOR_EACH_STOPBITS_ENUMS)
\ No newline at end of file
+DECLARE_ENUM_INSTANCE(StopBits, FOR_EACH_STOPBITS_ENUMS)
+DECLARE_ENUM_INSTANCE(LogLevel, FOR_EACH_LOGLEVEL_ENUMS)
\ No newline at end of file
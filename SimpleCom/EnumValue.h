@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019, 2023, Yasumasa Suenaga
+ * Copyright (C) 2019, 2023, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -37,6 +37,13 @@
   f(StopBits, ONE5, ONE5STOPBITS, _T("1.5")) \
   f(StopBits, TWO,  TWOSTOPBITS,  _T("2"))
 
+#define FOR_EACH_LOGLEVEL_ENUMS(f) \
+  f(LogLevel, NONE, 0, _T("none"))  \
+  f(LogLevel, ERR,  1, _T("error")) \
+  f(LogLevel, WARN, 2, _T("warn"))  \
+  f(LogLevel, INFO, 3, _T("info"))  \
+  f(LogLevel, DBG,  4, _T("debug"))
+
 
 namespace SimpleCom {
 
@@ -138,4 +145,30 @@ namespace SimpleCom {
 
 	};
 
+	/* Enum for log level. Messages at the level or more severe would be logged. */
+	class LogLevel : public EnumValue {
+	public:
+		constexpr explicit LogLevel(const int value, LPCTSTR str) noexcept : EnumValue(value, str) {};
+
+#define DECLARE_ENUM(cls, name, value, str) \
+		static const cls name;
+
+		FOR_EACH_LOGLEVEL_ENUMS(DECLARE_ENUM)
+#undef DECLARE_ENUM
+
+		static const std::vector<LogLevel> values;
+
+		inline static TString valueopts() {
+			TString str = _T("[");
+			for (auto& value : values) {
+				str += value.tstr();
+				str += _T('|');
+			}
+			str[str.length() - 1] = _T(']');
+
+			return str;
+		}
+
+	};
+
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "Executor.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+static constexpr ULONG_PTR EXECUTOR_KEY_TASK = 1;
+static constexpr ULONG_PTR EXECUTOR_KEY_QUIT = 2;
+
+typedef struct {
+	std::function<void()> func;
+	SimpleCom::TaskGroup* group;
+	LONGLONG submitted_at;
+} TExecutorTask;
+
+static INIT_ONCE default_executor_init_once = INIT_ONCE_STATIC_INIT;
+static SimpleCom::Executor* default_executor = nullptr;
+
+
+SimpleCom::TaskGroup::TaskGroup() :
+	_running(0),
+	_scheduling_latency()
+{
+	InitializeSRWLock(&_lock);
+	_hIdleEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
+	if (_hIdleEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for TaskGroup"));
+	}
+}
+
+SimpleCom::TaskGroup::~TaskGroup() {
+	// Running tasks might refer the owner of this group.
+	Await();
+	CloseHandle(_hIdleEvent);
+}
+
+void SimpleCom::TaskGroup::Begin() {
+	// The event is updated in the lock, so it would not be signaled by End() of another task in the meantime.
+	AcquireSRWLockExclusive(&_lock);
+	if (_running++ == 0) {
+		ResetEvent(_hIdleEvent);
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::TaskGroup::RecordSchedulingLatency(ULONGLONG latency_us) {
+	AcquireSRWLockExclusive(&_lock);
+	_scheduling_latency.Record(latency_us);
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::TaskGroup::End() {
+	AcquireSRWLockExclusive(&_lock);
+	if (--_running == 0) {
+		SetEvent(_hIdleEvent);
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::TaskGroup::Await() {
+	WaitForSingleObject(_hIdleEvent, INFINITE);
+
+	// End() signals the event in the lock. Wait for it to be released because the group might be destroyed after this.
+	AcquireSRWLockExclusive(&_lock);
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+SimpleCom::LatencyHistogram SimpleCom::TaskGroup::GetSchedulingLatency() {
+	AcquireSRWLockShared(&_lock);
+	LatencyHistogram histogram = _scheduling_latency;
+	ReleaseSRWLockShared(&_lock);
+	return histogram;
+}
+
+/*
+ * Entry point for worker thread.
+ */
+static DWORD WINAPI ExecutorWorkerEntry(_In_ LPVOID lpParameter) {
+	SimpleCom::Executor* executor = reinterpret_cast<SimpleCom::Executor*>(lpParameter);
+	executor->Run();
+	return 0;
+}
+
+SimpleCom::Executor::Executor() :
+	_workers(0),
+	_idle(0)
+{
+	InitializeSRWLock(&_lock);
+	QueryPerformanceFrequency(&_freq);
+
+	// Tasks are blocking loops in most cases, so the port should not limit running workers.
+	_hPort = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, MAXDWORD);
+	if (_hPort == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateIoCompletionPort for Executor"));
+	}
+	_hNoWorkerEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
+	if (_hNoWorkerEvent == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_hPort);
+		throw WinAPIException(error, _T("CreateEvent for Executor"));
+	}
+}
+
+SimpleCom::Executor::~Executor() {
+	AcquireSRWLockShared(&_lock);
+	DWORD workers = _workers;
+	ReleaseSRWLockShared(&_lock);
+
+	// Busy workers would receive it after the current task.
+	for (DWORD idx = 0; idx < workers; idx++) {
+		PostQueuedCompletionStatus(_hPort, 0, EXECUTOR_KEY_QUIT, nullptr);
+	}
+	WaitForSingleObject(_hNoWorkerEvent, INFINITE);
+
+	CloseHandle(_hNoWorkerEvent);
+	CloseHandle(_hPort);
+}
+
+static BOOL CALLBACK InitDefaultExecutor(PINIT_ONCE InitOnce, PVOID Parameter, PVOID* Context) {
+	try {
+		default_executor = new SimpleCom::Executor();
+		return TRUE;
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		SimpleCom::debug::log(SimpleCom::LogLevel::ERR, _T("{}"), e.GetErrorText());
+		return FALSE;
+	}
+}
+
+SimpleCom::Executor& SimpleCom::Executor::Default() {
+	if (!InitOnceExecuteOnce(&default_executor_init_once, &InitDefaultExecutor, nullptr, nullptr)) {
+		throw WinAPIException(_T("Executor"), _T("Executor is not available"));
+	}
+	return *default_executor;
+}
+
+void SimpleCom::Executor::Submit(TaskGroup& group, std::function<void()> task) {
+	TExecutorTask* packet = new TExecutorTask{ .func = task, .group = &group, .submitted_at = 0 };
+	group.Begin();
+
+	// Reserve an idle worker for this task, or start new one.
+	AcquireSRWLockExclusive(&_lock);
+	if (_idle > 0) {
+		_idle--;
+	}
+	else {
+		HANDLE hThread = CreateThread(NULL, 0, &ExecutorWorkerEntry, this, 0, NULL);
+		if (hThread == NULL) {
+			DWORD error = GetLastError();
+			ReleaseSRWLockExclusive(&_lock);
+			group.End();
+			delete packet;
+			throw WinAPIException(error, _T("CreateThread for Executor"));
+		}
+		CloseHandle(hThread);
+		if (_workers++ == 0) {
+			ResetEvent(_hNoWorkerEvent);
+		}
+	}
+	ReleaseSRWLockExclusive(&_lock);
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	packet->submitted_at = now.QuadPart;
+	if (!PostQueuedCompletionStatus(_hPort, 0, EXECUTOR_KEY_TASK, reinterpret_cast<LPOVERLAPPED>(packet))) {
+		// Reserved worker is still waiting on the port, so it is idle.
+		DWORD error = GetLastError();
+		AcquireSRWLockExclusive(&_lock);
+		_idle++;
+		ReleaseSRWLockExclusive(&_lock);
+		group.End();
+		delete packet;
+		throw WinAPIException(error, _T("PostQueuedCompletionStatus for Executor"));
+	}
+}
+
+void SimpleCom::Executor::Run() {
+	while (true) {
+		DWORD n_bytes;
+		ULONG_PTR key;
+		LPOVERLAPPED overlapped;
+		if (!GetQueuedCompletionStatus(_hPort, &n_bytes, &key, &overlapped, INFINITE) || (key != EXECUTOR_KEY_TASK)) {
+			break;
+		}
+
+		TExecutorTask* packet = reinterpret_cast<TExecutorTask*>(overlapped);
+		LARGE_INTEGER now;
+		QueryPerformanceCounter(&now);
+		packet->group->RecordSchedulingLatency(((now.QuadPart - packet->submitted_at) * 1000000) / _freq.QuadPart);
+
+		// Tasks should handle their errors. This is the last resort to keep the worker and to finish the task in the group.
+		try {
+			try {
+				packet->func();
+			}
+			catch (WinAPIException& e) {
+				debug::log(LogLevel::ERR, _T("{}"), e.GetErrorText());
+			}
+			catch (std::exception& e) {
+				// Only ASCII chars should be converted to wchar, so we can ignore deprecation since C++17.
+				std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> conv;
+				debug::log(LogLevel::ERR, _T("Unexpected exception in the task: {}"), conv.from_bytes(e.what()));
+			}
+			catch (...) {
+				debug::log(LogLevel::ERR, _T("Unknown exception in the task"));
+			}
+		}
+		catch (...) {
+			// Logging itself has been failed (e.g. std::format_error). Nothing can be done here.
+		}
+
+		// Captures of the task should be released before the owner of the group is notified.
+		TaskGroup* group = packet->group;
+		delete packet;
+
+		// This worker should be available for the next task before Await() of the group returns.
+		AcquireSRWLockExclusive(&_lock);
+		bool retire = (_idle >= executor_max_idle_workers);
+		if (!retire) {
+			_idle++;
+		}
+		ReleaseSRWLockExclusive(&_lock);
+
+		group->End();
+		if (retire) {
+			break;
+		}
+	}
+
+	AcquireSRWLockExclusive(&_lock);
+	if (--_workers == 0) {
+		SetEvent(_hNoWorkerEvent);
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+DWORD SimpleCom::Executor::GetWorkerCount() {
+	AcquireSRWLockShared(&_lock);
+	DWORD workers = _workers;
+	ReleaseSRWLockShared(&_lock);
+	return workers;
+}
+
+DWORD SimpleCom::Executor::GetIdleWorkerCount() {
+	AcquireSRWLockShared(&_lock);
+	DWORD idle = _idle;
+	ReleaseSRWLockShared(&_lock);
+	return idle;
+}
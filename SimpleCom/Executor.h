@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "LatencyHistogram.h"
+
+// Idle workers would be kept up to this number for next tasks. Extra workers would exit when they become idle.
+static constexpr DWORD executor_max_idle_workers = 8;
+
+namespace SimpleCom {
+
+	/*
+	 * Tasks which belong to one owner (e.g. redirectors of a session).
+	 * Await() waits until all of tasks in the group are finished.
+	 * Latency from Submit() to the start of each task is recorded in microseconds.
+	 */
+	class TaskGroup
+	{
+		friend class Executor;
+
+	private:
+		SRWLOCK _lock;
+		LONG _running;
+		HANDLE _hIdleEvent;
+		LatencyHistogram _scheduling_latency;
+
+		void Begin();
+		void RecordSchedulingLatency(ULONGLONG latency_us);
+		void End();
+
+	public:
+		TaskGroup();
+		virtual ~TaskGroup();
+
+		void Await();
+
+		// Snapshot of the histogram. It can be called while tasks are running.
+		LatencyHistogram GetSchedulingLatency();
+	};
+
+	/*
+	 * Pool of reusable worker threads which receive tasks via I/O completion port as the work queue.
+	 * It is not an asynchronous runtime: each task occupies one worker until it returns.
+	 * Tasks may block (e.g. redirector loops hold workers for whole of the session), so new worker would be started if there is no idle worker.
+	 * Workers are reused for next tasks, so sessions after reconnection do not create threads again.
+	 */
+	class Executor
+	{
+	private:
+		HANDLE _hPort;
+		SRWLOCK _lock;
+		DWORD _workers;
+		DWORD _idle;
+		HANDLE _hNoWorkerEvent;
+		LARGE_INTEGER _freq;
+
+	public:
+		Executor();
+		virtual ~Executor();
+
+		// Executor which is shared in SimpleCom process. It would not be destroyed.
+		static Executor& Default();
+
+		void Submit(TaskGroup& group, std::function<void()> task);
+
+		// Worker loop. This is called on worker threads only.
+		void Run();
+
+		DWORD GetWorkerCount();
+		DWORD GetIdleWorkerCount();
+	};
+
+}
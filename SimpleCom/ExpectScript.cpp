@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ExpectScript.h"
+#include "ScriptTokenizer.h"
+#include "EnumValue.h"
+#include "util.h"
+
+
+SimpleCom::ExpectScript::ExpectScript(const std::string& source) :
+	_steps(),
+	_finished(false),
+	_exit_code(0),
+	_result_message()
+{
+	Parse(source);
+}
+
+SimpleCom::ExpectScript SimpleCom::ExpectScript::FromFile(LPCTSTR filename) {
+	return ExpectScript(ReadWholeFile(filename));
+}
+
+void SimpleCom::ExpectScript::Parse(const std::string& source) {
+	std::vector<std::string> fail_patterns;
+	std::vector<int> fail_codes;
+	std::istringstream stream(source);
+	std::string line;
+	int line_num = 0;
+
+	while (std::getline(stream, line)) {
+		line_num++;
+		std::vector<TScriptToken> tokens = TokenizeScriptLine(line, line_num);
+		if (tokens.empty()) {
+			continue;
+		}
+
+		const std::string& command = tokens[0].text;
+		std::vector<TScriptToken> args(tokens.begin() + 1, tokens.end());
+		TScriptStep step = { .line = line_num, .data = "", .value = 0, .num_expected = 0 };
+
+		if (tokens[0].quoted) {
+			ThrowScriptSyntaxError(line_num, "Command is expected: \"" + command + "\"");
+		}
+		else if (command == "expect") {
+			if (args.empty()) {
+				ThrowScriptSyntaxError(line_num, "expect needs at least one pattern");
+			}
+
+			std::vector<std::string> patterns;
+			for (auto& arg : args) {
+				if (!arg.quoted || arg.text.empty()) {
+					ThrowScriptSyntaxError(line_num, "Pattern should be non-empty string");
+				}
+				patterns.push_back(arg.text);
+			}
+			step.command = ScriptCommand::EXPECT;
+			step.num_expected = static_cast<int>(patterns.size());
+			step.fail_codes = fail_codes;
+			patterns.insert(patterns.end(), fail_patterns.begin(), fail_patterns.end());
+			step.matcher = MultiPatternMatcher(patterns);
+		}
+		else if (command == "send") {
+			if (args.size() != 1 || !args[0].quoted) {
+				ThrowScriptSyntaxError(line_num, "send needs one string");
+			}
+			step.command = ScriptCommand::SEND;
+			step.data = args[0].text;
+		}
+		else if (command == "sleep") {
+			if (args.size() != 1) {
+				ThrowScriptSyntaxError(line_num, "sleep needs milliseconds");
+			}
+			step.command = ScriptCommand::SLEEP;
+			step.value = ParseScriptNumber(args[0], line_num);
+		}
+		else if (command == "timeout") {
+			if (args.size() != 1) {
+				ThrowScriptSyntaxError(line_num, "timeout needs seconds");
+			}
+			step.command = ScriptCommand::TIMEOUT;
+			step.value = ParseScriptNumber(args[0], line_num);
+			if (step.value > INT_MAX / 1000) {
+				ThrowScriptSyntaxError(line_num, "timeout is too large");
+			}
+			step.value *= 1000;
+		}
+		else if (command == "fail") {
+			// `fail` is not a step. It affects following `expect`.
+			if (args.empty() || args.size() > 2 || !args[0].quoted || args[0].text.empty()) {
+				ThrowScriptSyntaxError(line_num, "fail needs a pattern and optional exit code");
+			}
+			fail_patterns.push_back(args[0].text);
+			fail_codes.push_back((args.size() == 2) ? ParseScriptNumber(args[1], line_num) : 1);
+			continue;
+		}
+		else if (command == "break") {
+			if (args.size() > 1) {
+				ThrowScriptSyntaxError(line_num, "break accepts only milliseconds");
+			}
+			step.command = ScriptCommand::BREAK;
+			step.value = args.empty() ? modem_default_break_ms : ParseScriptNumber(args[0], line_num);
+		}
+		else if ((command == "dtr") || (command == "rts")) {
+			if ((args.size() != 1) || args[0].quoted || ((args[0].text != "on") && (args[0].text != "off"))) {
+				ThrowScriptSyntaxError(line_num, command + " needs on or off");
+			}
+			step.command = (command == "dtr") ? ScriptCommand::DTR : ScriptCommand::RTS;
+			step.value = (args[0].text == "on") ? 1 : 0;
+		}
+		else if (command == "baud") {
+			if (args.size() != 1) {
+				ThrowScriptSyntaxError(line_num, "baud needs baud rate");
+			}
+			step.command = ScriptCommand::BAUD;
+			step.value = ParseScriptNumber(args[0], line_num);
+			if (step.value == 0) {
+				ThrowScriptSyntaxError(line_num, "baud rate should be positive");
+			}
+		}
+		else if (command == "flow") {
+			step.command = ScriptCommand::FLOW;
+			step.value = -1;
+			if ((args.size() == 1) && !args[0].quoted) {
+				TString arg(args[0].text.begin(), args[0].text.end());
+				for (auto& flow_control : FlowControl::values) {
+					if (arg == flow_control.tstr()) {
+						step.value = flow_control;
+					}
+				}
+			}
+			if (step.value < 0) {
+				ThrowScriptSyntaxError(line_num, "flow needs none, hardware, or software");
+			}
+		}
+		else if (command == "exit") {
+			if (args.size() > 1) {
+				ThrowScriptSyntaxError(line_num, "exit accepts only exit code");
+			}
+			step.command = ScriptCommand::EXIT;
+			step.value = args.empty() ? 0 : ParseScriptNumber(args[0], line_num);
+		}
+		else {
+			ThrowScriptSyntaxError(line_num, "Unknown command: " + command);
+		}
+
+		_steps.push_back(step);
+	}
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "MultiPatternMatcher.h"
+#include "ModemControl.h"
+
+// Exit code when `expect` is timed out.
+static constexpr int SCRIPT_EXIT_TIMEOUT = 124;
+
+// Exit code when the session is finished before the script.
+static constexpr int SCRIPT_EXIT_ABORTED = 125;
+
+// Default timeout of `expect` in milliseconds.
+static constexpr DWORD SCRIPT_DEFAULT_TIMEOUT = 10000;
+
+namespace SimpleCom {
+
+	enum class ScriptCommand {
+		EXPECT,
+		SEND,
+		SLEEP,
+		TIMEOUT,
+		BREAK,
+		DTR,
+		RTS,
+		BAUD,
+		FLOW,
+		EXIT
+	};
+
+	/*
+	 * A step of the script.
+	 *   EXPECT:  Patterns in [0, num_expected) in matcher are expected ones.
+	 *            Rest of them are `fail` patterns, and fail_codes holds exit code for each of them.
+	 *   SEND:    data holds bytes to send.
+	 *   SLEEP:   value is in milliseconds.
+	 *   TIMEOUT: value is in milliseconds. 0 means infinite.
+	 *   BREAK:   value is duration in milliseconds.
+	 *   DTR/RTS: value is 1 (on) or 0 (off).
+	 *   BAUD:    value is baud rate.
+	 *   FLOW:    value is FlowControl.
+	 *   EXIT:    value is exit code.
+	 */
+	typedef struct {
+		ScriptCommand command;
+		int line;
+		std::string data;
+		int value;
+		int num_expected;
+		std::vector<int> fail_codes;
+		MultiPatternMatcher matcher;
+	} TScriptStep;
+
+	/*
+	 * Script for automated console interaction.
+	 * Each line has one command:
+	 *
+	 *   expect "pattern" ["pattern" ...]  Wait until one of patterns is received.
+	 *   send "string"                      Send string to the peripheral.
+	 *   sleep <ms>                         Wait for the peripheral.
+	 *   timeout <sec>                      Timeout of following `expect`. 0 means infinite.
+	 *   fail "pattern" [code]              Exit with code (1 by default) if the pattern is received while following `expect`.
+	 *   break [ms]                         Send BREAK (250 ms by default).
+	 *   dtr on|off                         Set DTR.
+	 *   rts on|off                         Set RTS.
+	 *   baud <rate>                        Change baud rate without reopening the port.
+	 *   flow none|hardware|software        Change flow control without reopening the port.
+	 *   exit [code]                        Finish the session with code (0 by default).
+	 *
+	 * Strings are quoted, and they can contain \r, \n, \t, \e, \\, \", and \xHH.
+	 * `#` starts a comment.
+	 *
+	 * std::invalid_argument would be thrown if the script has syntax error.
+	 */
+	class ExpectScript
+	{
+	private:
+		std::vector<TScriptStep> _steps;
+		bool _finished;
+		int _exit_code;
+		std::string _result_message;
+
+		void Parse(const std::string& source);
+
+	public:
+		ExpectScript(const std::string& source);
+		virtual ~ExpectScript() {};
+
+		static ExpectScript FromFile(LPCTSTR filename);
+
+		inline std::vector<TScriptStep>& GetSteps() noexcept {
+			return _steps;
+		}
+
+		inline void SetResult(int exit_code, const std::string& message) {
+			_finished = true;
+			_exit_code = exit_code;
+			_result_message = message;
+		}
+
+		inline bool IsFinished() const noexcept {
+			return _finished;
+		}
+
+		inline int GetExitCode() const noexcept {
+			return _exit_code;
+		}
+
+		inline const std::string& GetResultMessage() const noexcept {
+			return _result_message;
+		}
+	};
+
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "LatencyHistogram.h"
+
+
+int SimpleCom::LatencyHistogram::GetBucketIndex(ULONGLONG value) {
+	int idx = 0;
+	while ((value > 0) && (idx < latency_histogram_buckets - 1)) {
+		value >>= 1;
+		idx++;
+	}
+	return idx;
+}
+
+void SimpleCom::LatencyHistogram::Record(ULONGLONG value) {
+	_buckets[GetBucketIndex(value)]++;
+	_count++;
+	_max = max(_max, value);
+}
+
+TString SimpleCom::LatencyHistogram::Format(LPCTSTR unit) const {
+	TStringStream ss;
+	for (int idx = 0; idx < latency_histogram_buckets; idx++) {
+		if (_buckets[idx] == 0) {
+			continue;
+		}
+
+		ULONGLONG lower = (idx == 0) ? 0 : (1ULL << (idx - 1));
+		ss << _T("[") << lower << _T(", ");
+		if (idx == latency_histogram_buckets - 1) {
+			ss << _T("inf");
+		}
+		else {
+			ss << (1ULL << idx);
+		}
+		ss << _T(") ") << unit << _T(": ") << _buckets[idx] << std::endl;
+	}
+	return ss.str();
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+static constexpr int latency_histogram_buckets = 24;
+
+namespace SimpleCom {
+
+	/*
+	 * Histogram of latencies in power-of-two buckets.
+	 * Bucket 0 counts 0, and bucket N counts [2^(N-1), 2^N). The last bucket counts all larger values.
+	 * The unit of values is up to the caller. THIS CLASS IS NOT THREAD SAFETY !!!
+	 */
+	class LatencyHistogram
+	{
+	private:
+		ULONGLONG _buckets[latency_histogram_buckets];
+		ULONGLONG _count;
+		ULONGLONG _max;
+
+	public:
+		LatencyHistogram() : _buckets(), _count(0), _max(0) {};
+		virtual ~LatencyHistogram() {};
+
+		void Record(ULONGLONG value);
+
+		static int GetBucketIndex(ULONGLONG value);
+
+		inline ULONGLONG GetBucket(int idx) const {
+			return _buckets[idx];
+		}
+
+		inline ULONGLONG GetCount() const {
+			return _count;
+		}
+
+		inline ULONGLONG GetMax() const {
+			return _max;
+		}
+
+		// Non-empty buckets, one per line. unit is appended to each range.
+		TString Format(LPCTSTR unit) const;
+	};
+
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "LineConfig.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+
+void SimpleCom::SetFlowControlToDCB(LPDCB dcb, const FlowControl& flow_control) {
+	dcb->fOutxCtsFlow = FALSE;
+	dcb->fRtsControl = RTS_CONTROL_ENABLE;
+	dcb->fOutX = FALSE;
+	dcb->fInX = FALSE;
+
+	if (flow_control == FlowControl::HARDWARE) {
+		dcb->fOutxCtsFlow = TRUE;
+		dcb->fRtsControl = RTS_CONTROL_HANDSHAKE;
+	}
+	else if (flow_control == FlowControl::SOFTWARE) {
+		dcb->fOutX = TRUE;
+		dcb->fInX = TRUE;
+		dcb->XonLim = 2048;
+		dcb->XoffLim = 2048;
+		dcb->XonChar = 0x11;
+		dcb->XoffChar = 0x13;
+	}
+}
+
+void SimpleCom::SerialLinePort::Apply(const DCB& dcb) {
+	if (!_serial.Reconfigure(dcb)) {
+		throw SerialAPIException(GetLastError(), _T("SetCommState for reconfiguration"));
+	}
+}
+
+SimpleCom::LineConfigurator::LineConfigurator(LinePort& port, const DCB& dcb) :
+	_port(port),
+	_dcb(dcb),
+	_modem(nullptr),
+	_listener()
+{
+	InitializeSRWLock(&_lock);
+}
+
+/*
+ * DCB would be updated only if the port accepts it.
+ */
+void SimpleCom::LineConfigurator::Apply(std::function<void(LPDCB)> update) {
+	AcquireSRWLockExclusive(&_lock);
+	DCB dcb = _dcb;
+	try {
+		update(&dcb);
+		_port.Apply(dcb);
+		_dcb = dcb;
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+
+	debug::log(LogLevel::INFO, _T("Reconfigured: {} baud, flow control: {}"), dcb.BaudRate,
+		(dcb.fRtsControl == RTS_CONTROL_HANDSHAKE) ? FlowControl::HARDWARE.tstr() : (dcb.fOutX ? FlowControl::SOFTWARE.tstr() : FlowControl::NONE.tstr()));
+
+	if (_modem != nullptr) {
+		try {
+			_modem->Reapply();
+		}
+		catch (WinAPIException& e) {
+			// New configuration has been applied already (e.g. RTS cannot be set under hardware flow control).
+			debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+		}
+	}
+
+	if (_listener) {
+		_listener(dcb);
+	}
+}
+
+void SimpleCom::LineConfigurator::SetBaudRate(DWORD baud_rate) {
+	Apply([baud_rate](LPDCB dcb) { dcb->BaudRate = baud_rate; });
+}
+
+void SimpleCom::LineConfigurator::SetFlowControl(const FlowControl& flow_control) {
+	Apply([&flow_control](LPDCB dcb) { SetFlowControlToDCB(dcb, flow_control); });
+}
+
+void SimpleCom::LineConfigurator::StepBaudRate(bool up) {
+	DWORD current = GetDCB().BaudRate;
+	DWORD next = 0;
+	for (const DWORD baud_rate : line_config_baud_rates) {
+		if (up && (baud_rate > current)) {
+			next = baud_rate;
+			break;
+		}
+		else if (!up && (baud_rate < current)) {
+			next = baud_rate;
+		}
+	}
+
+	if (next != 0) {
+		SetBaudRate(next);
+	}
+}
+
+bool SimpleCom::LineConfigurator::HandleCommandKey(char key) {
+	switch (key) {
+	case '+':
+		StepBaudRate(true);
+		return true;
+	case '-':
+		StepBaudRate(false);
+		return true;
+	default:
+		return false;
+	}
+}
+
+DCB SimpleCom::LineConfigurator::GetDCB() {
+	AcquireSRWLockShared(&_lock);
+	DCB dcb = _dcb;
+	ReleaseSRWLockShared(&_lock);
+	return dcb;
+}
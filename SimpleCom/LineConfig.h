@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "EnumValue.h"
+#include "SerialHandle.h"
+#include "ModemControl.h"
+
+// Baud rates which can be stepped with F4 followed by `+` or `-`.
+static constexpr DWORD line_config_baud_rates[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1000000, 1500000, 2000000, 3000000 };
+
+namespace SimpleCom {
+
+	// Set fields for the flow control into DCB. Fields for other flow controls would be cleared.
+	void SetFlowControlToDCB(LPDCB dcb, const FlowControl& flow_control);
+
+	/*
+	 * Serial port which can be reconfigured. It can be replaced with fake port for testing.
+	 */
+	class LinePort
+	{
+	public:
+		virtual ~LinePort() {};
+
+		virtual void Apply(const DCB& dcb) = 0;
+	};
+
+	/*
+	 * Reconfigures current handle in SerialHandle without reopening.
+	 * SerialAPIException would be thrown if the function fails.
+	 */
+	class SerialLinePort : public LinePort
+	{
+	private:
+		SerialHandle& _serial;
+
+	public:
+		SerialLinePort(SerialHandle& serial) : _serial(serial) {};
+		virtual ~SerialLinePort() {};
+
+		virtual void Apply(const DCB& dcb) override;
+	};
+
+	/*
+	 * Holds DCB of the session, and applies changes of it while the session is running.
+	 * This class can be used from the stdin thread, the script thread, and the trigger thread at the same time.
+	 */
+	class LineConfigurator
+	{
+	private:
+		LinePort& _port;
+		SRWLOCK _lock;
+		DCB _dcb;
+		ModemController* _modem;
+		std::function<void(const DCB&)> _listener;
+
+		void Apply(std::function<void(LPDCB)> update);
+
+	public:
+		LineConfigurator(LinePort& port, const DCB& dcb);
+		virtual ~LineConfigurator() {};
+
+		// DTR and RTS would be set again after reconfiguring because SetCommState() resets them. This should be called before using the configurator.
+		inline void SetModemController(ModemController* modem) {
+			_modem = modem;
+		}
+
+		// listener would be called with new DCB after it is applied. This should be called before using the configurator.
+		inline void SetListener(std::function<void(const DCB&)> listener) {
+			_listener = listener;
+		}
+
+		void SetBaudRate(DWORD baud_rate);
+		void SetFlowControl(const FlowControl& flow_control);
+
+		// Step to the next (or previous) rate in line_config_baud_rates. Nothing would happen at the end of them.
+		void StepBaudRate(bool up);
+
+		/*
+		 * Perform the command for the key which follows the prefix hotkey.
+		 *   +: Step up baud rate
+		 *   -: Step down baud rate
+		 * Returns false if the key is not a command.
+		 */
+		bool HandleCommandKey(char key);
+
+		DCB GetDCB();
+	};
+
+}
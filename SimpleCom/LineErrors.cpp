@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "LineErrors.h"
+
+
+std::string SimpleCom::FormatCommErrors(DWORD errors) {
+	static const std::pair<DWORD, const char*> names[] = {
+		{ CE_OVERRUN, "overrun" },
+		{ CE_RXOVER, "input queue overflow" },
+		{ CE_FRAME, "framing" },
+		{ CE_RXPARITY, "parity" },
+		{ CE_BREAK, "break" }
+	};
+
+	std::string result;
+	for (auto& [error, name] : names) {
+		if (errors & error) {
+			if (!result.empty()) {
+				result += ", ";
+			}
+			result += name;
+		}
+	}
+	return result;
+}
+
+DWORD SimpleCom::DriverQueueTuner::OnCommErrors(DWORD errors) {
+	// Framing and parity errors are not caused by the size of the queue.
+	if (((errors & (CE_OVERRUN | CE_RXOVER)) == 0) || (_size >= _max_size)) {
+		return 0;
+	}
+
+	_size = min(_size * 2, _max_size);
+	return _size;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Input queue of the driver would not be grown beyond this size.
+static constexpr DWORD driver_queue_max_sz = 64 * 1024;
+
+namespace SimpleCom {
+
+	// Names of line errors from ClearCommError() (e.g. "overrun, framing"). Returns empty string if there is no error.
+	std::string FormatCommErrors(DWORD errors);
+
+	/*
+	 * Grows input queue of the driver when received data is lost by overrun.
+	 * The driver can keep more data while the reader is busy if the queue is larger.
+	 */
+	class DriverQueueTuner
+	{
+	private:
+		DWORD _size;
+		DWORD _max_size;
+
+	public:
+		DriverQueueTuner(DWORD initial_size, DWORD max_size) : _size(initial_size), _max_size(max_size) {};
+		virtual ~DriverQueueTuner() {};
+
+		// Returns new size of the input queue which should be applied with SetupComm(), or 0 if it should not be changed.
+		DWORD OnCommErrors(DWORD errors);
+
+		inline DWORD GetSize() const {
+			return _size;
+		}
+	};
+
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024, Yasumasa Suenaga
+ * Copyright (C) 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -22,6 +22,7 @@
 #include "LogWriter.h"
 #include "WinAPIException.h"
 #include "debug.h"
+#include "Trace.h"
 
 
 SimpleCom::LogWriter::LogWriter(LPCTSTR logfilename) {
@@ -43,12 +44,57 @@ void SimpleCom::LogWriter::Write(const char c) {
 }
 
 void SimpleCom::LogWriter::Write(const char* data, const DWORD len) {
+	TRACE_SCOPE("LogWriter::Write");
 	DWORD nBytesWritten;
 	BOOL result = WriteFile(_handle, data, len, &nBytesWritten, nullptr);
 	if (!result) {
 		throw WinAPIException(GetLastError());
 	}
 	if (nBytesWritten != len) {
-		SimpleCom::debug::log(_T("(Part of) log data could not be written."));
+		SimpleCom::debug::log(SimpleCom::LogLevel::ERR, _T("(Part of) log data could not be written."));
 	}
-}
\ No newline at end of file
+}
+
+SimpleCom::LogMarkerQueue::LogMarkerQueue() : _markers(), _count(0) {
+	InitializeSRWLock(&_lock);
+}
+
+void SimpleCom::LogMarkerQueue::Push(ULONGLONG seq, const std::string& text) {
+	AcquireSRWLockExclusive(&_lock);
+	_markers.push_back({ seq, text });
+	_count.store(_markers.size(), std::memory_order_release);
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::LogMarkerQueue::Write(const char* data, const DWORD len, const ULONGLONG seq, const std::function<void(const char*, const DWORD)>& writer) {
+	// Fast path: no marker is queued in most cases.
+	if (_count.load(std::memory_order_acquire) == 0) {
+		writer(data, len);
+		return;
+	}
+
+	// Take markers out of the queue at first because writer might throw an exception.
+	std::vector<std::pair<ULONGLONG, std::string>> markers;
+	AcquireSRWLockExclusive(&_lock);
+	while (!_markers.empty() && (_markers.front().first <= seq + len)) {
+		markers.push_back(std::move(_markers.front()));
+		_markers.pop_front();
+	}
+	_count.store(_markers.size(), std::memory_order_release);
+	ReleaseSRWLockExclusive(&_lock);
+
+	DWORD written = 0;
+	for (auto& marker : markers) {
+		// Markers for the data which has been already written would be written immediately.
+		DWORD pos = static_cast<DWORD>(max(marker.first, seq + written) - seq);
+		if (pos > written) {
+			writer(data + written, pos - written);
+			written = pos;
+		}
+		writer(marker.second.c_str(), static_cast<DWORD>(marker.second.length()));
+	}
+
+	if (written < len) {
+		writer(data + written, len - written);
+	}
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024, Yasumasa Suenaga
+ * Copyright (C) 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -39,4 +39,27 @@ namespace SimpleCom {
 		void Write(const char* data, const DWORD len);
 	};
 
+	/*
+	 * Queue for in-band markers (e.g. trigger, line error) in the log.
+	 * A marker is bound to the sequence (byte offset) of received data,
+	 * and it would be written just before the byte at the sequence even if it is pushed from another thread.
+	 * Markers should be pushed in order of the sequence, and before the data at the sequence is written.
+	 */
+	class LogMarkerQueue
+	{
+	private:
+		SRWLOCK _lock;
+		std::deque<std::pair<ULONGLONG, std::string>> _markers;
+		std::atomic<size_t> _count;
+
+	public:
+		LogMarkerQueue();
+		virtual ~LogMarkerQueue() {};
+
+		void Push(ULONGLONG seq, const std::string& text);
+
+		// Pass data which starts at seq to writer with markers in it.
+		void Write(const char* data, const DWORD len, const ULONGLONG seq, const std::function<void(const char*, const DWORD)>& writer);
+	};
+
 }
\ No newline at end of file
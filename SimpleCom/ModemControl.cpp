@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ModemControl.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+
+void SimpleCom::SerialModemPort::Escape(DWORD func) {
+	if (!_serial.Escape(func)) {
+		throw SerialAPIException(GetLastError(), _T("EscapeCommFunction"));
+	}
+}
+
+SimpleCom::ModemController::ModemController(ModemPort& port, bool dtr, bool rts, std::function<ULONGLONG()> clock) :
+	_port(port),
+	_clock(clock),
+	_dtr(dtr),
+	_rts(rts),
+	_breaking(false),
+	_break_end(0),
+	_stats(nullptr)
+{
+	InitializeSRWLock(&_lock);
+}
+
+void SimpleCom::ModemController::SetDTR(bool enabled) {
+	AcquireSRWLockExclusive(&_lock);
+	try {
+		_port.Escape(enabled ? SETDTR : CLRDTR);
+		_dtr = enabled;
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+	debug::log(LogLevel::INFO, _T("DTR: {}"), enabled ? _T("on") : _T("off"));
+}
+
+void SimpleCom::ModemController::SetRTS(bool enabled) {
+	AcquireSRWLockExclusive(&_lock);
+	try {
+		_port.Escape(enabled ? SETRTS : CLRRTS);
+		_rts = enabled;
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+	debug::log(LogLevel::INFO, _T("RTS: {}"), enabled ? _T("on") : _T("off"));
+}
+
+void SimpleCom::ModemController::ToggleDTR() {
+	SetDTR(!_dtr);
+}
+
+void SimpleCom::ModemController::ToggleRTS() {
+	SetRTS(!_rts);
+}
+
+void SimpleCom::ModemController::Reapply() {
+	AcquireSRWLockExclusive(&_lock);
+	try {
+		_port.Escape(_dtr ? SETDTR : CLRDTR);
+		_port.Escape(_rts ? SETRTS : CLRRTS);
+		if (_breaking) {
+			_port.Escape(SETBREAK);
+		}
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::ModemController::StartBreak(DWORD duration_ms) {
+	AcquireSRWLockExclusive(&_lock);
+	try {
+		if (!_breaking) {
+			_port.Escape(SETBREAK);
+			_breaking = true;
+			if (_stats != nullptr) {
+				_stats->RecordBreakSent();
+			}
+		}
+		_break_end = max(_break_end, _clock() + duration_ms);
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+	debug::log(LogLevel::INFO, _T("BREAK: {} ms"), duration_ms);
+}
+
+DWORD SimpleCom::ModemController::GetTimeout() {
+	AcquireSRWLockShared(&_lock);
+	DWORD timeout = INFINITE;
+	if (_breaking) {
+		ULONGLONG now = _clock();
+		timeout = (now >= _break_end) ? 0 : static_cast<DWORD>(_break_end - now);
+	}
+	ReleaseSRWLockShared(&_lock);
+	return timeout;
+}
+
+void SimpleCom::ModemController::Poll() {
+	AcquireSRWLockExclusive(&_lock);
+	try {
+		if (_breaking && (_clock() >= _break_end)) {
+			// BREAK should not be kept even if CLRBREAK fails, then the failure would not be repeated.
+			_breaking = false;
+			_break_end = 0;
+			_port.Escape(CLRBREAK);
+		}
+	}
+	catch (...) {
+		ReleaseSRWLockExclusive(&_lock);
+		throw;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+bool SimpleCom::ModemController::HandleCommandKey(char key) {
+	switch (key) {
+	case 'b':
+		StartBreak(modem_default_break_ms);
+		return true;
+	case 'd':
+		ToggleDTR();
+		return true;
+	case 'r':
+		ToggleRTS();
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::string SimpleCom::FormatModemStatus(DWORD status) {
+	static const std::pair<DWORD, const char*> names[] = {
+		{ MS_CTS_ON, "CTS" },
+		{ MS_DSR_ON, "DSR" },
+		{ MS_RLSD_ON, "DCD" },
+		{ MS_RING_ON, "RI" }
+	};
+
+	std::string result;
+	for (auto& [line, name] : names) {
+		if (!result.empty()) {
+			result += " ";
+		}
+		result += name;
+		result += (status & line) ? "=on" : "=off";
+	}
+	return result;
+}
+
+DWORD SimpleCom::LineStateMonitor::Update(DWORD events, DWORD status) {
+	DWORD changed = (_status ^ status) & (MS_CTS_ON | MS_DSR_ON | MS_RLSD_ON | MS_RING_ON);
+	if (events & EV_RING) {
+		changed |= MS_RING_ON;
+	}
+
+	_status = status;
+	for (DWORD bits = changed; bits != 0; bits &= bits - 1) {
+		_changes++;
+	}
+	return changed;
+}
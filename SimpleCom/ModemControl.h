@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "SerialHandle.h"
+#include "SessionStats.h"
+
+// Duration of BREAK which is sent by the hotkey, or `break` in the script without duration.
+static constexpr DWORD modem_default_break_ms = 250;
+
+// Events of modem status lines. They would be reported by WaitCommEvent() together with EV_RXCHAR.
+static constexpr DWORD modem_event_mask = EV_CTS | EV_DSR | EV_RLSD | EV_RING;
+
+namespace SimpleCom {
+
+	/*
+	 * Modem control lines of the serial port. It can be replaced with fake port for testing.
+	 */
+	class ModemPort
+	{
+	public:
+		virtual ~ModemPort() {};
+
+		// func is one of SETDTR, CLRDTR, SETRTS, CLRRTS, SETBREAK, and CLRBREAK for EscapeCommFunction().
+		virtual void Escape(DWORD func) = 0;
+	};
+
+	/*
+	 * Modem control lines of current handle in SerialHandle.
+	 * SerialAPIException would be thrown if the function fails.
+	 */
+	class SerialModemPort : public ModemPort
+	{
+	private:
+		SerialHandle& _serial;
+
+	public:
+		SerialModemPort(SerialHandle& serial) : _serial(serial) {};
+		virtual ~SerialModemPort() {};
+
+		virtual void Escape(DWORD func) override;
+	};
+
+	/*
+	 * Drives BREAK, DTR, and RTS.
+	 * BREAK is cleared by Poll() after the duration, so the caller does not need to block during BREAK.
+	 * This class can be used from the stdin thread and the script thread at the same time.
+	 * The clock can be replaced for testing. It should return time in milliseconds.
+	 */
+	class ModemController
+	{
+	private:
+		ModemPort& _port;
+		std::function<ULONGLONG()> _clock;
+		SRWLOCK _lock;
+		bool _dtr;
+		bool _rts;
+		bool _breaking;
+		ULONGLONG _break_end;
+		SessionStats* _stats;
+
+	public:
+		// dtr and rts are initial state of the lines which are set by SetCommState().
+		ModemController(ModemPort& port, bool dtr, bool rts, std::function<ULONGLONG()> clock);
+		ModemController(ModemPort& port, bool dtr, bool rts) : ModemController(port, dtr, rts, &GetTickCount64) {};
+		virtual ~ModemController() {};
+
+		// Sent BREAK would be counted. This should be called before using the controller.
+		inline void SetStats(SessionStats* stats) {
+			_stats = stats;
+		}
+
+		void SetDTR(bool enabled);
+		void SetRTS(bool enabled);
+		void ToggleDTR();
+		void ToggleRTS();
+
+		// Set lines to the state which is set by this controller again. It is needed after SetCommState() on reconnection.
+		void Reapply();
+
+		// Start BREAK. It would be extended if BREAK is already being sent.
+		void StartBreak(DWORD duration_ms);
+
+		// Milliseconds until BREAK should be cleared. INFINITE if BREAK is not being sent.
+		DWORD GetTimeout();
+
+		// Clear BREAK if the duration has been elapsed.
+		void Poll();
+
+		/*
+		 * Perform the command for the key which follows the prefix hotkey.
+		 *   b: Send BREAK
+		 *   d: Toggle DTR
+		 *   r: Toggle RTS
+		 * Returns false if the key is not a command.
+		 */
+		bool HandleCommandKey(char key);
+
+		inline bool GetDTR() const {
+			return _dtr;
+		}
+
+		inline bool GetRTS() const {
+			return _rts;
+		}
+	};
+
+	// State of modem status lines from GetCommModemStatus() (e.g. "CTS=on DSR=off DCD=off RI=off").
+	std::string FormatModemStatus(DWORD status);
+
+	/*
+	 * Tracks modem status lines (CTS, DSR, DCD, RI) which are reported by WaitCommEvent().
+	 * This class is used on the reader thread only.
+	 */
+	class LineStateMonitor
+	{
+	private:
+		DWORD _status;
+		ULONGLONG _changes;
+
+	public:
+		LineStateMonitor() : _status(0), _changes(0) {};
+		virtual ~LineStateMonitor() {};
+
+		// Set current status without reporting changes. It should be called when the port is opened.
+		inline void Reset(DWORD status) {
+			_status = status;
+		}
+
+		/*
+		 * events is from WaitCommEvent(), and status is from GetCommModemStatus().
+		 * Returns MS_*_ON bits of lines which are changed. RI is reported on EV_RING even if the status is not changed
+		 * because the driver notifies the trailing edge of the ring.
+		 */
+		DWORD Update(DWORD events, DWORD status);
+
+		inline DWORD GetStatus() const {
+			return _status;
+		}
+
+		inline ULONGLONG GetChanges() const {
+			return _changes;
+		}
+	};
+
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "MultiPatternMatcher.h"
+
+static constexpr DWORD NO_TRANSITION = 0xFFFFFFFF;
+
+
+SimpleCom::MultiPatternMatcher::MultiPatternMatcher(const std::vector<std::string>& patterns) :
+	_patterns(patterns),
+	_num_classes(0),
+	_transitions(),
+	_output_begin(),
+	_outputs(),
+	_state(0)
+{
+	for (auto& pattern : _patterns) {
+		if (pattern.empty()) {
+			throw std::invalid_argument("Empty pattern is not allowed");
+		}
+	}
+
+	Compile();
+}
+
+void SimpleCom::MultiPatternMatcher::Compile() {
+	// Bytes which do not appear in any patterns share class 0,
+	// so the transition table has only (number of distinct bytes in patterns + 1) columns.
+	ZeroMemory(_classes, sizeof(_classes));
+	_num_classes = 1;
+	for (auto& pattern : _patterns) {
+		for (auto ch : pattern) {
+			BYTE b = static_cast<BYTE>(ch);
+			if (_classes[b] == 0) {
+				_classes[b] = static_cast<BYTE>(_num_classes++);
+			}
+		}
+	}
+
+	// Build trie. State 0 is root.
+	_transitions.assign(_num_classes, NO_TRANSITION);
+	std::vector<std::vector<int>> outputs(1);
+	for (int id = 0; id < static_cast<int>(_patterns.size()); id++) {
+		DWORD state = 0;
+		for (auto ch : _patterns[id]) {
+			DWORD cls = _classes[static_cast<BYTE>(ch)];
+			if (_transitions[state * _num_classes + cls] == NO_TRANSITION) {
+				DWORD new_state = static_cast<DWORD>(outputs.size());
+				_transitions[state * _num_classes + cls] = new_state;
+				_transitions.insert(_transitions.end(), _num_classes, NO_TRANSITION);
+				outputs.emplace_back();
+			}
+			state = _transitions[state * _num_classes + cls];
+		}
+		outputs[state].push_back(id);
+	}
+
+	// Fill failure transitions in BFS order, then the trie becomes DFA.
+	std::vector<DWORD> fail(outputs.size(), 0);
+	std::deque<DWORD> queue;
+	for (DWORD cls = 0; cls < _num_classes; cls++) {
+		DWORD& next = _transitions[cls];
+		if (next == NO_TRANSITION) {
+			next = 0;
+		}
+		else {
+			queue.push_back(next);
+		}
+	}
+	while (!queue.empty()) {
+		DWORD state = queue.front();
+		queue.pop_front();
+
+		for (DWORD cls = 0; cls < _num_classes; cls++) {
+			DWORD& next = _transitions[state * _num_classes + cls];
+			DWORD fallback = _transitions[fail[state] * _num_classes + cls];
+			if (next == NO_TRANSITION) {
+				next = fallback;
+			}
+			else {
+				fail[next] = fallback;
+				outputs[next].insert(outputs[next].end(), outputs[fallback].begin(), outputs[fallback].end());
+				queue.push_back(next);
+			}
+		}
+	}
+
+	// Flatten outputs to keep them in contiguous memory.
+	_output_begin.clear();
+	_outputs.clear();
+	for (auto& output : outputs) {
+		_output_begin.push_back(static_cast<DWORD>(_outputs.size()));
+		_outputs.insert(_outputs.end(), output.begin(), output.end());
+	}
+	_output_begin.push_back(static_cast<DWORD>(_outputs.size()));
+}
+
+DWORD SimpleCom::MultiPatternMatcher::Feed(const char* data, const DWORD len, const TMatchHandler& handler) {
+	const DWORD* transitions = _transitions.data();
+	const DWORD* output_begin = _output_begin.data();
+	DWORD state = _state;
+
+	for (DWORD idx = 0; idx < len; idx++) {
+		state = transitions[state * _num_classes + _classes[static_cast<BYTE>(data[idx])]];
+		if (output_begin[state] != output_begin[state + 1]) {
+			for (DWORD out = output_begin[state]; out < output_begin[state + 1]; out++) {
+				if (!handler(_outputs[out], idx + 1)) {
+					_state = state;
+					return idx + 1;
+				}
+			}
+		}
+	}
+
+	_state = state;
+	return len;
+}
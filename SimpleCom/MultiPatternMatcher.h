@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+namespace SimpleCom {
+
+	/*
+	 * Callback for matched pattern.
+	 * pattern_id is the index of the pattern in the constructor, end is the offset just after the match in the data passed to Feed().
+	 * Return false if Feed() should stop scanning.
+	 */
+	typedef std::function<bool(const int pattern_id, const DWORD end)> TMatchHandler;
+
+	/*
+	 * Multi-pattern string matcher.
+	 * All of patterns are compiled into one DFA (Aho-Corasick automaton) with byte classes,
+	 * so the cost of scanning is one table lookup per byte regardless of the number of patterns.
+	 * The state is kept between calls of Feed(), so patterns which are split across chunks can be found.
+	 */
+	class MultiPatternMatcher
+	{
+	private:
+		std::vector<std::string> _patterns;
+		BYTE _classes[256];
+		DWORD _num_classes;
+		std::vector<DWORD> _transitions;
+		std::vector<DWORD> _output_begin;
+		std::vector<int> _outputs;
+		DWORD _state;
+
+		void Compile();
+
+	public:
+		MultiPatternMatcher() : MultiPatternMatcher(std::vector<std::string>()) {};
+		MultiPatternMatcher(const std::vector<std::string>& patterns);
+		virtual ~MultiPatternMatcher() {};
+
+		// Returns the number of bytes which are scanned.
+		// It would be less than len if handler returns false.
+		DWORD Feed(const char* data, const DWORD len, const TMatchHandler& handler);
+
+		inline void Reset() noexcept {
+			_state = 0;
+		}
+
+		inline const std::vector<std::string>& GetPatterns() const noexcept {
+			return _patterns;
+		}
+
+		inline size_t GetNumberOfStates() const noexcept {
+			return _output_begin.size() - 1;
+		}
+	};
+
+}
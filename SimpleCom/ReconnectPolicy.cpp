@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ReconnectPolicy.h"
+#include "debug.h"
+
+
+HANDLE SimpleCom::SerialDeviceProvider::Open() {
+	_device = _resolver();
+	if (_device.empty()) {
+		return INVALID_HANDLE_VALUE;
+	}
+	return CreateFile(_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+}
+
+bool SimpleCom::SerialDeviceProvider::Wait(DWORD ms) {
+	return WaitForSingleObject(_hCancelEvent, ms) == WAIT_TIMEOUT;
+}
+
+SimpleCom::ReconnectPolicy::ReconnectPolicy(DWORD initial_interval_ms, DWORD max_interval_ms, DWORD timeout_ms) :
+	_initial_interval_ms(initial_interval_ms),
+	_max_interval_ms(max_interval_ms),
+	_timeout_ms(timeout_ms),
+	_timed_out(false),
+	_open_latency()
+{
+	if ((initial_interval_ms == 0) || (max_interval_ms < initial_interval_ms)) {
+		throw std::invalid_argument("Invalid interval of reconnection");
+	}
+}
+
+HANDLE SimpleCom::ReconnectPolicy::Open(DeviceProvider& provider) {
+	ULONGLONG start = provider.Now();
+	DWORD interval = _initial_interval_ms;
+	int attempts = 0;
+	_timed_out = false;
+
+	while (true) {
+		HANDLE handle = provider.Open();
+		attempts++;
+		if (handle != INVALID_HANDLE_VALUE) {
+			ULONGLONG elapsed = provider.Now() - start;
+			_open_latency.Record(elapsed);
+
+			debug::log(LogLevel::INFO, _T("Device is reopened in {} ms ({} attempts)"), elapsed, attempts);
+			return handle;
+		}
+
+		ULONGLONG elapsed = provider.Now() - start;
+		if (elapsed >= _timeout_ms) {
+			_timed_out = true;
+			return INVALID_HANDLE_VALUE;
+		}
+
+		// Last attempt should be performed at the timeout.
+		DWORD wait_ms = static_cast<DWORD>(min(static_cast<ULONGLONG>(interval), _timeout_ms - elapsed));
+		if (!provider.Wait(wait_ms)) {
+			return INVALID_HANDLE_VALUE;
+		}
+		interval = min(interval * 2, _max_interval_ms);
+	}
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "LatencyHistogram.h"
+
+// Interval between attempts to open re-arrived device would start with this, and would be doubled up to the max.
+static constexpr DWORD reconnect_initial_interval_ms = 10;
+static constexpr DWORD reconnect_max_interval_ms = 500;
+
+namespace SimpleCom {
+
+	/*
+	 * Source of the device to reconnect. It can be replaced with fake device for testing.
+	 */
+	class DeviceProvider
+	{
+	public:
+		virtual ~DeviceProvider() {};
+
+		// Returns INVALID_HANDLE_VALUE if the device is not available yet.
+		virtual HANDLE Open() = 0;
+
+		// Current time in milliseconds.
+		virtual ULONGLONG Now() = 0;
+
+		// Wait for next attempt. Returns false if reconnection should be cancelled.
+		virtual bool Wait(DWORD ms) = 0;
+	};
+
+	/*
+	 * Opens serial port. Waiting would be cancelled if hCancelEvent is signaled.
+	 * The device name is resolved for each attempt because USB serial adapter might be re-enumerated with another port.
+	 * resolver should return empty string if the device is not available.
+	 */
+	class SerialDeviceProvider : public DeviceProvider
+	{
+	private:
+		std::function<TString()> _resolver;
+		TString _device;
+		HANDLE _hCancelEvent;
+
+	public:
+		SerialDeviceProvider(std::function<TString()> resolver, HANDLE hCancelEvent) : _resolver(resolver), _device(), _hCancelEvent(hCancelEvent) {};
+		SerialDeviceProvider(const TString& device, HANDLE hCancelEvent) : SerialDeviceProvider([device] { return device; }, hCancelEvent) {};
+		virtual ~SerialDeviceProvider() {};
+
+		virtual HANDLE Open() override;
+
+		// Device name which is resolved at the last attempt.
+		inline const TString& GetDevice() const {
+			return _device;
+		}
+
+		virtual ULONGLONG Now() override {
+			return GetTickCount64();
+		}
+
+		virtual bool Wait(DWORD ms) override;
+	};
+
+	/*
+	 * Retries to open the device with exponential backoff, so the port would be opened as soon as USB serial adapter re-enumerates.
+	 * Time from the start of reconnection to open the device is recorded into the histogram in milliseconds.
+	 */
+	class ReconnectPolicy
+	{
+	private:
+		DWORD _initial_interval_ms;
+		DWORD _max_interval_ms;
+		DWORD _timeout_ms;
+		bool _timed_out;
+		LatencyHistogram _open_latency;
+
+	public:
+		ReconnectPolicy(DWORD initial_interval_ms, DWORD max_interval_ms, DWORD timeout_ms);
+		ReconnectPolicy(DWORD timeout_ms) : ReconnectPolicy(reconnect_initial_interval_ms, reconnect_max_interval_ms, timeout_ms) {};
+		virtual ~ReconnectPolicy() {};
+
+		// Returns INVALID_HANDLE_VALUE if the device did not arrive until the timeout, or reconnection is cancelled.
+		HANDLE Open(DeviceProvider& provider);
+
+		// Returns true if the last Open() gave up by the timeout.
+		inline bool IsTimedOut() const {
+			return _timed_out;
+		}
+
+		inline const LatencyHistogram& open_latency() const {
+			return _open_latency;
+		}
+	};
+
+}
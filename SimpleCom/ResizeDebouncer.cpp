@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ResizeDebouncer.h"
+
+
+static bool IsSameSize(const COORD& a, const COORD& b) {
+	return (a.X == b.X) && (a.Y == b.Y);
+}
+
+SimpleCom::ResizeDebouncer::ResizeDebouncer(const COORD& current, DWORD quiet_ms, DWORD min_interval_ms, std::function<ULONGLONG()> clock) :
+	_quiet_ms(quiet_ms),
+	_min_interval_ms(min_interval_ms),
+	_clock(clock),
+	_sent(current),
+	_pending(current),
+	_has_pending(false),
+	_last_changed(0),
+	_last_sent(0)
+{
+	// The first request should not be delayed by the minimum interval.
+	ULONGLONG now = _clock();
+	_last_sent = (now > _min_interval_ms) ? now - _min_interval_ms : 0;
+}
+
+void SimpleCom::ResizeDebouncer::Update(const COORD& size) {
+	if (_has_pending && IsSameSize(_pending, size)) {
+		return;
+	}
+
+	_pending = size;
+	_last_changed = _clock();
+	// Window might be back to the size which has been sent already.
+	_has_pending = !IsSameSize(_sent, size);
+}
+
+bool SimpleCom::ResizeDebouncer::Poll(COORD* size) {
+	if (GetTimeout() != 0) {
+		return false;
+	}
+
+	*size = _pending;
+	_sent = _pending;
+	_has_pending = false;
+	_last_sent = _clock();
+	return true;
+}
+
+DWORD SimpleCom::ResizeDebouncer::GetTimeout() {
+	if (!_has_pending) {
+		return INFINITE;
+	}
+
+	ULONGLONG now = _clock();
+	ULONGLONG deadline = max(_last_changed + _quiet_ms, _last_sent + _min_interval_ms);
+	return (now >= deadline) ? 0 : static_cast<DWORD>(deadline - now);
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Resize request would not be sent within this interval from the previous one.
+static constexpr DWORD resize_min_interval_ms = 250;
+
+namespace SimpleCom {
+
+	/*
+	 * Coalesces console size changes for TTY Resizer.
+	 * Only the final size would be sent after quiet period, so dragging the window edge does not flood the peripheral.
+	 * The clock can be replaced for testing. It should return time in milliseconds.
+	 */
+	class ResizeDebouncer
+	{
+	private:
+		DWORD _quiet_ms;
+		DWORD _min_interval_ms;
+		std::function<ULONGLONG()> _clock;
+		COORD _sent;
+		COORD _pending;
+		bool _has_pending;
+		ULONGLONG _last_changed;
+		ULONGLONG _last_sent;
+
+	public:
+		ResizeDebouncer(const COORD& current, DWORD quiet_ms, DWORD min_interval_ms, std::function<ULONGLONG()> clock);
+		ResizeDebouncer(const COORD& current, DWORD quiet_ms) : ResizeDebouncer(current, quiet_ms, resize_min_interval_ms, &GetTickCount64) {};
+		virtual ~ResizeDebouncer() {};
+
+		// Notify new console size. It would not be sent until Poll() returns true.
+		void Update(const COORD& size);
+
+		// Returns true if the size should be sent now. *size would be set to it.
+		bool Poll(COORD* size);
+
+		// Milliseconds until Poll() would return true. INFINITE if no size is pending.
+		DWORD GetTimeout();
+	};
+
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ResizerProtocol.h"
+#include "WinAPIException.h"
+#include "../common/common.h"
+
+static constexpr char RESIZER_REPLY_PREFIX_STR[] = RESIZER_REPLY_PREFIX;
+static constexpr size_t RESIZER_REPLY_PREFIX_LEN = sizeof(RESIZER_REPLY_PREFIX_STR) - 1;
+
+// "[version];[caps]" should be short. Longer one is not a reply from TTY Resizer.
+static constexpr size_t RESIZER_REPLY_MAX_LEN = 16;
+
+
+static void AppendBigEndian(BYTE* buf, ULONGLONG value, int len) {
+	for (int idx = len - 1; idx >= 0; idx--) {
+		buf[idx] = static_cast<BYTE>(value & 0xff);
+		value >>= 8;
+	}
+}
+
+static void AppendHex(std::string& frame, BYTE value) {
+	static constexpr char hex[] = "0123456789abcdef";
+	frame.push_back(hex[value >> 4]);
+	frame.push_back(hex[value & 0xf]);
+}
+
+std::string SimpleCom::EncodeResizerFrame(BYTE type, const BYTE* payload, BYTE len) {
+	if (len > RESIZER_V2_MAX_PAYLOAD) {
+		throw std::invalid_argument("Payload is too long");
+	}
+
+	// Frame is printable except the start marker, so the line discipline of the target does not change it.
+	std::string frame = { RESIZER_START_MARKER, RESIZER_V2_MARKER };
+	AppendHex(frame, type);
+	AppendHex(frame, len);
+	unsigned short crc = resizer_crc16_update(0xffff, type);
+	crc = resizer_crc16_update(crc, len);
+	for (BYTE idx = 0; idx < len; idx++) {
+		AppendHex(frame, payload[idx]);
+		crc = resizer_crc16_update(crc, payload[idx]);
+	}
+	AppendHex(frame, static_cast<BYTE>(crc >> 8));
+	AppendHex(frame, static_cast<BYTE>(crc & 0xff));
+	frame.push_back(RESIZER_END_MARKER);
+
+	return frame;
+}
+
+std::string SimpleCom::EncodeResizeRequest(int version, const COORD& size) {
+	if (version < 2) {
+		char buf[RINGBUF_SZ];
+		int len = snprintf(buf, sizeof(buf), "%c%d" RESIZER_SEPARATOR "%d%c", RESIZER_START_MARKER, size.Y, size.X, RESIZER_END_MARKER);
+		return std::string(buf, len);
+	}
+
+	BYTE payload[4];
+	AppendBigEndian(payload, size.Y, 2);
+	AppendBigEndian(payload + 2, size.X, 2);
+	return EncodeResizerFrame(RESIZER_MSG_RESIZE, payload, sizeof(payload));
+}
+
+std::string SimpleCom::EncodeResizerHello(BYTE caps) {
+	BYTE payload[] = { RESIZER_PROTOCOL_VERSION, caps };
+	return EncodeResizerFrame(RESIZER_MSG_HELLO, payload, sizeof(payload));
+}
+
+std::string SimpleCom::EncodeResizerKeepalive(DWORD seq) {
+	BYTE payload[4];
+	AppendBigEndian(payload, seq, sizeof(payload));
+	return EncodeResizerFrame(RESIZER_MSG_KEEPALIVE, payload, sizeof(payload));
+}
+
+std::string SimpleCom::EncodeResizerClockSync(ULONGLONG unix_time_us) {
+	BYTE payload[8];
+	AppendBigEndian(payload, unix_time_us, sizeof(payload));
+	return EncodeResizerFrame(RESIZER_MSG_CLOCK_SYNC, payload, sizeof(payload));
+}
+
+SimpleCom::ResizerNegotiator::ResizerNegotiator() :
+	_matched(0),
+	_reply(),
+	_version(1),
+	_caps(0)
+{
+	_hNegotiatedEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (_hNegotiatedEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for ResizerNegotiator"));
+	}
+}
+
+SimpleCom::ResizerNegotiator::~ResizerNegotiator() {
+	CloseHandle(_hNegotiatedEvent);
+}
+
+void SimpleCom::ResizerNegotiator::Feed(const char* data, const DWORD len) {
+	for (DWORD idx = 0; idx < len; idx++) {
+		char ch = data[idx];
+
+		if (_matched < RESIZER_REPLY_PREFIX_LEN) {
+			if (ch == RESIZER_REPLY_PREFIX_STR[_matched]) {
+				_matched++;
+			}
+			else {
+				// ESC is the only char which can restart the prefix.
+				_matched = (ch == RESIZER_REPLY_PREFIX_STR[0]) ? 1 : 0;
+			}
+			continue;
+		}
+
+		if (ch == RESIZER_REPLY_TERMINATOR) {
+			ParseReply();
+		}
+		else if (_reply.length() < RESIZER_REPLY_MAX_LEN) {
+			_reply.push_back(ch);
+			continue;
+		}
+
+		_reply.clear();
+		_matched = 0;
+	}
+}
+
+void SimpleCom::ResizerNegotiator::ParseReply() {
+	char* end;
+	long version = strtol(_reply.c_str(), &end, 10);
+	if ((end == _reply.c_str()) || (*end != ';')) {
+		return;
+	}
+	const char* caps_str = end + 1;
+	unsigned long caps = strtoul(caps_str, &end, 16);
+	if ((end == caps_str) || (*end != '\0')) {
+		return;
+	}
+
+	// Use v2 even if TTY Resizer supports newer version.
+	_caps.store(static_cast<BYTE>(caps & RESIZER_CAPS), std::memory_order_release);
+	_version.store(static_cast<int>(min(version, RESIZER_PROTOCOL_VERSION)), std::memory_order_release);
+	SetEvent(_hNegotiatedEvent);
+}
+
+SimpleCom::ResizerReplyFilter::ResizerReplyFilter() : _held() {
+	// Do nothing
+}
+
+void SimpleCom::ResizerReplyFilter::Filter(const char* data, const DWORD len, const std::function<void(const char*, const DWORD)>& writer) {
+	DWORD pass_start = 0;
+
+	for (DWORD idx = 0; idx < len; idx++) {
+		char ch = data[idx];
+		size_t held_len = _held.length();
+
+		if (held_len == 0) {
+			if (ch == RESIZER_REPLY_PREFIX_STR[0]) {
+				if (idx > pass_start) {
+					writer(data + pass_start, idx - pass_start);
+				}
+				_held.push_back(ch);
+			}
+			continue;
+		}
+
+		bool matched;
+		if (held_len < RESIZER_REPLY_PREFIX_LEN) {
+			matched = (ch == RESIZER_REPLY_PREFIX_STR[held_len]);
+		}
+		else if (ch == RESIZER_REPLY_TERMINATOR) {
+			// Reply is completed. It is dropped with the terminator.
+			_held.clear();
+			pass_start = idx + 1;
+			continue;
+		}
+		else {
+			// "[version];[caps]" consists of hex digits and a separator.
+			matched = (isxdigit(static_cast<unsigned char>(ch)) || (ch == ';')) && (held_len - RESIZER_REPLY_PREFIX_LEN < RESIZER_REPLY_MAX_LEN);
+		}
+
+		if (matched) {
+			_held.push_back(ch);
+			continue;
+		}
+
+		// It is not a reply. Held data should be passed as it is, and ESC can start another reply.
+		writer(_held.c_str(), static_cast<DWORD>(_held.length()));
+		_held.clear();
+		if (ch == RESIZER_REPLY_PREFIX_STR[0]) {
+			_held.push_back(ch);
+		}
+		pass_start = idx;
+	}
+
+	if (_held.empty() && (len > pass_start)) {
+		writer(data + pass_start, len - pass_start);
+	}
+}
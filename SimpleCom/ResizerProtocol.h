@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+namespace SimpleCom {
+
+	// Encode v2 frame. payload should not be longer than RESIZER_V2_MAX_PAYLOAD.
+	std::string EncodeResizerFrame(BYTE type, const BYTE* payload, BYTE len);
+
+	// Encode resize request in the protocol version which is negotiated with TTY Resizer.
+	std::string EncodeResizeRequest(int version, const COORD& size);
+
+	std::string EncodeResizerHello(BYTE caps);
+
+	std::string EncodeResizerKeepalive(DWORD seq);
+
+	// unix_time_us is UNIX time in microseconds.
+	std::string EncodeResizerClockSync(ULONGLONG unix_time_us);
+
+	/*
+	 * Watches received data for the reply from TTY Resizer (see common.h), and keeps negotiated version.
+	 * Feed() would be called on the consumer thread of received data, and others can be called from any threads.
+	 * The event would be signaled when the reply is received.
+	 */
+	class ResizerNegotiator
+	{
+	private:
+		size_t _matched;
+		std::string _reply;
+		std::atomic<int> _version;
+		std::atomic<BYTE> _caps;
+		HANDLE _hNegotiatedEvent;
+
+		void ParseReply();
+
+	public:
+		ResizerNegotiator();
+		virtual ~ResizerNegotiator();
+
+		void Feed(const char* data, const DWORD len);
+
+		// 1 until TTY Resizer replies.
+		inline int GetVersion() const {
+			return _version.load(std::memory_order_acquire);
+		}
+
+		// Capabilities which both of SimpleCom and TTY Resizer support.
+		inline BYTE GetCapabilities() const {
+			return _caps.load(std::memory_order_acquire);
+		}
+
+		inline HANDLE negotiated_event() const {
+			return _hNegotiatedEvent;
+		}
+	};
+
+	/*
+	 * Removes replies from TTY Resizer from received data, so they would not reach to the console and the log.
+	 * Data which might be a part of the reply is held until the reply is completed or broken by subsequent data.
+	 */
+	class ResizerReplyFilter
+	{
+	private:
+		std::string _held;
+
+	public:
+		ResizerReplyFilter();
+		virtual ~ResizerReplyFilter() {};
+
+		// Pass data except replies to writer.
+		void Filter(const char* data, const DWORD len, const std::function<void(const char*, const DWORD)>& writer);
+	};
+
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "RxPipeline.h"
+#include "WinAPIException.h"
+#include "debug.h"
+#include "Trace.h"
+
+
+/*
+ * Get stdout, and enable VT sequences on it.
+ */
+static HANDLE PrepareConsoleOutput() {
+	DWORD mode;
+	HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
+	if (hStdOut == INVALID_HANDLE_VALUE) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("GetStdHandle(stdout)"));
+	}
+	CALL_WINAPI_WITH_LOG(GetConsoleMode(hStdOut, &mode), TRUE);
+	mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING | ENABLE_PROCESSED_OUTPUT;
+	CALL_WINAPI_WITH_LOG(SetConsoleMode(hStdOut, mode), TRUE);
+	return hStdOut;
+}
+
+SimpleCom::RxPipeline::RxPipeline(LogWriter* logwriter) : RxPipeline(PrepareConsoleOutput(), logwriter) {
+	// Do nothing
+}
+
+SimpleCom::RxPipeline::RxPipeline(HANDLE hOutput, LogWriter* logwriter) :
+	_log_markers(),
+	_console_markers(),
+	_has_log(logwriter != nullptr),
+	_filter_resizer_reply(false),
+	_triggers(nullptr),
+	_recorder(nullptr),
+	_stats(nullptr),
+	_hStdOut(hOutput),
+	_console_stage(),
+	_log_stage(),
+	_hConsoleEvent(CreateEvent(NULL, TRUE, FALSE, NULL), _T("CreateEvent for console in RxPipeline")),
+	_hLogEvent(CreateEvent(NULL, TRUE, FALSE, NULL), _T("CreateEvent for log in RxPipeline")),
+	_ring(rx_ring_sz)
+{
+	HANDLE hStdOut = hOutput;
+
+	// Each consumer has its own filter because they proceed independently.
+	_console_stage = std::make_unique<TapStage>([this, hStdOut, seq = 0ULL, filter = ResizerReplyFilter()](const char* data, const DWORD len) mutable {
+		ULONGLONG start = (_stats == nullptr) ? 0 : GetTickCount64();
+		_console_markers.Write(data, len, seq, [&](const char* buf, const DWORD buf_len) {
+			Deliver(filter, buf, buf_len, [hStdOut](const char* out, const DWORD out_len) {
+				TRACE_SCOPE("WriteFile(stdout)");
+				DWORD nBytesWritten;
+				if (!WriteFile(hStdOut, out, out_len, &nBytesWritten, NULL)) {
+					throw WinAPIException(GetLastError(), _T("WriteFile to stdout"));
+				}
+			});
+		});
+		seq += len;
+		if (_stats != nullptr) {
+			_stats->RecordConsoleWrite(GetTickCount64() - start);
+		}
+	});
+
+	// Console should not lose any data, so it blocks the producer when the ring is full.
+	_ring.Subscribe([this](const char* data, const DWORD len) {
+		_console_stage->Process(data, len).Wait(_hConsoleEvent.handle());
+	}, OverflowPolicy::BLOCK);
+
+	if (logwriter != nullptr) {
+		// The stage receives data from the beginning, so the number of bytes which are passed so far equals to the sequence of the data.
+		_log_stage = std::make_unique<TapStage>([this, logwriter, seq = 0ULL, filter = ResizerReplyFilter()](const char* data, const DWORD len) mutable {
+			_log_markers.Write(data, len, seq, [&](const char* buf, const DWORD buf_len) {
+				Deliver(filter, buf, buf_len, [logwriter](const char* out, const DWORD out_len) { logwriter->Write(out, out_len); });
+			});
+			seq += len;
+			if (_stats != nullptr) {
+				_stats->RecordLogDepth(_ring.GetHead() - seq);
+			}
+		});
+		_ring.Subscribe([this](const char* data, const DWORD len) {
+			_log_stage->Process(data, len).Wait(_hLogEvent.handle());
+		}, OverflowPolicy::BLOCK);
+	}
+}
+
+void SimpleCom::RxPipeline::Commit(const char* buf, DWORD len) {
+	// Triggers should see the data before consumers, so that log markers can be placed at the exact position.
+	if (_triggers != nullptr) {
+		_triggers->Scan(buf, len, _ring.GetHead());
+	}
+	if (_recorder != nullptr) {
+		_recorder->Record(RecordType::RX, buf, len);
+	}
+	_ring.Commit(len);
+}
+
+void SimpleCom::RxPipeline::Deliver(ResizerReplyFilter& filter, const char* data, const DWORD len, const std::function<void(const char*, const DWORD)>& sink) {
+	if (_filter_resizer_reply) {
+		filter.Filter(data, len, sink);
+	}
+	else {
+		sink(data, len);
+	}
+}
+
+void SimpleCom::RxPipeline::PushMarker(const std::string& marker, bool show_on_console) {
+	// Nobody drains the queue for the log if the log file is not configured.
+	ULONGLONG seq = _ring.GetHead();
+	if (_has_log) {
+		_log_markers.Push(seq, marker);
+	}
+	if (show_on_console) {
+		_console_markers.Push(seq, marker);
+	}
+}
+
+bool SimpleCom::RxPipeline::Publish(const char* data, DWORD len) {
+	while (len > 0) {
+		DWORD available;
+		char* dest = Claim(len, &available);
+		if (dest == nullptr) {
+			return false;
+		}
+
+		CopyMemory(dest, data, available);
+		Commit(dest, available);
+		data += available;
+		len -= available;
+	}
+
+	return true;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "BroadcastRing.h"
+#include "LogWriter.h"
+#include "Trigger.h"
+#include "SessionRecord.h"
+#include "SessionStats.h"
+#include "SessionPipeline.h"
+#include "ResizerProtocol.h"
+#include "WinAPIException.h"
+#include "util.h"
+
+// Size of the ring buffer for received data. It should be power of 2.
+static constexpr DWORD rx_ring_sz = 1024 * 1024;
+
+namespace SimpleCom {
+
+	/*
+	 * Stages for received data: triggers and recorder on the producer thread,
+	 * then console and log file as stages of the session pipeline. Each of them has its own consumer of the ring, so a slow log file does not stall the console.
+	 * Live sessions and replay share this pipeline, so they render the data in the same way.
+	 *
+	 * Claim() / Commit() / Publish() must be called from one thread only.
+	 */
+	class RxPipeline
+	{
+	private:
+		LogMarkerQueue _log_markers;
+		LogMarkerQueue _console_markers;
+		bool _has_log;
+		bool _filter_resizer_reply;
+		TriggerEngine* _triggers;
+		SessionRecorder* _recorder;
+		SessionStats* _stats;
+		HANDLE _hStdOut;
+		std::unique_ptr<TapStage> _console_stage;
+		std::unique_ptr<TapStage> _log_stage;
+		HandleHandler _hConsoleEvent;
+		HandleHandler _hLogEvent;
+		BroadcastRing _ring;  // should be destroyed first because its consumers run stages above
+
+		void Deliver(ResizerReplyFilter& filter, const char* data, const DWORD len, const std::function<void(const char*, const DWORD)>& sink);
+
+	public:
+		// Received data would be written to the console.
+		RxPipeline(LogWriter* logwriter);
+
+		// Received data would be written to hOutput instead of the console (e.g. NUL for benchmark).
+		RxPipeline(HANDLE hOutput, LogWriter* logwriter);
+		virtual ~RxPipeline() {};
+
+		// Sinks for received data can be added via this ring before Start().
+		inline BroadcastRing& ring() {
+			return _ring;
+		}
+
+		// Markers in this queue would be written into the log file at their positions in received data.
+		inline LogMarkerQueue& log_markers() {
+			return _log_markers;
+		}
+
+		// Markers in this queue would be written to the console at their positions in received data.
+		inline LogMarkerQueue& console_markers() {
+			return _console_markers;
+		}
+
+		// Put the marker at current position of received data into the log file, and into the console if show_on_console is true.
+		// This must be called from the producer thread.
+		void PushMarker(const std::string& marker, bool show_on_console);
+
+		inline HANDLE stdout_handle() const {
+			return _hStdOut;
+		}
+
+		// Triggers would be scanned on the producer thread. This should be called before Start().
+		inline void SetTriggerEngine(TriggerEngine* triggers) {
+			_triggers = triggers;
+		}
+
+		// Received data would be recorded on the producer thread. This should be called before Start().
+		inline void SetRecorder(SessionRecorder* recorder) {
+			_recorder = recorder;
+		}
+
+		// Replies from TTY Resizer would be removed before the console and the log. This should be called before Start().
+		inline void FilterResizerReply() {
+			_filter_resizer_reply = true;
+		}
+
+		// Stalls of the console and the depth of the log would be counted in consumers. This should be called before Start().
+		inline void SetStats(SessionStats* stats) {
+			_stats = stats;
+		}
+
+		inline void SetExceptionHandler(std::function<void(const WinAPIException&)> handler) {
+			_ring.SetExceptionHandler(handler);
+		}
+
+		inline char* Claim(DWORD len, DWORD* available) {
+			return _ring.Claim(len, available);
+		}
+
+		// buf should be the area which is returned from Claim().
+		void Commit(const char* buf, DWORD len);
+
+		// Returns false if the ring is aborted.
+		bool Publish(const char* data, DWORD len);
+
+		inline void Start() {
+			_ring.Start();
+		}
+
+		// Wait for consumers until they drain the ring.
+		inline void Shutdown() {
+			_ring.Shutdown();
+		}
+	};
+
+}
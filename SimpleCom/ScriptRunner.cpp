@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ScriptRunner.h"
+#include "SerialPortWriter.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+static constexpr int EXPECT_TIMEOUT = -1;
+static constexpr int EXPECT_ABORTED = -2;
+
+
+SimpleCom::ScriptRunner::ScriptRunner(ExpectScript& script, SerialHandle& serial, BroadcastRing& ring, HANDLE hTermEvent, std::function<void()> terminate_session) :
+	_script(script),
+	_serial(serial),
+	_hTermEvent(hTermEvent),
+	_terminate_session(terminate_session),
+	_matcher(nullptr),
+	_matched(-1),
+	_backlog(),
+	_modem(nullptr),
+	_line_config(nullptr),
+	_tasks()
+{
+	_hMatchEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_hMatchEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for ScriptRunner"));
+	}
+	InitializeSRWLock(&_lock);
+
+	// The script should see all of received data, so it blocks the reader when the ring is full.
+	ring.Subscribe([this](const char* data, const DWORD len) { OnReceive(data, len); }, OverflowPolicy::BLOCK);
+}
+
+SimpleCom::ScriptRunner::~ScriptRunner() {
+	AwaitTermination();
+	CloseHandle(_hMatchEvent);
+}
+
+/*
+ * Called on the consumer thread of the RX ring.
+ */
+void SimpleCom::ScriptRunner::OnReceive(const char* data, const DWORD len) {
+	AcquireSRWLockExclusive(&_lock);
+
+	if (_matcher == nullptr) {
+		_backlog.append(data, len);
+	}
+	else {
+		DWORD scanned = _matcher->Feed(data, len, [&](const int pattern_id, const DWORD end) {
+			_matched = pattern_id;
+			return false;
+		});
+
+		if (_matched >= 0) {
+			// Rest of data should be available for next `expect`.
+			_matcher = nullptr;
+			_backlog.append(data + scanned, len - scanned);
+			SetEvent(_hMatchEvent);
+		}
+	}
+
+	if (_backlog.length() > script_backlog_sz) {
+		_backlog.erase(0, _backlog.length() - script_backlog_sz);
+	}
+
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+/*
+ * Wait until one of patterns in the matcher is received.
+ * Returns pattern ID, EXPECT_TIMEOUT, or EXPECT_ABORTED.
+ */
+int SimpleCom::ScriptRunner::Expect(MultiPatternMatcher& matcher, DWORD timeout) {
+	AcquireSRWLockExclusive(&_lock);
+	matcher.Reset();
+	_matched = -1;
+
+	// Data which has been received before this `expect` should be scanned at first.
+	DWORD scanned = matcher.Feed(_backlog.data(), static_cast<DWORD>(_backlog.length()), [&](const int pattern_id, const DWORD end) {
+		_matched = pattern_id;
+		return false;
+	});
+	_backlog.erase(0, scanned);
+
+	int matched = _matched;
+	if (matched < 0) {
+		ResetEvent(_hMatchEvent);
+		_matcher = &matcher;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+
+	if (matched >= 0) {
+		return matched;
+	}
+
+	HANDLE waiters[] = { _hMatchEvent, _hTermEvent };
+	DWORD result = WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, (timeout == 0) ? INFINITE : timeout);
+
+	AcquireSRWLockExclusive(&_lock);
+	_matcher = nullptr;
+	matched = _matched;
+	ReleaseSRWLockExclusive(&_lock);
+
+	if (matched >= 0) {
+		return matched;
+	}
+	else if (result == WAIT_TIMEOUT) {
+		return EXPECT_TIMEOUT;
+	}
+	else if (result == (WAIT_OBJECT_0 + 1)) {
+		return EXPECT_ABORTED;
+	}
+	throw WinAPIException(GetLastError(), _T("WaitForMultipleObjects in ScriptRunner"));
+}
+
+void SimpleCom::ScriptRunner::Start() {
+	Executor::Default().Submit(_tasks, [this] { Run(); });
+}
+
+void SimpleCom::ScriptRunner::Run() {
+	DWORD timeout = SCRIPT_DEFAULT_TIMEOUT;
+	int line = 0;
+
+	auto finish = [&](int exit_code, const std::string& message, bool terminate_session) {
+		_script.SetResult(exit_code, message.empty() ? message : ("Script line " + std::to_string(line) + ": " + message));
+		if (terminate_session) {
+			_terminate_session();
+		}
+	};
+
+	// Only PutData() is used, so the writer does not need its own buffer.
+	SerialPortWriter writer(_serial, 1);
+
+	try {
+		for (auto& step : _script.GetSteps()) {
+			line = step.line;
+
+			switch (step.command) {
+			case ScriptCommand::TIMEOUT:
+				timeout = step.value;
+				break;
+
+			case ScriptCommand::SLEEP:
+				if (WaitForSingleObject(_hTermEvent, step.value) == WAIT_OBJECT_0) {
+					finish(SCRIPT_EXIT_ABORTED, "Session is finished", false);
+					return;
+				}
+				break;
+
+			case ScriptCommand::SEND:
+				// step.data is alive until the script is discarded, so it can be written asynchronously.
+				writer.PutData(step.data.c_str(), static_cast<int>(step.data.length()));
+				break;
+
+			case ScriptCommand::EXPECT: {
+				int matched = Expect(step.matcher, timeout);
+				if (matched == EXPECT_ABORTED) {
+					finish(SCRIPT_EXIT_ABORTED, "Session is finished", false);
+					return;
+				}
+				else if (matched == EXPECT_TIMEOUT) {
+					finish(SCRIPT_EXIT_TIMEOUT, "Timed out", true);
+					return;
+				}
+				else if (matched >= step.num_expected) {
+					finish(step.fail_codes[matched - step.num_expected], "Failure pattern is received: " + step.matcher.GetPatterns()[matched], true);
+					return;
+				}
+				break;
+			}
+
+			case ScriptCommand::BREAK: {
+				if (_modem == nullptr) {
+					throw WinAPIException(_T("ScriptRunner"), _T("Modem control is not available"));
+				}
+
+				// BREAK might be cleared by the stdin thread as well, so wait until the controller finishes it.
+				_modem->StartBreak(step.value);
+				DWORD remaining;
+				while ((remaining = _modem->GetTimeout()) != INFINITE) {
+					if (WaitForSingleObject(_hTermEvent, remaining) == WAIT_OBJECT_0) {
+						finish(SCRIPT_EXIT_ABORTED, "Session is finished", false);
+						return;
+					}
+					_modem->Poll();
+				}
+				break;
+			}
+
+			case ScriptCommand::DTR:
+			case ScriptCommand::RTS:
+				if (_modem == nullptr) {
+					throw WinAPIException(_T("ScriptRunner"), _T("Modem control is not available"));
+				}
+				if (step.command == ScriptCommand::DTR) {
+					_modem->SetDTR(step.value != 0);
+				}
+				else {
+					_modem->SetRTS(step.value != 0);
+				}
+				break;
+
+			case ScriptCommand::BAUD:
+			case ScriptCommand::FLOW:
+				if (_line_config == nullptr) {
+					throw WinAPIException(_T("ScriptRunner"), _T("Reconfiguration is not available"));
+				}
+				if (step.command == ScriptCommand::BAUD) {
+					_line_config->SetBaudRate(step.value);
+				}
+				else {
+					_line_config->SetFlowControl(FlowControl::values[step.value]);
+				}
+				break;
+
+			case ScriptCommand::EXIT:
+				finish(step.value, "", true);
+				return;
+			}
+		}
+
+		// The session continues interactively after the script.
+		finish(0, "", false);
+	}
+	catch (WinAPIException& e) {
+		debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+		finish(SCRIPT_EXIT_ABORTED, "Error occurred (" + std::to_string(e.GetErrorCode()) + ")", true);
+		// Do not shut down the writer here: its destructor has to wait for the pending "send" write.
+	}
+}
+
+void SimpleCom::ScriptRunner::AwaitTermination() {
+	_tasks.Await();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "ExpectScript.h"
+#include "BroadcastRing.h"
+#include "SerialHandle.h"
+#include "ModemControl.h"
+#include "LineConfig.h"
+#include "Executor.h"
+
+// Received data which is not consumed by `expect` is kept up to this size.
+static constexpr size_t script_backlog_sz = 64 * 1024;
+
+namespace SimpleCom {
+
+	/*
+	 * Runs ExpectScript on its own task of the executor in the serial session.
+	 * Received data is fed to the matcher incrementally via a consumer of the RX ring,
+	 * so received bytes are scanned only once even if they arrive in small chunks.
+	 *
+	 * terminate_session is called when the script finishes the session (`exit`, timeout, or `fail`).
+	 */
+	class ScriptRunner
+	{
+	private:
+		ExpectScript& _script;
+		SerialHandle& _serial;
+		HANDLE _hTermEvent;
+		std::function<void()> _terminate_session;
+		HANDLE _hMatchEvent;
+		SRWLOCK _lock;
+		MultiPatternMatcher* _matcher;
+		int _matched;
+		std::string _backlog;
+		ModemController* _modem;
+		LineConfigurator* _line_config;
+		TaskGroup _tasks;
+
+		void OnReceive(const char* data, const DWORD len);
+		int Expect(MultiPatternMatcher& matcher, DWORD timeout);
+
+	public:
+		ScriptRunner(ExpectScript& script, SerialHandle& serial, BroadcastRing& ring, HANDLE hTermEvent, std::function<void()> terminate_session);
+		virtual ~ScriptRunner();
+
+		// `break`, `dtr`, and `rts` would be performed via this controller. This should be called before Start().
+		inline void SetModemController(ModemController* modem) {
+			_modem = modem;
+		}
+
+		// `baud` and `flow` would be performed via this configurator. This should be called before Start().
+		inline void SetLineConfigurator(LineConfigurator* line_config) {
+			_line_config = line_config;
+		}
+
+		void Start();
+		void Run();
+		void AwaitTermination();
+	};
+
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "ScriptTokenizer.h"
+
+
+void SimpleCom::ThrowScriptSyntaxError(int line_num, const std::string& message) {
+	throw std::invalid_argument("Script line " + std::to_string(line_num) + ": " + message);
+}
+
+static int HexValue(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	else if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+std::vector<SimpleCom::TScriptToken> SimpleCom::TokenizeScriptLine(const std::string& line, int line_num) {
+	std::vector<TScriptToken> tokens;
+	size_t pos = 0;
+
+	while (pos < line.length()) {
+		char c = line[pos];
+		if (c == ' ' || c == '\t' || c == '\r') {
+			pos++;
+			continue;
+		}
+		if (c == '#') {
+			break;
+		}
+
+		TScriptToken token = { .text = "", .quoted = (c == '"') };
+		if (token.quoted) {
+			pos++;
+			while (true) {
+				if (pos >= line.length()) {
+					ThrowScriptSyntaxError(line_num, "Unterminated string");
+				}
+
+				c = line[pos++];
+				if (c == '"') {
+					break;
+				}
+				if (c != '\\') {
+					token.text += c;
+					continue;
+				}
+
+				if (pos >= line.length()) {
+					ThrowScriptSyntaxError(line_num, "Unterminated escape sequence");
+				}
+				c = line[pos++];
+				switch (c) {
+				case 'r': token.text += '\r'; break;
+				case 'n': token.text += '\n'; break;
+				case 't': token.text += '\t'; break;
+				case 'e': token.text += '\x1b'; break;
+				case '\\': token.text += '\\'; break;
+				case '"': token.text += '"'; break;
+				case 'x': {
+					int high = (pos < line.length()) ? HexValue(line[pos]) : -1;
+					int low = (pos + 1 < line.length()) ? HexValue(line[pos + 1]) : -1;
+					if (high < 0 || low < 0) {
+						ThrowScriptSyntaxError(line_num, "\\x should be followed by 2 hex digits");
+					}
+					token.text += static_cast<char>((high << 4) | low);
+					pos += 2;
+					break;
+				}
+				default:
+					ThrowScriptSyntaxError(line_num, std::string("Unknown escape sequence: \\") + c);
+				}
+			}
+		}
+		else {
+			while (pos < line.length() && line[pos] != ' ' && line[pos] != '\t' && line[pos] != '\r' && line[pos] != '#') {
+				token.text += line[pos++];
+			}
+		}
+
+		tokens.push_back(token);
+	}
+
+	return tokens;
+}
+
+int SimpleCom::ParseScriptNumber(const TScriptToken& token, int line_num) {
+	if (token.quoted || token.text.empty()) {
+		ThrowScriptSyntaxError(line_num, "Number is expected: " + token.text);
+	}
+
+	char* endptr;
+	long value = strtol(token.text.c_str(), &endptr, 10);
+	if (*endptr != '\0' || value < 0 || value > INT_MAX) {
+		ThrowScriptSyntaxError(line_num, "Invalid number: " + token.text);
+	}
+
+	return static_cast<int>(value);
+}
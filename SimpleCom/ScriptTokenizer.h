@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+namespace SimpleCom {
+
+	/*
+	 * Token in script files (script for --script, trigger file, and so on).
+	 * quoted is true if the token is a string literal. Escape sequences in it are already resolved.
+	 */
+	typedef struct {
+		std::string text;
+		bool quoted;
+	} TScriptToken;
+
+	/*
+	 * Split a line into tokens. `#` out of string literals starts a comment.
+	 * String literals can contain \r, \n, \t, \e, \\, \", and \xHH.
+	 * std::invalid_argument would be thrown if the line has syntax error.
+	 */
+	std::vector<TScriptToken> TokenizeScriptLine(const std::string& line, int line_num);
+
+	// Parse non-negative decimal number. std::invalid_argument would be thrown if the token is not a number.
+	int ParseScriptNumber(const TScriptToken& token, int line_num);
+
+	[[noreturn]] void ThrowScriptSyntaxError(int line_num, const std::string& message);
+
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2025, Yasumasa Suenaga
+ * Copyright (C) 2023, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -20,37 +20,85 @@
 #include "SerialConnection.h"
 #include "util.h"
 #include "TerminalRedirector.h"
+#include "SerialHandle.h"
 #include "BatchRedirector.h"
+#include "ScriptRunner.h"
+#include "ModemControl.h"
+#include "AutoBaud.h"
+#include "LineConfig.h"
 #include "debug.h"
 #include "../common/common.h"
 
 
 SimpleCom::SerialConnection::SerialConnection(TString& device, DCB* dcb, LPCTSTR logfilename, bool enableStdinLogging) :
 	_device(device),
-	_enableStdinLogging(enableStdinLogging)
+	_enableStdinLogging(enableStdinLogging),
+	_resolver(),
+	_stats(),
+	_stats_file(nullptr),
+	_showLineErrors(false),
+	_trace_file(nullptr),
+	_autoBaud(false),
+	_showBaudRate(false)
 {
 	CopyMemory(&_dcb, dcb, sizeof(_dcb));
 	_logwriter = (logfilename == nullptr) ? nullptr : new LogWriter(logfilename);
 }
 
+/*
+ * Baud rate would be shown if it is different from the configuration (detected or reconfigured).
+ */
+static TString FormatTitle(const TString& device, const DCB& dcb, bool show_baud_rate) {
+	TStringStream title;
+	title << _T("SimpleCom: ") << device;
+	if (show_baud_rate) {
+		title << _T(" (") << dcb.BaudRate << _T(" baud)");
+	}
+	return title.str();
+}
+
 void SimpleCom::SerialConnection::InitSerialPort(const HANDLE hSerial) {
-	TString title = _T("SimpleCom: ") + _device;
-	CALL_WINAPI_WITH_DEBUGLOG(SetConsoleTitle(title.c_str()), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(SetConsoleTitle(FormatTitle(_device, _dcb, _showBaudRate).c_str()), TRUE)
 
-	CALL_WINAPI_WITH_DEBUGLOG(SetCommState(hSerial, &_dcb), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(SetCommState(hSerial, &_dcb), TRUE)
 
-	CALL_WINAPI_WITH_DEBUGLOG(PurgeComm(hSerial, PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR), TRUE, __FILE__, __LINE__)
-	CALL_WINAPI_WITH_DEBUGLOG(SetCommMask(hSerial, EV_RXCHAR), TRUE, __FILE__, __LINE__)
-	CALL_WINAPI_WITH_DEBUGLOG(SetupComm(hSerial, buf_sz, buf_sz), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(PurgeComm(hSerial, PURGE_TXABORT | PURGE_RXABORT | PURGE_TXCLEAR | PURGE_RXCLEAR), TRUE)
+	CALL_WINAPI_WITH_LOG(SetCommMask(hSerial, EV_RXCHAR | modem_event_mask), TRUE)
+	CALL_WINAPI_WITH_LOG(SetupComm(hSerial, buf_sz, buf_sz), TRUE)
 
 	COMMTIMEOUTS comm_timeouts;
-	CALL_WINAPI_WITH_DEBUGLOG(GetCommTimeouts(hSerial, &comm_timeouts), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(GetCommTimeouts(hSerial, &comm_timeouts), TRUE)
 	comm_timeouts.ReadIntervalTimeout = 0;
 	comm_timeouts.ReadTotalTimeoutMultiplier = 0;
 	comm_timeouts.ReadTotalTimeoutConstant = 10;
 	comm_timeouts.WriteTotalTimeoutMultiplier = 0;
 	comm_timeouts.WriteTotalTimeoutConstant = 0;
-	CALL_WINAPI_WITH_DEBUGLOG(SetCommTimeouts(hSerial, &comm_timeouts), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(SetCommTimeouts(hSerial, &comm_timeouts), TRUE)
+}
+
+/*
+ * Detect baud rate before starting the session.
+ * DCB.BaudRate would be updated on the open port, and the configured rate would be kept if it could not be detected.
+ */
+void SimpleCom::SerialConnection::DetectBaudRate(const HANDLE hSerial) {
+	TString title = _T("SimpleCom: ") + _device;
+	CALL_WINAPI_WITH_LOG(SetConsoleTitle((title + _T(" | detecting baud rate...")).c_str()), TRUE)
+
+	SerialBaudSampler sampler(hSerial, _dcb);
+	AutoBaudDetector detector(sampler);
+	DWORD baud_rate = detector.Detect(autobaud_timeout_ms);
+	if (baud_rate == 0) {
+		debug::log(LogLevel::WARN, _T("Baud rate could not be detected, {} baud is used"), _dcb.BaudRate);
+	}
+	else {
+		debug::log(LogLevel::INFO, _T("Baud rate is detected: {} baud"), baud_rate);
+		_dcb.BaudRate = baud_rate;
+		_autoBaud = false;
+		_showBaudRate = true;
+	}
+
+	// Sampler leaves the port at the last candidate.
+	InitSerialPort(hSerial);
 }
 
 
@@ -58,15 +106,122 @@ void SimpleCom::SerialConnection::InitSerialPort(const HANDLE hSerial) {
 /*
  * Talk with peripheral.
  * Set true to allowDetachDevice if the function would be finished silently when serial controller is detached.
+ * Resize request to TTY Resizer would be sent after resizeDebounceMs of quiet period.
+ * script would be run in this session if it is not finished yet.
+ * triggers would be scanned on received data if it is not nullptr.
+ * Received data and keys from console would be recorded if recorder is not nullptr.
+ * Detached serial controller would be reopened with reconnectPolicy in this session. The session would be finished on detaching if it is nullptr.
  */
-bool SimpleCom::SerialConnection::DoSession(bool allowDetachDevice, bool useTTYResizer, HWND parent_hwnd) {
-	HandleHandler hSerial(CreateFile(_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL), _T("Open serial port"));
-	InitSerialPort(hSerial.handle());
+bool SimpleCom::SerialConnection::DoSession(bool allowDetachDevice, bool useTTYResizer, DWORD resizeDebounceMs, HWND parent_hwnd, ExpectScript* script, TriggerSet* triggers, SessionRecorder* recorder, ReconnectPolicy* reconnectPolicy) {
+	if (_resolver) {
+		// The adapter might be arrived with another port since the previous session.
+		TString device = _resolver();
+		if (!device.empty()) {
+			_device = device;
+		}
+	}
+
+	HANDLE hSerial = CreateFile(_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+	if (hSerial == INVALID_HANDLE_VALUE) {
+		throw WinAPIException(GetLastError(), _T("Open serial port"));
+	}
+	SerialHandle serial(hSerial, true);
+	serial.SetStats(&_stats);
+	InitSerialPort(serial.Get());
+	if (_autoBaud) {
+		DetectBaudRate(serial.Get());
+	}
+
+	// Initial state of DTR and RTS is set by SetCommState().
+	SerialModemPort modem_port(serial);
+	ModemController modem(modem_port, _dcb.fDtrControl == DTR_CONTROL_ENABLE, _dcb.fRtsControl == RTS_CONTROL_ENABLE);
+	modem.SetStats(&_stats);
+
+	// DCB can be changed while the session is running.
+	SerialLinePort line_port(serial);
+	LineConfigurator line_config(line_port, _dcb);
+	line_config.SetModemController(&modem);
+	line_config.SetListener([this, device = _device](const DCB& dcb) {
+		_showBaudRate = true;
+		CALL_WINAPI_WITH_LOG(SetConsoleTitle(FormatTitle(device, dcb, true).c_str()), TRUE)
+	});
 
-	TerminalRedirector redirector(hSerial.handle(), _logwriter, _enableStdinLogging, useTTYResizer, parent_hwnd);
+	// Threads, log, and console are kept across reconnection. Only the handle would be swapped.
+	std::function<HANDLE(HANDLE)> reconnect;
+	if (reconnectPolicy != nullptr) {
+		reconnect = [&](HANDLE hTermEvent) -> HANDLE {
+			SerialDeviceProvider provider = _resolver ? SerialDeviceProvider(_resolver, hTermEvent) : SerialDeviceProvider(_device, hTermEvent);
+			HANDLE hNewSerial = reconnectPolicy->Open(provider);
+			if (hNewSerial != INVALID_HANDLE_VALUE) {
+				_device = provider.GetDevice();
+				_dcb = line_config.GetDCB();
+				InitSerialPort(hNewSerial);
+			}
+			return hNewSerial;
+		};
+	}
+
+	TerminalRedirector redirector(serial, _logwriter, _enableStdinLogging, useTTYResizer, resizeDebounceMs, parent_hwnd, reconnect);
+	redirector.SetStats(&_stats);
+	redirector.SetStatsHotkey(_stats_file != nullptr);
+	redirector.SetShowLineErrors(_showLineErrors);
+	redirector.SetTraceFile(_trace_file);
+	redirector.SetModemController(&modem);
+	redirector.SetLineConfigurator(&line_config);
+	if (recorder != nullptr) {
+		redirector.SetRecorder(recorder);
+	}
+
+	std::unique_ptr<TriggerEngine> trigger_engine;
+	if (triggers != nullptr) {
+		trigger_engine = std::make_unique<TriggerEngine>(*triggers, serial, (_logwriter == nullptr) ? nullptr : &redirector.log_markers(), _T("SimpleCom: ") + _device);
+		trigger_engine->SetLineConfigurator(&line_config);
+		redirector.SetTriggerEngine(trigger_engine.get());
+	}
+
+	std::unique_ptr<ScriptRunner> runner;
+	if ((script != nullptr) && !script->IsFinished()) {
+		runner = std::make_unique<ScriptRunner>(*script, serial, redirector.rx_ring(), redirector.term_event(), [&redirector] { redirector.Terminate(); });
+		runner->SetModemController(&modem);
+		runner->SetLineConfigurator(&line_config);
+	}
+
+	if (trigger_engine) {
+		trigger_engine->Start();
+	}
 	redirector.StartRedirector();
+	if (runner) {
+		runner->Start();
+	}
 
 	redirector.AwaitTermination();
+	if (runner) {
+		runner->AwaitTermination();
+	}
+	if (trigger_engine) {
+		trigger_engine->Stop();
+	}
+
+	// Next session should start with the configuration at the end of this session.
+	_dcb = line_config.GetDCB();
+
+	if (_stats_file != nullptr) {
+		try {
+			_stats.Dump(_stats_file);
+		}
+		catch (WinAPIException& e) {
+			// Statistics should not affect the result of the session.
+			debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+		}
+	}
+
+	// Histogram would be formatted only if it is logged.
+	if ((serial.GetReconnectCount() > 0) && debug::IsEnabled(LogLevel::INFO)) {
+		debug::log(LogLevel::INFO, _T("Latency from reopening to the first received data:\n{}"), serial.first_rx_latency().Format(_T("us")));
+	}
+	if (debug::IsEnabled(LogLevel::INFO)) {
+		debug::log(LogLevel::INFO, _T("Latency from submitting to starting redirectors:\n{}"), redirector.GetSchedulingLatency().Format(_T("us")));
+	}
 
 	WinAPIException ex;
 	while (redirector.exception_queue().try_pop(ex)) {
@@ -81,8 +236,7 @@ bool SimpleCom::SerialConnection::DoSession(bool allowDetachDevice, bool useTTYR
 		case ERROR_BAD_COMMAND:
 		case ERROR_DEVICE_REMOVED:
 			if (ex.IsSerialAPIException() && allowDetachDevice) {
-				debug::log(_T("SerialAPIException occurred, but error dialog was suppressed because allowDetachDevice is false."));
-				debug::log(ex.GetErrorText().c_str());
+				debug::log(LogLevel::WARN, _T("SerialAPIException occurred, but error dialog was suppressed because allowDetachDevice is false: {}"), ex.GetErrorText());
 				continue;
 			}
 			[[fallthrough]];
@@ -96,9 +250,18 @@ bool SimpleCom::SerialConnection::DoSession(bool allowDetachDevice, bool useTTYR
 }
 
 void SimpleCom::SerialConnection::DoBatch() {
-	HandleHandler hSerial(CreateFile(_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL), _T("Open serial port"));
+	HandleHandler hSerial(CreateFile(_device.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL), _T("Open serial port"));
 	InitSerialPort(hSerial.handle());
 
+	// Reads in batch mode are completed asynchronously, so they should wait for the first byte rather than time out every 10 msecs.
+	// ReadFile() returns immediately with received bytes, or waits until the first byte arrives.
+	COMMTIMEOUTS comm_timeouts;
+	CALL_WINAPI_WITH_LOG(GetCommTimeouts(hSerial.handle(), &comm_timeouts), TRUE)
+	comm_timeouts.ReadIntervalTimeout = MAXDWORD;
+	comm_timeouts.ReadTotalTimeoutMultiplier = MAXDWORD;
+	comm_timeouts.ReadTotalTimeoutConstant = MAXDWORD - 1;
+	CALL_WINAPI_WITH_LOG(SetCommTimeouts(hSerial.handle(), &comm_timeouts), TRUE)
+
 	BatchRedirector redirector(hSerial.handle());
 
 	redirector.StartRedirector();
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2025, Yasumasa Suenaga
+ * Copyright (C) 2023, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -20,6 +20,11 @@
 
 #include "stdafx.h"
 #include "LogWriter.h"
+#include "ExpectScript.h"
+#include "Trigger.h"
+#include "SessionRecord.h"
+#include "ReconnectPolicy.h"
+#include "SessionStats.h"
 
 
 namespace SimpleCom {
@@ -31,15 +36,52 @@ namespace SimpleCom {
 		DCB _dcb;
 		LogWriter* _logwriter;
 		bool _enableStdinLogging;
+		std::function<TString()> _resolver;
+		SessionStats _stats;
+		LPCTSTR _stats_file;
+		bool _showLineErrors;
+		LPCTSTR _trace_file;
+		bool _autoBaud;
+		std::atomic<bool> _showBaudRate;
 
 		void InitSerialPort(const HANDLE hSerial);
+		void DetectBaudRate(const HANDLE hSerial);
 
 	public:
 		SerialConnection(TString& device, DCB* dcb, LPCTSTR logfilename, bool enableStdinLogging);
 		SerialConnection(TString& device, DCB* dcb) : SerialConnection(device, dcb, nullptr, false) {};
 		virtual ~SerialConnection() {};
 
-		bool DoSession(bool allowDetachDevice, bool useTTYResizer, HWND parent_hwnd);
+		// Device would be resolved with resolver at the start of the session and reconnection if it is set.
+		inline void SetDeviceResolver(std::function<TString()> resolver) {
+			_resolver = resolver;
+		}
+
+		// Statistics would be written to the file whenever a session is finished. They are accumulated across reconnected sessions.
+		inline void SetStatsFile(LPCTSTR stats_file) {
+			_stats_file = stats_file;
+		}
+
+		// Line errors would be shown on the console as well as the log file.
+		inline void SetShowLineErrors(bool show) {
+			_showLineErrors = show;
+		}
+
+		// Trace events would be dumped to the file when F3 is pressed in the session.
+		inline void SetTraceFile(LPCTSTR trace_file) {
+			_trace_file = trace_file;
+		}
+
+		// Baud rate would be detected from received data at the start of the session. Detected rate is kept in reconnected sessions.
+		inline void SetAutoBaud(bool enabled) {
+			_autoBaud = enabled;
+		}
+
+		inline const SessionStats& stats() const {
+			return _stats;
+		}
+
+		bool DoSession(bool allowDetachDevice, bool useTTYResizer, DWORD resizeDebounceMs, HWND parent_hwnd, ExpectScript* script, TriggerSet* triggers, SessionRecorder* recorder, ReconnectPolicy* reconnectPolicy);
 		void DoBatch();
 	};
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2024, Yasumasa Suenaga
+ * Copyright (C) 2023, 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,17 +21,31 @@
 #include "SerialDeviceScanner.h"
 #include "WinAPIException.h"
 #include "util.h"
+#include "debug.h"
 #include "resource.h"
 
+#include <initguid.h>
+#include <devguid.h>
+#include <SetupAPI.h>
+
 typedef struct {
 	SimpleCom::SerialDeviceScanner* scanner;
 	HWND parent_hwnd;
 } TWaitSerialDeviceDlgEntryParam;
 
+// Parent of SERIALCOMM. SERIALCOMM itself might not exist until the first serial device arrives.
+static constexpr LPCTSTR DEVICEMAP_KEY = _T(R"(HARDWARE\DEVICEMAP)");
+
+// Scan the registry at least this interval even if no notification is received.
+static constexpr DWORD device_rescan_interval_ms = 5000;
+
 
-SimpleCom::SerialDeviceScanner::SerialDeviceScanner() : _dialog_hwnd(nullptr),
-                                                        _devices(),
-                                                        _target_port()
+SimpleCom::SerialDeviceScanner::SerialDeviceScanner() : SerialDeviceScanner(std::make_unique<RegistryDeviceSource>()) {}
+
+SimpleCom::SerialDeviceScanner::SerialDeviceScanner(std::unique_ptr<DeviceSource> source) : _dialog_hwnd(nullptr),
+                                                                                            _devices(),
+                                                                                            _target_port(),
+                                                                                            _source(std::move(source))
 {
 	_device_scan_event = CreateEvent(nullptr, TRUE, FALSE, nullptr);
 	if (_device_scan_event == INVALID_HANDLE_VALUE) {
@@ -93,21 +107,29 @@ DWORD WINAPI WaitSerialDeviceDlgEntry(_In_ LPVOID lpParameter) {
 
 /*
  * Entry point for waiting serial device is ready.
+ * The registry would be scanned when HKLM\HARDWARE\DEVICEMAP is changed, so the device would be found as soon as it arrives.
  */
 DWORD WINAPI WaitSerialDeviceEntry(_In_ LPVOID lpParameter) {
 	SimpleCom::SerialDeviceScanner* scanner = reinterpret_cast<SimpleCom::SerialDeviceScanner*>(lpParameter);
-	DWORD wait_result;
+
+	HKEY hKey;
+	LSTATUS status = RegOpenKeyEx(HKEY_LOCAL_MACHINE, DEVICEMAP_KEY, 0, KEY_NOTIFY, &hKey);
+	HANDLE hNotifyEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	HANDLE waiters[] = { scanner->GetDeviceScanEvent(), hNotifyEvent };
+	bool notifiable = (status == ERROR_SUCCESS) && (hNotifyEvent != NULL);
+
 	while (true) {
-		wait_result = WaitForSingleObject(scanner->GetDeviceScanEvent(), 0);
-		if (wait_result == WAIT_OBJECT_0) {
-			break;
+		// Notification should be registered before scanning, otherwise the change during the scan would be lost.
+		if (notifiable && (RegNotifyChangeKeyValue(hKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET, hNotifyEvent, TRUE) != ERROR_SUCCESS)) {
+			SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("RegNotifyChangeKeyValue failed, fallback to polling"));
+			notifiable = false;
 		}
 
 		try {
 			scanner->ScanSerialDevices();
 			if (!scanner->GetDevices().empty()) {
 				auto target = scanner->GetTargetPort();
-				bool can_break = target.empty() ? true : scanner->GetDevices().contains(target);
+				bool can_break = target.empty() ? true : scanner->GetDevices().contains(scanner->ResolvePort(target));
 				if (can_break) {
 					SendMessage(scanner->GetDialogHwnd(), WM_APP, 0, 0);
 					SetEvent(scanner->GetDeviceScanEvent());
@@ -118,7 +140,19 @@ DWORD WINAPI WaitSerialDeviceEntry(_In_ LPVOID lpParameter) {
 		catch (...) {
 			// Ignore
 		}
-		Sleep(1000);
+
+		DWORD wait_result = notifiable ? WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, device_rescan_interval_ms)
+		                               : WaitForSingleObject(scanner->GetDeviceScanEvent(), 1000);
+		if (wait_result == WAIT_OBJECT_0) {
+			break;
+		}
+	}
+
+	if (status == ERROR_SUCCESS) {
+		RegCloseKey(hKey);
+	}
+	if (hNotifyEvent != NULL) {
+		CloseHandle(hNotifyEvent);
 	}
 	return 0;
 }
@@ -156,11 +190,45 @@ void SimpleCom::SerialDeviceScanner::WaitSerialDevices(const HWND parent_hwnd, c
 	}
 }
 
-void SimpleCom::SerialDeviceScanner::ScanSerialDevices() {
-	_devices.clear();
+SimpleCom::RegistryDeviceSource::RegistryDeviceSource() : _hNotifyKey(NULL) {
+	LSTATUS status = RegOpenKeyEx(HKEY_LOCAL_MACHINE, DEVICEMAP_KEY, 0, KEY_NOTIFY, &_hNotifyKey);
+	if (status != ERROR_SUCCESS) {
+		_hNotifyKey = NULL;
+	}
+	_hNotifyEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+	_notifiable = (_hNotifyKey != NULL) && (_hNotifyEvent != NULL);
+}
+
+SimpleCom::RegistryDeviceSource::~RegistryDeviceSource() {
+	if (_hNotifyKey != NULL) {
+		RegCloseKey(_hNotifyKey);
+	}
+	if (_hNotifyEvent != NULL) {
+		CloseHandle(_hNotifyEvent);
+	}
+}
+
+bool SimpleCom::RegistryDeviceSource::HasChanged() {
+	return !_notifiable || (WaitForSingleObject(_hNotifyEvent, 0) == WAIT_OBJECT_0);
+}
+
+/*
+ * Generates device map of serial interface name and device name
+ * from HKLM\HARDWARE\DEVICEMAP\SERIALCOMM.
+ */
+SimpleCom::TDeviceMap SimpleCom::RegistryDeviceSource::ListPorts() {
+	TDeviceMap latest;
+
+	// Notification should be registered before reading, otherwise the change during the scan would be lost.
+	// This might be called from the thread which exits soon (e.g. WaitSerialDeviceEntry), so the registration should not be bound to the thread.
+	if (_notifiable) {
+		ResetEvent(_hNotifyEvent);
+		if (RegNotifyChangeKeyValue(_hNotifyKey, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET | REG_NOTIFY_THREAD_AGNOSTIC, _hNotifyEvent, TRUE) != ERROR_SUCCESS) {
+			debug::log(LogLevel::WARN, _T("RegNotifyChangeKeyValue failed, devices would be scanned every time"));
+			_notifiable = false;
+		}
+	}
 
-	// Generates device map of serial interface name and device name
-	// from HKLM\HARDWARE\DEVICEMAP\SERIALCOMM.
 	RegistryKeyHandler hkeyHandler(HKEY_LOCAL_MACHINE, _T(R"(HARDWARE\DEVICEMAP\SERIALCOMM)"), REG_OPTION_OPEN_LINK, KEY_READ);
 	HKEY hKey = hkeyHandler.key();
 
@@ -170,7 +238,7 @@ void SimpleCom::SerialDeviceScanner::ScanSerialDevices() {
 		throw WinAPIException(status, _T("RegQueryInfoKey"));
 	}
 	else if (numValues <= 0) {
-		throw SerialDeviceScanException(_T("configuration"), _T("Serial interface not found"));
+		return latest;
 	}
 
 	maxValueLen++;
@@ -187,11 +255,130 @@ void SimpleCom::SerialDeviceScanner::ScanSerialDevices() {
 			// DeviceName (lpData in RegEnumValue) might not be null-terminated, so we need to add null char (0).
 			// This argument is defined as LPBYTE, so we need to divide the length with sizeof(TCHAR).
 			DeviceName[ValueLen / sizeof(TCHAR)] = 0;
-			_devices[DeviceName] = InterfaceName;
+			latest[DeviceName] = InterfaceName;
 		}
 
 	}
 
 	delete[] InterfaceName;
 	delete[] DeviceName;
+
+	return latest;
+}
+
+/*
+ * Collect metadata of present devices in Ports class via SetupAPI.
+ */
+std::vector<SimpleCom::TDeviceInfo> SimpleCom::RegistryDeviceSource::QueryMetadata() {
+	std::vector<SimpleCom::TDeviceInfo> result;
+
+	HDEVINFO hDevInfo = SetupDiGetClassDevs(&GUID_DEVCLASS_PORTS, nullptr, nullptr, DIGCF_PRESENT);
+	if (hDevInfo == INVALID_HANDLE_VALUE) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("SetupDiGetClassDevs"));
+	}
+
+	SP_DEVINFO_DATA devinfo = { .cbSize = sizeof(SP_DEVINFO_DATA) };
+	for (DWORD idx = 0; SetupDiEnumDeviceInfo(hDevInfo, idx, &devinfo); idx++) {
+		SimpleCom::TDeviceInfo info;
+		TCHAR buf[MAX_PATH];
+
+		HKEY hKey = SetupDiOpenDevRegKey(hDevInfo, &devinfo, DICS_FLAG_GLOBAL, 0, DIREG_DEV, KEY_READ);
+		if (hKey == INVALID_HANDLE_VALUE) {
+			continue;
+		}
+		DWORD type;
+		DWORD len = sizeof(buf) - sizeof(TCHAR);
+		LSTATUS status = RegQueryValueEx(hKey, _T("PortName"), nullptr, &type, reinterpret_cast<LPBYTE>(buf), &len);
+		RegCloseKey(hKey);
+		if ((status != ERROR_SUCCESS) || (type != REG_SZ)) {
+			// Parallel port (LPT) does not have PortName.
+			continue;
+		}
+		buf[len / sizeof(TCHAR)] = 0;
+		info.port = buf;
+
+		if (SetupDiGetDeviceInstanceId(hDevInfo, &devinfo, buf, MAX_PATH, nullptr)) {
+			info.instance_id = buf;
+			SimpleCom::DeviceIndex::ParseInstanceId(&info);
+		}
+		if (SetupDiGetDeviceRegistryProperty(hDevInfo, &devinfo, SPDRP_FRIENDLYNAME, nullptr, reinterpret_cast<PBYTE>(buf), sizeof(buf), nullptr)) {
+			info.description = buf;
+		}
+
+		result.push_back(info);
+	}
+
+	SetupDiDestroyDeviceInfoList(hDevInfo);
+	return result;
+}
+
+std::vector<TString> SimpleCom::SerialDeviceScanner::MergeDevices(TDeviceMap& devices, const TDeviceMap& latest) {
+	std::vector<TString> arrived;
+
+	std::erase_if(devices, [&latest](const auto& device) { return !latest.contains(device.first); });
+	for (auto& [device, iface] : latest) {
+		auto [itr, inserted] = devices.insert_or_assign(device, iface);
+		if (inserted) {
+			arrived.push_back(device);
+		}
+	}
+
+	return arrived;
+}
+
+std::vector<TString> SimpleCom::SerialDeviceScanner::ScanSerialDevices() {
+	TDeviceMap latest = _source->ListPorts();
+	if (latest.empty()) {
+		_devices.clear();
+		_index.Sync(_devices);
+		throw SerialDeviceScanException(_T("configuration"), _T("Serial interface not found"));
+	}
+
+	// Devices which are still available are kept as they are.
+	std::vector<TString> arrived = MergeDevices(_devices, latest);
+
+	// SetupAPI is slow if a lot of ports exist, so metadata would be queried only if the index is outdated.
+	if (_index.Sync(_devices)) {
+		std::vector<TDeviceInfo> metadata;
+		try {
+			metadata = _source->QueryMetadata();
+		}
+		catch (WinAPIException& e) {
+			// Ports can be used without metadata.
+			debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+		}
+
+		for (auto& info : metadata) {
+			auto itr = _devices.find(info.port);
+			if ((itr != _devices.end()) && (_index.FindByPort(info.port) == nullptr)) {
+				info.iface = itr->second;
+				_index.Put(info);
+			}
+		}
+
+		// Ports which are not found via SetupAPI (e.g. some of virtual ports) are indexed without metadata.
+		for (auto& [port, iface] : _devices) {
+			if (_index.FindByPort(port) == nullptr) {
+				_index.Put({ .port = port, .iface = iface });
+			}
+		}
+	}
+
+	return arrived;
+}
+
+void SimpleCom::SerialDeviceScanner::RefreshIfChanged() {
+	if (!_source->HasChanged()) {
+		return;
+	}
+
+	try {
+		ScanSerialDevices();
+	}
+	catch (SerialDeviceScanException&) {
+		// No device is available at this moment.
+	}
+	catch (WinAPIException& e) {
+		debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+	}
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, Yasumasa Suenaga
+ * Copyright (C) 2023, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -18,10 +18,49 @@
  */
 #pragma once
 
+#include "stdafx.h"
+#include "DeviceIndex.h"
+
 
 namespace SimpleCom {
 
-	typedef std::map<TString, TString> TDeviceMap;
+	/*
+	 * Source of serial devices for SerialDeviceScanner.
+	 * Devices are collected from the registry and SetupAPI by default, and tests can provide fixtures instead of them.
+	 */
+	class DeviceSource
+	{
+	public:
+		virtual ~DeviceSource() {};
+
+		// Map of port name and interface name of present devices.
+		virtual TDeviceMap ListPorts() = 0;
+
+		// Metadata (VID, PID, serial number, etc) of present devices. This might be slow.
+		virtual std::vector<TDeviceInfo> QueryMetadata() = 0;
+
+		// Returns true if devices might be changed since the previous ListPorts() call.
+		virtual bool HasChanged() = 0;
+	};
+
+	/*
+	 * Devices in HKLM\HARDWARE\DEVICEMAP\SERIALCOMM, and metadata via SetupAPI.
+	 */
+	class RegistryDeviceSource : public DeviceSource
+	{
+	private:
+		HKEY   _hNotifyKey;
+		HANDLE _hNotifyEvent;
+		bool   _notifiable;
+
+	public:
+		RegistryDeviceSource();
+		virtual ~RegistryDeviceSource();
+
+		virtual TDeviceMap ListPorts() override;
+		virtual std::vector<TDeviceInfo> QueryMetadata() override;
+		virtual bool HasChanged() override;
+	};
 
 	class SerialDeviceScanner
 	{
@@ -29,14 +68,26 @@ namespace SimpleCom {
 		HANDLE        _device_scan_event;
 		volatile HWND _dialog_hwnd;
 		TDeviceMap    _devices;
+		DeviceIndex   _index;
 		TString       _target_port;
+		std::unique_ptr<DeviceSource> _source;
 
 	public:
 		SerialDeviceScanner();
+		SerialDeviceScanner(std::unique_ptr<DeviceSource> source);
 		virtual ~SerialDeviceScanner();
 
 		void WaitSerialDevices(const HWND parent_hwnd, const int period);
-		void ScanSerialDevices();
+
+		// Update the device map with the registry. Returns devices which are arrived since the previous scan.
+		// Metadata of arrived devices would be updated in the device index.
+		std::vector<TString> ScanSerialDevices();
+
+		// Scan devices only if they might be changed, so this can be called before each attempt of reconnection.
+		void RefreshIfChanged();
+
+		// Apply the difference from latest to devices. Returns devices which are not in devices before.
+		static std::vector<TString> MergeDevices(TDeviceMap& devices, const TDeviceMap& latest);
 
 		inline HANDLE GetDeviceScanEvent() {
 			return _device_scan_event;
@@ -54,6 +105,16 @@ namespace SimpleCom {
 			return _devices;
 		}
 
+		inline const DeviceIndex& GetDeviceIndex() {
+			return _index;
+		}
+
+		// Port name of the port selector. Returns empty string if it is not available.
+		inline TString ResolvePort(const TString& selector) {
+			return _index.Resolve(selector);
+		}
+
+		// port can be a port selector (e.g. serial:[serial number], usb:[VID]:[PID]:[serial number])
 		inline void SetTargetPort(TString& port) {
 			_target_port = port;
 		}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "SerialHandle.h"
+#include "debug.h"
+
+
+SimpleCom::SerialHandle::SerialHandle(HANDLE handle, bool owned) :
+	_handle(handle),
+	_owned(owned),
+	_attached_at(0),
+	_awaiting_rx(false),
+	_reconnect_latency_us(0),
+	_reconnects(0),
+	_first_rx_latency(),
+	_stats(nullptr)
+{
+	InitializeSRWLock(&_lock);
+	InitializeSRWLock(&_write_lock);
+	QueryPerformanceFrequency(&_freq);
+}
+
+SimpleCom::SerialHandle::~SerialHandle() {
+	if (_owned && (_handle != INVALID_HANDLE_VALUE)) {
+		CloseHandle(_handle);
+	}
+}
+
+HANDLE SimpleCom::SerialHandle::Get() {
+	AcquireSRWLockShared(&_lock);
+	HANDLE handle = _handle;
+	ReleaseSRWLockShared(&_lock);
+	return handle;
+}
+
+BOOL SimpleCom::SerialHandle::Write(LPCVOID data, DWORD len, LPOVERLAPPED overlapped) {
+	// Hold the lock while WriteFile() is issued because Detach() might close the handle.
+	// Overlapped I/O returns immediately, so the reader would not be blocked for long.
+	AcquireSRWLockShared(&_write_lock);
+	AcquireSRWLockShared(&_lock);
+	BOOL result;
+	if (_handle == INVALID_HANDLE_VALUE) {
+		result = FALSE;
+		SetLastError(ERROR_DEVICE_REMOVED);
+	}
+	else {
+		result = WriteFile(_handle, data, len, nullptr, overlapped);
+	}
+	DWORD last_error = GetLastError();
+	ReleaseSRWLockShared(&_lock);
+	ReleaseSRWLockShared(&_write_lock);
+
+	if ((_stats != nullptr) && (result || (last_error == ERROR_IO_PENDING))) {
+		_stats->RecordWrite(len);
+	}
+
+	SetLastError(last_error);
+	return result;
+}
+
+BOOL SimpleCom::SerialHandle::Escape(DWORD func) {
+	AcquireSRWLockShared(&_write_lock);
+	AcquireSRWLockShared(&_lock);
+	BOOL result;
+	if (_handle == INVALID_HANDLE_VALUE) {
+		result = FALSE;
+		SetLastError(ERROR_DEVICE_REMOVED);
+	}
+	else {
+		result = EscapeCommFunction(_handle, func);
+	}
+	DWORD last_error = GetLastError();
+	ReleaseSRWLockShared(&_lock);
+	ReleaseSRWLockShared(&_write_lock);
+
+	SetLastError(last_error);
+	return result;
+}
+
+/*
+ * Wait until the TX queue in the driver and FIFO in the UART are empty.
+ * Pending overlapped writes are counted in cbOutQue as well.
+ */
+static BOOL DrainTx(HANDLE handle) {
+	DCB current = { .DCBlength = sizeof(DCB) };
+	if (!GetCommState(handle, &current)) {
+		return FALSE;
+	}
+
+	ULONGLONG deadline = GetTickCount64() + reconfig_drain_timeout_ms;
+	while (true) {
+		DWORD errors;
+		COMSTAT comstat;
+		if (!ClearCommError(handle, &errors, &comstat)) {
+			return FALSE;
+		}
+		if (comstat.cbOutQue == 0) {
+			break;
+		}
+		if (GetTickCount64() >= deadline) {
+			SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("{} bytes in TX queue would be sent with new configuration"), comstat.cbOutQue);
+			return TRUE;
+		}
+		Sleep(1);
+	}
+
+	// Each byte has 10 bits at least (start, 8 data bits, and stop).
+	Sleep((uart_fifo_sz * 10 * 1000) / max(current.BaudRate, static_cast<DWORD>(1)) + 1);
+	return TRUE;
+}
+
+BOOL SimpleCom::SerialHandle::Reconfigure(const DCB& dcb) {
+	// Exclusive lock for writers waits for WriteFile() in progress, and blocks new ones until the port is reconfigured.
+	AcquireSRWLockExclusive(&_write_lock);
+
+	// Shared lock keeps the handle open (Detach() needs exclusive one), and does not block the reader in Get() while draining.
+	AcquireSRWLockShared(&_lock);
+	BOOL result = (_handle == INVALID_HANDLE_VALUE) ? TRUE : DrainTx(_handle);
+	ReleaseSRWLockShared(&_lock);
+
+	if (result) {
+		AcquireSRWLockExclusive(&_lock);
+		if (_handle == INVALID_HANDLE_VALUE) {
+			result = FALSE;
+			SetLastError(ERROR_DEVICE_REMOVED);
+		}
+		else {
+			DCB new_dcb = dcb;
+			result = SetCommState(_handle, &new_dcb);
+		}
+		ReleaseSRWLockExclusive(&_lock);
+	}
+	DWORD last_error = GetLastError();
+	ReleaseSRWLockExclusive(&_write_lock);
+
+	SetLastError(last_error);
+	return result;
+}
+
+void SimpleCom::SerialHandle::CancelIo() {
+	AcquireSRWLockShared(&_lock);
+	if (_handle != INVALID_HANDLE_VALUE) {
+		CancelIoEx(_handle, nullptr);
+	}
+	ReleaseSRWLockShared(&_lock);
+}
+
+void SimpleCom::SerialHandle::Detach() {
+	AcquireSRWLockExclusive(&_lock);
+	if (_handle != INVALID_HANDLE_VALUE) {
+		CancelIoEx(_handle, nullptr);
+		if (_owned) {
+			CloseHandle(_handle);
+		}
+		_handle = INVALID_HANDLE_VALUE;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+}
+
+void SimpleCom::SerialHandle::Attach(HANDLE handle) {
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+
+	AcquireSRWLockExclusive(&_lock);
+	_handle = handle;
+	_attached_at = now.QuadPart;
+	ReleaseSRWLockExclusive(&_lock);
+
+	_reconnects.fetch_add(1, std::memory_order_release);
+	_awaiting_rx.store(true, std::memory_order_release);
+}
+
+void SimpleCom::SerialHandle::NotifyReceived() {
+	if (!_awaiting_rx.load(std::memory_order_relaxed) || !_awaiting_rx.exchange(false, std::memory_order_acq_rel)) {
+		return;
+	}
+
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	ULONGLONG latency_us = static_cast<ULONGLONG>((now.QuadPart - _attached_at) * 1000000 / _freq.QuadPart);
+	_reconnect_latency_us.store(latency_us, std::memory_order_release);
+	_first_rx_latency.Record(latency_us);
+
+	debug::log(LogLevel::INFO, _T("Reconnected: first data arrived in {} us"), latency_us);
+}
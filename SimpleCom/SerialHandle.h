@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "LatencyHistogram.h"
+#include "SessionStats.h"
+
+// TX queue would be drained up to this period before the port is reconfigured. Flow control might stop it forever.
+static constexpr DWORD reconfig_drain_timeout_ms = 1000;
+
+// Size of FIFO in the UART. Bytes in it might be still being sent when the driver queue is empty.
+static constexpr DWORD uart_fifo_sz = 16;
+
+namespace SimpleCom {
+
+	/*
+	 * Following error codes would be reported when serial controller is detached.
+	 * https://github.com/microsoft/referencesource/blob/51cf7850defa8a17d815b4700b67116e3fa283c2/System/sys/system/IO/ports/SerialStream.cs#L1739-L1748
+	 */
+	inline bool IsDeviceDetachedError(DWORD error) {
+		return (error == ERROR_ACCESS_DENIED) || (error == ERROR_BAD_COMMAND) || (error == ERROR_DEVICE_REMOVED);
+	}
+
+	/*
+	 * Handle of serial port which can be swapped on reconnection.
+	 * Threads in the session resolve the handle via this class for each I/O, so they can keep running across reconnection.
+	 * Only the reader thread should call Detach() / Attach() because it waits on the handle without the lock.
+	 */
+	class SerialHandle
+	{
+	private:
+		SRWLOCK _lock;
+		SRWLOCK _write_lock;  // Reconfigure() blocks writers only, so the reader can keep receiving while TX is drained.
+		HANDLE _handle;
+		bool _owned;
+		LARGE_INTEGER _freq;
+		LONGLONG _attached_at;
+		std::atomic<bool> _awaiting_rx;
+		std::atomic<ULONGLONG> _reconnect_latency_us;
+		std::atomic<DWORD> _reconnects;
+		LatencyHistogram _first_rx_latency;
+		SessionStats* _stats;
+
+	public:
+		// The handle would be closed by this class if owned is true.
+		SerialHandle(HANDLE handle, bool owned);
+		explicit SerialHandle(HANDLE handle) : SerialHandle(handle, false) {};
+		virtual ~SerialHandle();
+
+		// Returns INVALID_HANDLE_VALUE while the device is detached.
+		HANDLE Get();
+
+		// WriteFile() with current handle. It would fail with ERROR_DEVICE_REMOVED while the device is detached.
+		BOOL Write(LPCVOID data, DWORD len, LPOVERLAPPED overlapped);
+
+		// EscapeCommFunction() with current handle. It would fail with ERROR_DEVICE_REMOVED while the device is detached.
+		BOOL Escape(DWORD func);
+
+		/*
+		 * SetCommState() with current handle after sent data is drained.
+		 * Write() and Escape() from other threads are blocked while reconfiguring, so data which is written before this call is sent with old configuration.
+		 * Get() is blocked only while SetCommState() is called, so the reader can receive data during draining. Received data in the driver is kept.
+		 */
+		BOOL Reconfigure(const DCB& dcb);
+
+		void CancelIo();
+
+		// Cancel all I/O and release current handle.
+		void Detach();
+
+		// Swap to the handle of re-arrived device. Time to the first received data would be measured from here.
+		void Attach(HANDLE handle);
+
+		// Bytes which are written via this handle would be counted as TX. This should be called before starting I/O.
+		inline void SetStats(SessionStats* stats) {
+			_stats = stats;
+		}
+
+		// Reader thread should call this when it receives data.
+		void NotifyReceived();
+
+		inline ULONGLONG GetLastReconnectLatencyUs() const {
+			return _reconnect_latency_us.load(std::memory_order_acquire);
+		}
+
+		inline DWORD GetReconnectCount() const {
+			return _reconnects.load(std::memory_order_acquire);
+		}
+
+		// Latencies in microseconds. This should be read after the reader thread is finished.
+		inline const LatencyHistogram& first_rx_latency() const {
+			return _first_rx_latency;
+		}
+	};
+
+}
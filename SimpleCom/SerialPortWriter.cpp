@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021, 2024, Yasumasa Suenaga
+ * Copyright (C) 2021, 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -20,10 +20,24 @@
 
 #include "SerialPortWriter.h"
 #include "WinAPIException.h"
+#include "SerialHandle.h"
+#include "Trace.h"
 
-SimpleCom::SerialPortWriter::SerialPortWriter(const HANDLE handle, DWORD buf_sz)
+SimpleCom::SerialPortWriter::SerialPortWriter(const HANDLE handle, DWORD buf_sz) : _own_handle(std::make_unique<SerialHandle>(handle))
+{
+	// The handle would not be swapped, so this writer owns the wrapper.
+	_serial = _own_handle.get();
+	Init(buf_sz);
+}
+
+SimpleCom::SerialPortWriter::SerialPortWriter(SerialHandle& serial, DWORD buf_sz) : _own_handle()
+{
+	_serial = &serial;
+	Init(buf_sz);
+}
+
+void SimpleCom::SerialPortWriter::Init(DWORD buf_sz)
 {
-	_handle = handle;
 	_overlapped = { 0 };
 
 	_overlapped.hEvent = CreateEvent(NULL, TRUE, TRUE, NULL);
@@ -35,6 +49,7 @@ SimpleCom::SerialPortWriter::SerialPortWriter(const HANDLE handle, DWORD buf_sz)
 	_buf = new char[buf_sz];
 	_buf_idx = 0;
 	_shutdown = false;
+	_recorder = nullptr;
 }
 
 SimpleCom::SerialPortWriter::~SerialPortWriter()
@@ -54,17 +69,26 @@ void SimpleCom::SerialPortWriter::WriteAsync()
 		return;
 	}
 
+	TRACE_SCOPE("SerialPortWriter::WriteAsync");
+
 	// Wait if async writing is performing...
 	WaitForSingleObject(_overlapped.hEvent, INFINITE);
 
 	ResetEvent(_overlapped.hEvent);
-	BOOL result = WriteFile(_handle, _buf, _buf_idx, nullptr, &_overlapped);
+	BOOL result = _serial->Write(_buf, _buf_idx, &_overlapped);
 	DWORD last_error = GetLastError();
 
 	if (!result && (last_error != ERROR_IO_PENDING)) {
+		// No I/O is in flight, so the event should be signaled for next writing.
+		// Buffered data would be discarded because the device might be detached.
+		SetEvent(_overlapped.hEvent);
+		_buf_idx = 0;
 		throw SerialAPIException(last_error);
 	}
 
+	if (_recorder != nullptr) {
+		_recorder->Record(RecordType::TX, _buf, _buf_idx);
+	}
 	_buf_idx = 0;
 }
 
@@ -84,11 +108,19 @@ void SimpleCom::SerialPortWriter::Put(const char c) {
 void SimpleCom::SerialPortWriter::PutData(const char *data, const int len) {
 	WriteAsync();
 
+	// Wait if async writing is performing because OVERLAPPED cannot be shared with another I/O.
+	WaitForSingleObject(_overlapped.hEvent, INFINITE);
+
 	ResetEvent(_overlapped.hEvent);
-	BOOL result = WriteFile(_handle, data, len, nullptr, &_overlapped);
+	BOOL result = _serial->Write(data, len, &_overlapped);
 	DWORD last_error = GetLastError();
 
 	if (!result && (last_error != ERROR_IO_PENDING)) {
+		SetEvent(_overlapped.hEvent);
 		throw SerialAPIException(last_error);
 	}
+
+	if (_recorder != nullptr) {
+		_recorder->Record(RecordType::TX, data, len);
+	}
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021, 2022, Yasumasa Suenaga
+ * Copyright (C) 2021, 2022, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -19,6 +19,8 @@
 #pragma once
 
 #include "stdafx.h"
+#include "SessionRecord.h"
+#include "SerialHandle.h"
 
 namespace SimpleCom {
 
@@ -29,15 +31,22 @@ namespace SimpleCom {
 	class SerialPortWriter
 	{
 	private:
-		HANDLE _handle;
+		std::unique_ptr<SerialHandle> _own_handle;
+		SerialHandle* _serial;
 		OVERLAPPED _overlapped;
 		DWORD _buf_sz;
 		char* _buf;
 		DWORD _buf_idx;
 		bool _shutdown;
+		SessionRecorder* _recorder;
+
+		void Init(DWORD buf_sz);
 
 	public:
 		SerialPortWriter(const HANDLE handle, DWORD buf_sz);
+
+		// Writer would follow the handle swapped on reconnection.
+		SerialPortWriter(SerialHandle& serial, DWORD buf_sz);
 		virtual ~SerialPortWriter();
 
 		void Put(const char c);
@@ -47,6 +56,11 @@ namespace SimpleCom {
 		inline void Shutdown() {
 			_shutdown = true;
 		}
+
+		// Written data would be recorded as TX if recorder is not nullptr.
+		inline void SetRecorder(SessionRecorder* recorder) {
+			_recorder = recorder;
+		}
 	};
 
 }
\ No newline at end of file
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019, 2025, Yasumasa Suenaga
+ * Copyright (C) 2019, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,6 +21,7 @@
 #include "SerialSetup.h"
 #include "util.h"
 #include "WinAPIException.h"
+#include "LineConfig.h"
 #include "resource.h"
 
 
@@ -74,6 +75,16 @@ void SimpleCom::CommandlineOption<SimpleCom::FlowControl>::set_from_arg(LPCTSTR
 	throw std::invalid_argument("FlowControl: unknown argument");
 }
 
+void SimpleCom::CommandlineOption<SimpleCom::LogLevel>::set_from_arg(LPCTSTR arg) {
+	for (auto& value : LogLevel::values) {
+		if (_tcscmp(value.tstr(), arg) == 0) {
+			_value = value;
+			return;
+		}
+	}
+	throw std::invalid_argument("LogLevel: unknown argument");
+}
+
 void SimpleCom::CommandlineOption<LPTSTR>::set_from_arg(LPCTSTR arg) {
 	set(const_cast<LPTSTR>(arg));
 }
@@ -140,16 +151,31 @@ SimpleCom::SerialSetup::SerialSetup() :
 	_options[_T("--parity")] = new CommandlineOption<Parity>(Parity::valueopts(), _T("Parity"), Parity::NO_PARITY);
 	_options[_T("--stop-bits")] = new CommandlineOption<StopBits>(StopBits::valueopts(), _T("Stop bits"), StopBits::ONE);
 	_options[_T("--flow-control")] = new CommandlineOption<FlowControl>(FlowControl::valueopts(), _T("Flow control"), FlowControl::NONE);
+	_options[_T("--auto-baud")] = new CommandlineOption<bool>(_T(""), _T("Detect baud rate from received data"), false);
 	_options[_T("--utf8")] = new CommandlineOption<bool>(_T(""), _T("Use UTF-8 code page"), false);
 	_options[_T("--tty-resizer")] = new CommandlineOption<bool>(_T(""), _T("Use TTY Resizer"), false);
+	_options[_T("--resize-debounce")] = new CommandlineOption<int>(_T("[msec]"), _T("Quiet period before sending resize request to TTY Resizer"), 100);
 	_options[_T("--show-dialog")] = new CommandlineOption<bool>(_T(""), _T("Show setup dialog"), false);
 	_options[_T("--wait-serial-device")] = new CommandlineOption<int>(_T("[num]"), _T("Seconds to wait for serial device"), 0);
 	_options[_T("--auto-reconnect")] = new CommandlineOption<bool>(_T(""), _T("Reconnect to peripheral automatically"), false);
 	_options[_T("--auto-reconnect-pause")] = new CommandlineOption<int>(_T("[num]"), _T("Pause time in seconds before reconnecting"), 3);
 	_options[_T("--auto-reconnect-timeout")] = new CommandlineOption<int>(_T("[num]"), _T("Reconnect timeout"), 120);
+	_options[_T("--show-line-errors")] = new CommandlineOption<bool>(_T(""), _T("Show line errors (overrun, framing, parity) on the console"), false);
 	_options[_T("--log-file")] = new CommandlineOption<LPTSTR>(_T("[logfile]"), _T("Log serial communication to file"), nullptr);
 	_options[_T("--stdin-logging")] = new CommandlineOption<bool>(_T(""), _T("Enable stdin logging"), false);
 	_options[_T("--batch")] = new CommandlineOption<bool>(_T(""), _T("Perform in batch mode"), false);
+	_options[_T("--script")] = new CommandlineOption<LPTSTR>(_T("[script file]"), _T("Run script for automated interaction"), nullptr);
+	_options[_T("--trigger-file")] = new CommandlineOption<LPTSTR>(_T("[trigger file]"), _T("Run actions when patterns are received"), nullptr);
+	_options[_T("--record")] = new CommandlineOption<LPTSTR>(_T("[record file]"), _T("Record received and sent data with timing"), nullptr);
+	_options[_T("--replay")] = new CommandlineOption<LPTSTR>(_T("[record file]"), _T("Replay received data in the record file instead of connecting to serial port"), nullptr);
+	_options[_T("--stats-file")] = new CommandlineOption<LPTSTR>(_T("[stats file]"), _T("Write statistics of the session to the file"), nullptr);
+	_options[_T("--trace-file")] = new CommandlineOption<LPTSTR>(_T("[trace file]"), _T("Write trace of I/O in Chrome trace format on exit or F3"), nullptr);
+	_options[_T("--replay-speed")] = new CommandlineOption<int>(_T("[num]"), _T("Speed of replay (0: as fast as possible)"), 1);
+#ifdef _DEBUG
+	_options[_T("--log-level")] = new CommandlineOption<LogLevel>(LogLevel::valueopts(), _T("Level of diagnostic messages to stderr"), LogLevel::DBG);
+#else
+	_options[_T("--log-level")] = new CommandlineOption<LogLevel>(LogLevel::valueopts(), _T("Level of diagnostic messages to stderr"), LogLevel::NONE);
+#endif
 	_options[_T("--disable-efficiency-mode")] = new CommandlineOption<bool>(_T(""), _T("Disable efficiency mode"), false);
 	_options[_T("--help")] = new CommandlineHelpOption(&_options);
 }
@@ -194,15 +220,27 @@ static void InitializeDialog(HWND hDlg, SimpleCom::SerialSetup *setup) {
 	}
 	cb_idx = 0;
 	auto& devices = setup->GetDeviceScanner().GetDevices();
+	const auto& index = setup->GetDeviceScanner().GetDeviceIndex();
+	const TString target_port = setup->GetDeviceScanner().ResolvePort(setup->GetPort());
+
+	// Suppress redrawing while items are added because it is slow if a lot of ports exist.
+	SendMessage(hComboSerialDevice, CB_INITSTORAGE, devices.size(), devices.size() * MAX_PATH * sizeof(TCHAR));
+	SendMessage(hComboSerialDevice, WM_SETREDRAW, FALSE, 0);
+	WPARAM idx = 0;
 	for (auto& itr : devices) {
-		const TString port = itr.first;
+		const TString& port = itr.first;
 		text_str = port + _T(": ") + itr.second;
+		const SimpleCom::TDeviceInfo* info = index.FindByPort(port);
+		if ((info != nullptr) && !info->serial.empty()) {
+			text_str += _T(" (") + info->serial + _T(")");
+		}
 		AddStringToComboBox(hComboSerialDevice, text_str);
-		if (port == setup->GetPort()) {
-			auto target_itr = devices.find(itr.first);
-			cb_idx = std::distance(devices.begin(), target_itr);
+		if (port == target_port) {
+			cb_idx = idx;
 		}
+		idx++;
 	}
+	SendMessage(hComboSerialDevice, WM_SETREDRAW, TRUE, 0);
 	SendMessage(hComboSerialDevice, CB_SETCURSEL, cb_idx, 0);
 
 	text_str = TO_STRING(setup->GetBaudRate());
@@ -517,7 +555,7 @@ void SimpleCom::SerialSetup::ParseArguments(int argc, LPCTSTR argv[]) {
 			}
 		}
 		else {
-			TRegex re(_T("^COM\\d+$"));
+			TRegex re(_T("^(COM\\d+|serial:.+|usb:[0-9A-Fa-f]{4}:[0-9A-Fa-f]{4}:.+)$"));
 			if (std::regex_match(argv[i], re)) {
 				SetPort(argv[i]);
 			}
@@ -531,6 +569,26 @@ void SimpleCom::SerialSetup::ParseArguments(int argc, LPCTSTR argv[]) {
 }
 
 void SimpleCom::SerialSetup::Validate() {
+	if (IsReplayMode()) {
+		// Replay does not need serial port.
+		if (IsShowDialog() || IsBatchMode() || GetAutoReconnect() || (GetWaitDevicePeriod() > 0) || IsShowLineErrors() || IsAutoBaud()) {
+			throw std::invalid_argument("Replay cannot be configured with serial port options");
+		}
+		if (GetScriptFile() != nullptr) {
+			throw std::invalid_argument("Script cannot be configured with replay");
+		}
+		if (GetRecordFile() != nullptr) {
+			throw std::invalid_argument("Record cannot be configured with replay");
+		}
+		if (GetStatsFile() != nullptr) {
+			throw std::invalid_argument("Statistics cannot be configured with replay");
+		}
+		if (GetReplaySpeed() < 0) {
+			throw std::invalid_argument("Replay speed should be 0 or more");
+		}
+		return;
+	}
+
 	if (!IsShowDialog() && _port.empty()) {
 		throw std::invalid_argument("Serial port is not specified");
 	}
@@ -539,6 +597,10 @@ void SimpleCom::SerialSetup::Validate() {
 		throw std::invalid_argument("Log file should be configured when stdin logging is enabled");
 	}
 
+	if (GetResizeDebounce() < 0) {
+		throw std::invalid_argument("Resize debounce should be 0 or more");
+	}
+
 	if (IsBatchMode()) {
 		if (_port.empty()) {
 			throw std::invalid_argument("Serial port have to be set with batch mode");
@@ -555,6 +617,27 @@ void SimpleCom::SerialSetup::Validate() {
 		if(GetLogFile() != nullptr) {
 			throw std::invalid_argument("Logging cannot be configured with batch mode");
 		}
+		if (GetScriptFile() != nullptr) {
+			throw std::invalid_argument("Script cannot be configured with batch mode");
+		}
+		if (GetTriggerFile() != nullptr) {
+			throw std::invalid_argument("Triggers cannot be configured with batch mode");
+		}
+		if (GetRecordFile() != nullptr) {
+			throw std::invalid_argument("Record cannot be configured with batch mode");
+		}
+		if (GetStatsFile() != nullptr) {
+			throw std::invalid_argument("Statistics cannot be configured with batch mode");
+		}
+		if (IsShowLineErrors()) {
+			throw std::invalid_argument("Line errors cannot be shown in batch mode");
+		}
+		if (GetTraceFile() != nullptr) {
+			throw std::invalid_argument("Trace cannot be configured with batch mode");
+		}
+		if (IsAutoBaud()) {
+			throw std::invalid_argument("Auto-baud cannot be configured with batch mode");
+		}
 	}
 }
 
@@ -570,20 +653,7 @@ void SimpleCom::SerialSetup::SaveToDCB(LPDCB dcb) noexcept {
 	dcb->fParity = GetParity() != SimpleCom::Parity::NO_PARITY;
 	dcb->Parity = GetParity();
 	dcb->fDtrControl = DTR_CONTROL_ENABLE;
-	dcb->fRtsControl = RTS_CONTROL_ENABLE;
-
-	if (GetFlowControl() == SimpleCom::FlowControl::HARDWARE) {
-		dcb->fOutxCtsFlow = TRUE;
-		dcb->fRtsControl = RTS_CONTROL_HANDSHAKE;
-	}
-	else if (GetFlowControl() == SimpleCom::FlowControl::SOFTWARE) {
-		dcb->fOutX = TRUE;
-		dcb->fInX = TRUE;
-		dcb->XonLim = 2048;
-		dcb->XoffLim = 2048;
-		dcb->XonChar = 0x11;
-		dcb->XoffChar = 0x13;
-	}
+	SimpleCom::SetFlowControlToDCB(dcb, GetFlowControl());
 
 	dcb->ByteSize = GetByteSize();
 	dcb->StopBits = GetStopBits();
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019, 2025, Yasumasa Suenaga
+ * Copyright (C) 2019, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -135,6 +135,14 @@ namespace SimpleCom {
 			return static_cast<CommandlineOption<FlowControl>*>(_options[_T("--flow-control")])->get();
 		}
 
+		inline void SetLogLevel(LogLevel& log_level) {
+			static_cast<CommandlineOption<LogLevel>*>(_options[_T("--log-level")])->set(log_level);
+		}
+
+		inline LogLevel GetLogLevel() {
+			return static_cast<CommandlineOption<LogLevel>*>(_options[_T("--log-level")])->get();
+		}
+
 		inline void SetUseUTF8(bool enabled) {
 			static_cast<CommandlineOption<bool>*>(_options[_T("--utf8")])->set(enabled);
 		}
@@ -151,6 +159,14 @@ namespace SimpleCom {
 			return static_cast<CommandlineOption<bool>*>(_options[_T("--tty-resizer")])->get();
 		}
 
+		inline void SetResizeDebounce(int msec) {
+			static_cast<CommandlineOption<int>*>(_options[_T("--resize-debounce")])->set(msec);
+		}
+
+		inline int GetResizeDebounce() {
+			return static_cast<CommandlineOption<int>*>(_options[_T("--resize-debounce")])->get();
+		}
+
 		inline void SetShowDialog(bool value) {
 			static_cast<CommandlineOption<bool>*>(_options[_T("--show-dialog")])->set(value);
 		}
@@ -211,6 +227,83 @@ namespace SimpleCom {
 			return static_cast<CommandlineOption<bool>*>(_options[_T("--batch")])->get();
 		}
 
+		inline void SetScriptFile(LPTSTR script) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--script")])->set(script);
+		}
+
+		inline LPCTSTR GetScriptFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--script")])->get();
+		}
+
+		inline void SetTriggerFile(LPTSTR trigger_file) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--trigger-file")])->set(trigger_file);
+		}
+
+		inline LPCTSTR GetTriggerFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--trigger-file")])->get();
+		}
+
+		inline void SetRecordFile(LPTSTR record_file) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--record")])->set(record_file);
+		}
+
+		inline LPCTSTR GetRecordFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--record")])->get();
+		}
+
+		inline void SetShowLineErrors(bool enabled) {
+			static_cast<CommandlineOption<bool>*>(_options[_T("--show-line-errors")])->set(enabled);
+		}
+
+		inline bool IsShowLineErrors() {
+			return static_cast<CommandlineOption<bool>*>(_options[_T("--show-line-errors")])->get();
+		}
+
+		inline void SetAutoBaud(bool enabled) {
+			static_cast<CommandlineOption<bool>*>(_options[_T("--auto-baud")])->set(enabled);
+		}
+
+		inline bool IsAutoBaud() {
+			return static_cast<CommandlineOption<bool>*>(_options[_T("--auto-baud")])->get();
+		}
+
+		inline void SetStatsFile(LPTSTR stats_file) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--stats-file")])->set(stats_file);
+		}
+
+		inline LPCTSTR GetStatsFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--stats-file")])->get();
+		}
+
+		inline void SetTraceFile(LPTSTR trace_file) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--trace-file")])->set(trace_file);
+		}
+
+		inline LPCTSTR GetTraceFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--trace-file")])->get();
+		}
+
+		inline void SetReplayFile(LPTSTR replay_file) {
+			static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--replay")])->set(replay_file);
+		}
+
+		inline LPCTSTR GetReplayFile() {
+			return static_cast<CommandlineOption<LPTSTR>*>(_options[_T("--replay")])->get();
+		}
+
+		inline bool IsReplayMode() {
+			return GetReplayFile() != nullptr;
+		}
+
+		inline void SetReplaySpeed(int speed) {
+			static_cast<CommandlineOption<int>*>(_options[_T("--replay-speed")])->set(speed);
+		}
+
+		// 0 means the max speed.
+		inline int GetReplaySpeed() {
+			return static_cast<CommandlineOption<int>*>(_options[_T("--replay-speed")])->get();
+		}
+
 		inline void DisableEfficiencyMode(bool disable) {
 			static_cast<CommandlineOption<bool>*>(_options[_T("--disable-efficiency-mode")])->set(disable);
 		}
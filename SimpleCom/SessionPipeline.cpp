@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "SessionPipeline.h"
+#include "WinAPIException.h"
+
+
+std::coroutine_handle<> SimpleCom::PipelineTask::FinalAwaiter::await_suspend(THandle handle) noexcept {
+	promise_type& promise = handle.promise();
+	if (promise.hDoneEvent != NULL) {
+		// The coroutine is already suspended, so Wait() can destroy it after this.
+		SetEvent(promise.hDoneEvent);
+		return std::noop_coroutine();
+	}
+
+	// The awaiter would continue by itself if it is not suspended yet.
+	if (promise.continuation && promise.awaiter_suspended.exchange(true)) {
+		return promise.continuation;
+	}
+	return std::noop_coroutine();
+}
+
+SimpleCom::PipelineTask::~PipelineTask() {
+	if (_handle) {
+		_handle.destroy();
+	}
+}
+
+bool SimpleCom::PipelineTask::await_suspend(std::coroutine_handle<> awaiter) {
+	promise_type& promise = _handle.promise();
+	promise.continuation = awaiter;
+	_handle.resume();
+
+	// Do not suspend if the task has been finished in resume(), otherwise the stack would grow on each chunk.
+	return !promise.awaiter_suspended.exchange(true);
+}
+
+void SimpleCom::PipelineTask::await_resume() {
+	if (_handle && _handle.promise().exception) {
+		std::rethrow_exception(_handle.promise().exception);
+	}
+}
+
+void SimpleCom::PipelineTask::RunUntilDone(HANDLE hDoneEvent) {
+	ResetEvent(hDoneEvent);
+	_handle.promise().hDoneEvent = hDoneEvent;
+	_handle.resume();
+	WaitForSingleObject(hDoneEvent, INFINITE);
+	_handle.promise().hDoneEvent = NULL;
+}
+
+void SimpleCom::PipelineTask::Wait() {
+	if (await_ready()) {
+		await_resume();
+		return;
+	}
+
+	HANDLE hDoneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (hDoneEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for PipelineTask"));
+	}
+	RunUntilDone(hDoneEvent);
+	CloseHandle(hDoneEvent);
+	await_resume();
+}
+
+void SimpleCom::PipelineTask::Wait(HANDLE hDoneEvent) {
+	if (!await_ready()) {
+		RunUntilDone(hDoneEvent);
+	}
+	await_resume();
+}
+
+bool SimpleCom::IOAwaiter::await_suspend(std::coroutine_handle<> handle) {
+	_handle = handle;
+	_start([this](DWORD error, DWORD transferred) {
+		_error = error;
+		_transferred = transferred;
+		// The coroutine would not be resumed here if the operation is completed before await_suspend() returns.
+		if (_completed.exchange(true)) {
+			_handle.resume();
+		}
+	});
+	return !_completed.exchange(true);
+}
+
+DWORD SimpleCom::IOAwaiter::await_resume() {
+	if (_error != ERROR_SUCCESS) {
+		throw WinAPIException(_error, _error_caption);
+	}
+	return _transferred;
+}
+
+SimpleCom::IOAwaiter SimpleCom::ReadAsync(AsyncStream& stream, char* buf, DWORD len) {
+	return IOAwaiter([&stream, buf, len](AsyncStream::TCompletion completion) { stream.BeginRead(buf, len, completion); }, _T("Read in pipeline"));
+}
+
+SimpleCom::IOAwaiter SimpleCom::WriteAsync(AsyncStream& stream, const char* data, DWORD len) {
+	return IOAwaiter([&stream, data, len](AsyncStream::TCompletion completion) { stream.BeginWrite(data, len, completion); }, _T("Write in pipeline"));
+}
+
+SimpleCom::OverlappedStream::OverlappedStream(HANDLE handle) :
+	_handle(handle),
+	_read_overlapped({ 0 }),
+	_write_overlapped({ 0 }),
+	_read_buf(nullptr),
+	_read_len(0),
+	_hReadWait(NULL),
+	_hWriteWait(NULL),
+	_read_completion(),
+	_write_completion()
+{
+	_read_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_read_overlapped.hEvent == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for OverlappedStream"));
+	}
+	_write_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_write_overlapped.hEvent == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_read_overlapped.hEvent);
+		throw WinAPIException(error, _T("CreateEvent for OverlappedStream"));
+	}
+}
+
+SimpleCom::OverlappedStream::~OverlappedStream() {
+	CloseHandle(_write_overlapped.hEvent);
+	CloseHandle(_read_overlapped.hEvent);
+}
+
+void SimpleCom::OverlappedStream::Complete(OVERLAPPED* overlapped, HANDLE* hWait, TCompletion& completion) {
+	// Wait handle of WT_EXECUTEONLYONCE should be unregistered even if it has been fired.
+	if (*hWait != NULL) {
+		UnregisterWait(*hWait);
+		*hWait = NULL;
+	}
+
+	DWORD transferred = 0;
+	DWORD error = GetOverlappedResult(_handle, overlapped, &transferred, FALSE) ? ERROR_SUCCESS : GetLastError();
+	if (error == ERROR_HANDLE_EOF) {
+		error = ERROR_SUCCESS;
+	}
+	else if ((overlapped == &_read_overlapped) && (error == ERROR_SUCCESS) && (transferred == 0)) {
+		// Serial device returns no data when ReadTotalTimeoutConstant is elapsed. It is not the end of the stream.
+		// The caller should set read timeouts which wait for the first byte (see SerialConnection::DoBatch()) not to poll the device.
+		StartRead();
+		return;
+	}
+
+	// completion might start next operation, so it should be moved out before the call.
+	TCompletion current = std::move(completion);
+	current(error, transferred);
+}
+
+void SimpleCom::OverlappedStream::Fail(TCompletion& completion, DWORD error) {
+	TCompletion current = std::move(completion);
+	current(error, 0);
+}
+
+VOID CALLBACK SimpleCom::OverlappedStream::ReadCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired) {
+	OverlappedStream* stream = reinterpret_cast<OverlappedStream*>(lpParameter);
+	stream->Complete(&stream->_read_overlapped, &stream->_hReadWait, stream->_read_completion);
+}
+
+VOID CALLBACK SimpleCom::OverlappedStream::WriteCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired) {
+	OverlappedStream* stream = reinterpret_cast<OverlappedStream*>(lpParameter);
+	stream->Complete(&stream->_write_overlapped, &stream->_hWriteWait, stream->_write_completion);
+}
+
+void SimpleCom::OverlappedStream::StartRead() {
+	ResetEvent(_read_overlapped.hEvent);
+	if (ReadFile(_handle, _read_buf, _read_len, NULL, &_read_overlapped)) {
+		Complete(&_read_overlapped, &_hReadWait, _read_completion);
+	}
+	else if (GetLastError() != ERROR_IO_PENDING) {
+		Fail(_read_completion, GetLastError());
+	}
+	else if (!RegisterWaitForSingleObject(&_hReadWait, _read_overlapped.hEvent, &ReadCallback, this, INFINITE, WT_EXECUTEONLYONCE | WT_EXECUTELONGFUNCTION)) {
+		DWORD error = GetLastError();
+		CancelIoEx(_handle, &_read_overlapped);
+		Fail(_read_completion, error);
+	}
+}
+
+void SimpleCom::OverlappedStream::BeginRead(char* buf, DWORD len, TCompletion completion) {
+	_read_buf = buf;
+	_read_len = len;
+	_read_completion = completion;
+	StartRead();
+}
+
+void SimpleCom::OverlappedStream::BeginWrite(const char* data, DWORD len, TCompletion completion) {
+	_write_completion = completion;
+	ResetEvent(_write_overlapped.hEvent);
+	if (WriteFile(_handle, data, len, NULL, &_write_overlapped)) {
+		Complete(&_write_overlapped, &_hWriteWait, _write_completion);
+	}
+	else if (GetLastError() != ERROR_IO_PENDING) {
+		Fail(_write_completion, GetLastError());
+	}
+	else if (!RegisterWaitForSingleObject(&_hWriteWait, _write_overlapped.hEvent, &WriteCallback, this, INFINITE, WT_EXECUTEONLYONCE | WT_EXECUTELONGFUNCTION)) {
+		DWORD error = GetLastError();
+		CancelIoEx(_handle, &_write_overlapped);
+		Fail(_write_completion, error);
+	}
+}
+
+void SimpleCom::BlockingStream::BeginRead(char* buf, DWORD len, TCompletion completion) {
+	DWORD nBytesRead = 0;
+	if (!ReadFile(_handle, buf, len, &nBytesRead, NULL)) {
+		DWORD error = GetLastError();
+		completion((error == ERROR_BROKEN_PIPE) ? ERROR_SUCCESS : error, 0);
+		return;
+	}
+	completion(ERROR_SUCCESS, nBytesRead);
+}
+
+void SimpleCom::BlockingStream::BeginWrite(const char* data, DWORD len, TCompletion completion) {
+	DWORD nBytesWritten = 0;
+	if (!WriteFile(_handle, data, len, &nBytesWritten, NULL)) {
+		completion(GetLastError(), 0);
+		return;
+	}
+	completion(ERROR_SUCCESS, nBytesWritten);
+}
+
+SimpleCom::PipelineTask SimpleCom::TapStage::Process(const char* data, DWORD len) {
+	_tap(data, len);
+	co_await Emit(data, len);
+}
+
+SimpleCom::PipelineTask SimpleCom::WriteStage::Process(const char* data, DWORD len) {
+	DWORD written = 0;
+	while (written < len) {
+		DWORD n = co_await WriteAsync(_dest, data + written, len - written);
+		if (n == 0) {
+			throw WinAPIException(_T("WriteStage"), _T("Nothing has been written"));
+		}
+		written += n;
+	}
+	co_await Emit(data, len);
+}
+
+void SimpleCom::SessionPipeline::AddStage(PipelineStage* stage) {
+	if (_tail == nullptr) {
+		_head = stage;
+	}
+	else {
+		_tail->SetNext(stage);
+	}
+	_tail = stage;
+}
+
+SimpleCom::PipelineTask SimpleCom::SessionPipeline::Run() {
+	std::unique_ptr<char[]> buf(new char[_buf_sz]);
+
+	while (true) {
+		DWORD n = co_await ReadAsync(_source, buf.get(), _buf_sz);
+		if (n == 0) {
+			break;
+		}
+		if (_head != nullptr) {
+			co_await _head->Process(buf.get(), n);
+		}
+	}
+}
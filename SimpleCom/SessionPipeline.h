@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+namespace SimpleCom {
+
+	/*
+	 * Coroutine for the session pipeline.
+	 * It starts when it is awaited, and resumes the awaiter when it finishes. Exception in the coroutine would be rethrown to the awaiter.
+	 * Wait() runs the coroutine from normal function, and blocks until it finishes.
+	 */
+	class PipelineTask
+	{
+	public:
+		struct promise_type;
+		typedef std::coroutine_handle<promise_type> THandle;
+
+		struct FinalAwaiter {
+			inline bool await_ready() noexcept {
+				return false;
+			}
+			std::coroutine_handle<> await_suspend(THandle handle) noexcept;
+			inline void await_resume() noexcept {};
+		};
+
+		struct promise_type {
+			std::coroutine_handle<> continuation;
+			std::atomic<bool> awaiter_suspended = false;
+			HANDLE hDoneEvent = NULL;
+			std::exception_ptr exception;
+
+			inline PipelineTask get_return_object() {
+				return PipelineTask(THandle::from_promise(*this));
+			}
+			inline std::suspend_always initial_suspend() noexcept {
+				return {};
+			}
+			inline FinalAwaiter final_suspend() noexcept {
+				return {};
+			}
+			inline void return_void() {};
+			inline void unhandled_exception() {
+				exception = std::current_exception();
+			}
+		};
+
+	private:
+		THandle _handle;
+
+		void RunUntilDone(HANDLE hDoneEvent);
+
+	public:
+		// Empty task. It finishes immediately when it is awaited.
+		PipelineTask() : _handle(nullptr) {};
+		explicit PipelineTask(THandle handle) : _handle(handle) {};
+		PipelineTask(PipelineTask&& other) noexcept : _handle(other._handle) {
+			other._handle = nullptr;
+		}
+		PipelineTask(const PipelineTask&) = delete;
+		PipelineTask& operator=(const PipelineTask&) = delete;
+		virtual ~PipelineTask();
+
+		inline bool await_ready() const noexcept {
+			return !_handle || _handle.done();
+		}
+		bool await_suspend(std::coroutine_handle<> awaiter);
+		void await_resume();
+
+		void Wait();
+
+		// Same as Wait(), but hDoneEvent (manual reset event) is used instead of new one. It is for the caller which waits tasks repeatedly.
+		void Wait(HANDLE hDoneEvent);
+	};
+
+	/*
+	 * Async I/O backend of the pipeline.
+	 * completion receives the error code (ERROR_SUCCESS if succeeded) and the number of bytes transferred.
+	 * It can be called on any thread, or in BeginRead() / BeginWrite() if the operation completes immediately.
+	 * Read of 0 byte means the end of the stream.
+	 */
+	class AsyncStream
+	{
+	public:
+		typedef std::function<void(DWORD, DWORD)> TCompletion;
+
+		virtual ~AsyncStream() {};
+
+		virtual void BeginRead(char* buf, DWORD len, TCompletion completion) = 0;
+		virtual void BeginWrite(const char* data, DWORD len, TCompletion completion) = 0;
+	};
+
+	/*
+	 * Awaiter for an operation of AsyncStream. It returns the number of bytes transferred.
+	 * WinAPIException would be thrown if the operation failed.
+	 */
+	class IOAwaiter
+	{
+	private:
+		std::function<void(AsyncStream::TCompletion)> _start;
+		LPCTSTR _error_caption;
+		std::coroutine_handle<> _handle;
+		std::atomic<bool> _completed;
+		DWORD _error;
+		DWORD _transferred;
+
+	public:
+		IOAwaiter(std::function<void(AsyncStream::TCompletion)> start, LPCTSTR error_caption) :
+			_start(start), _error_caption(error_caption), _handle(nullptr), _completed(false), _error(ERROR_SUCCESS), _transferred(0) {};
+
+		inline bool await_ready() const noexcept {
+			return false;
+		}
+		bool await_suspend(std::coroutine_handle<> handle);
+		DWORD await_resume();
+	};
+
+	IOAwaiter ReadAsync(AsyncStream& stream, char* buf, DWORD len);
+	IOAwaiter WriteAsync(AsyncStream& stream, const char* data, DWORD len);
+
+	/*
+	 * AsyncStream for the handle which is opened with FILE_FLAG_OVERLAPPED (e.g. serial device).
+	 * Completions would be called on the system thread pool, so pending I/O does not occupy any thread.
+	 * Completions resume the coroutine which might perform blocking I/O (e.g. stdout), so waits are registered with WT_EXECUTELONGFUNCTION.
+	 * Only one read and one write can be in flight at the same time.
+	 * Read of 0 byte is retried because the serial device returns it on timeout. ERROR_HANDLE_EOF is regarded as the end of the stream.
+	 */
+	class OverlappedStream : public AsyncStream
+	{
+	private:
+		HANDLE _handle;
+		OVERLAPPED _read_overlapped;
+		OVERLAPPED _write_overlapped;
+		char* _read_buf;
+		DWORD _read_len;
+		HANDLE _hReadWait;
+		HANDLE _hWriteWait;
+		TCompletion _read_completion;
+		TCompletion _write_completion;
+
+		static VOID CALLBACK ReadCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired);
+		static VOID CALLBACK WriteCallback(PVOID lpParameter, BOOLEAN TimerOrWaitFired);
+		void StartRead();
+		void Complete(OVERLAPPED* overlapped, HANDLE* hWait, TCompletion& completion);
+		void Fail(TCompletion& completion, DWORD error);
+
+	public:
+		OverlappedStream(HANDLE handle);
+		virtual ~OverlappedStream();
+
+		virtual void BeginRead(char* buf, DWORD len, TCompletion completion) override;
+		virtual void BeginWrite(const char* data, DWORD len, TCompletion completion) override;
+	};
+
+	/*
+	 * AsyncStream for the handle which does not support overlapped I/O (e.g. console, pipe, or file as stdin / stdout).
+	 * Operations complete in BeginRead() / BeginWrite(). Broken pipe is regarded as the end of the stream.
+	 */
+	class BlockingStream : public AsyncStream
+	{
+	private:
+		HANDLE _handle;
+
+	public:
+		BlockingStream(HANDLE handle) : _handle(handle) {};
+		virtual ~BlockingStream() {};
+
+		virtual void BeginRead(char* buf, DWORD len, TCompletion completion) override;
+		virtual void BeginWrite(const char* data, DWORD len, TCompletion completion) override;
+	};
+
+	/*
+	 * Stage of the session pipeline (filter or sink).
+	 * Process() receives data which is owned by the source. It should pass the data (or transformed one) to the next stage via Emit().
+	 * Stages run on the coroutine of the pipeline, so they do not need their own threads nor copies of the data.
+	 */
+	class PipelineStage
+	{
+	private:
+		PipelineStage* _next;
+
+	protected:
+		inline PipelineTask Emit(const char* data, DWORD len) {
+			return (_next == nullptr) ? PipelineTask() : _next->Process(data, len);
+		}
+
+	public:
+		PipelineStage() : _next(nullptr) {};
+		virtual ~PipelineStage() {};
+
+		inline void SetNext(PipelineStage* next) {
+			_next = next;
+		}
+
+		virtual PipelineTask Process(const char* data, DWORD len) = 0;
+	};
+
+	// Pass data to the function (e.g. log, recorder, counters), then to the next stage.
+	class TapStage : public PipelineStage
+	{
+	private:
+		std::function<void(const char*, DWORD)> _tap;
+
+	public:
+		TapStage(std::function<void(const char*, DWORD)> tap) : PipelineStage(), _tap(tap) {};
+		virtual ~TapStage() {};
+
+		virtual PipelineTask Process(const char* data, DWORD len) override;
+	};
+
+	// Write whole of data to the stream, then pass it to the next stage.
+	class WriteStage : public PipelineStage
+	{
+	private:
+		AsyncStream& _dest;
+
+	public:
+		WriteStage(AsyncStream& dest) : PipelineStage(), _dest(dest) {};
+		virtual ~WriteStage() {};
+
+		virtual PipelineTask Process(const char* data, DWORD len) override;
+	};
+
+	/*
+	 * Read the source until its end, and pass each chunk through stages in the order of AddStage().
+	 * The buffer for the source is the only buffer in the pipeline.
+	 */
+	class SessionPipeline
+	{
+	private:
+		AsyncStream& _source;
+		DWORD _buf_sz;
+		PipelineStage* _head;
+		PipelineStage* _tail;
+
+	public:
+		SessionPipeline(AsyncStream& source, DWORD buf_sz) : _source(source), _buf_sz(buf_sz), _head(nullptr), _tail(nullptr) {};
+		virtual ~SessionPipeline() {};
+
+		// Stages should be alive until Run() finishes. This should be called before Run().
+		void AddStage(PipelineStage* stage);
+
+		PipelineTask Run();
+	};
+
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "SessionRecord.h"
+#include "util.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+
+void SimpleCom::EncodeVarint(std::string& out, ULONGLONG value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+bool SimpleCom::DecodeVarint(const std::string& in, size_t* pos, ULONGLONG* value) {
+	ULONGLONG result = 0;
+
+	// 64 bit value can be encoded in 10 bytes at most.
+	for (int shift = 0; shift < 70; shift += 7) {
+		if (*pos >= in.length()) {
+			return false;
+		}
+
+		BYTE b = static_cast<BYTE>(in[(*pos)++]);
+		result |= static_cast<ULONGLONG>(b & 0x7f) << shift;
+		if ((b & 0x80) == 0) {
+			*value = result;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Entry point for flusher thread.
+ */
+static DWORD WINAPI SessionRecorderEntry(_In_ LPVOID lpParameter) {
+	SimpleCom::SessionRecorder* recorder = reinterpret_cast<SimpleCom::SessionRecorder*>(lpParameter);
+	recorder->Run();
+	return 0;
+}
+
+SimpleCom::SessionRecorder::SessionRecorder(LPCTSTR filename) :
+	_buf(),
+	_hThread(NULL),
+	_failed(false)
+{
+	InitializeSRWLock(&_lock);
+	QueryPerformanceFrequency(&_freq);
+
+	_hFile = CreateFile(filename, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_hFile == INVALID_HANDLE_VALUE) {
+		throw WinAPIException(GetLastError(), _T("CreateFile for session record"));
+	}
+
+	_hFlushEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_hFlushEvent == NULL || _hStopEvent == NULL) {
+		DWORD error = GetLastError();
+		if (_hFlushEvent != NULL) {
+			CloseHandle(_hFlushEvent);
+		}
+		CloseHandle(_hFile);
+		throw WinAPIException(error, _T("CreateEvent for SessionRecorder"));
+	}
+
+	FILETIME start_time;
+	GetSystemTimeAsFileTime(&start_time);
+	ULONGLONG start_time_value = (static_cast<ULONGLONG>(start_time.dwHighDateTime) << 32) | start_time.dwLowDateTime;
+
+	_buf.append(SESSION_RECORD_MAGIC, sizeof(SESSION_RECORD_MAGIC));
+	_buf.push_back(static_cast<char>(SESSION_RECORD_VERSION));
+	_buf.append(2, '\0');
+	for (int idx = 0; idx < 8; idx++) {
+		_buf.push_back(static_cast<char>((start_time_value >> (idx * 8)) & 0xff));
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	_last_counter = counter.QuadPart;
+
+	_hThread = CreateThread(NULL, 0, &SessionRecorderEntry, this, 0, NULL);
+	if (_hThread == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_hStopEvent);
+		CloseHandle(_hFlushEvent);
+		CloseHandle(_hFile);
+		throw WinAPIException(error, _T("CreateThread for SessionRecorder"));
+	}
+}
+
+SimpleCom::SessionRecorder::~SessionRecorder() {
+	SetEvent(_hStopEvent);
+	WaitForSingleObject(_hThread, INFINITE);
+	CloseHandle(_hThread);
+
+	// Records which are added after the last flush.
+	Flush();
+
+	CloseHandle(_hStopEvent);
+	CloseHandle(_hFlushEvent);
+	CloseHandle(_hFile);
+}
+
+void SimpleCom::SessionRecorder::Record(RecordType type, const char* data, const DWORD len) {
+	if (len == 0 || _failed.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+
+	bool should_flush;
+	AcquireSRWLockExclusive(&_lock);
+	{
+		// RX and TX threads record concurrently, so the counter might be older than the last record.
+		LONGLONG current = max(counter.QuadPart, _last_counter);
+		ULONGLONG delta_us = static_cast<ULONGLONG>(current - _last_counter) * 1000000ULL / _freq.QuadPart;
+		// Fraction of microseconds is carried over to the next record.
+		_last_counter += static_cast<LONGLONG>(delta_us * _freq.QuadPart / 1000000ULL);
+
+		_buf.push_back(static_cast<char>(type));
+		EncodeVarint(_buf, delta_us);
+		EncodeVarint(_buf, len);
+		_buf.append(data, len);
+		should_flush = _buf.length() >= session_record_flush_sz;
+	}
+	ReleaseSRWLockExclusive(&_lock);
+
+	if (should_flush) {
+		SetEvent(_hFlushEvent);
+	}
+}
+
+void SimpleCom::SessionRecorder::Flush() {
+	std::string data;
+
+	AcquireSRWLockExclusive(&_lock);
+	_buf.swap(data);
+	ReleaseSRWLockExclusive(&_lock);
+
+	if (data.empty() || _failed.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	DWORD nBytesWritten;
+	if (!WriteFile(_hFile, data.c_str(), static_cast<DWORD>(data.length()), &nBytesWritten, nullptr)) {
+		// Recording is best effort. Failure should not affect the session.
+		WinAPIException e(GetLastError(), _T("WriteFile for session record"));
+		debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+		_failed.store(true, std::memory_order_relaxed);
+	}
+}
+
+void SimpleCom::SessionRecorder::Run() {
+	HANDLE waiters[] = { _hFlushEvent, _hStopEvent };
+
+	while (true) {
+		DWORD result = WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, session_record_flush_interval_ms);
+		if (result != WAIT_OBJECT_0 && result != WAIT_TIMEOUT) {
+			break;
+		}
+		Flush();
+	}
+}
+
+SimpleCom::SessionReader::SessionReader(const std::string& contents) :
+	_contents(contents),
+	_pos(SESSION_RECORD_HEADER_SZ),
+	_timestamp_us(0)
+{
+	if (_contents.length() < SESSION_RECORD_HEADER_SZ || _contents.compare(0, sizeof(SESSION_RECORD_MAGIC), SESSION_RECORD_MAGIC, sizeof(SESSION_RECORD_MAGIC)) != 0) {
+		throw std::invalid_argument("Not a session record");
+	}
+	if (static_cast<BYTE>(_contents[sizeof(SESSION_RECORD_MAGIC)]) != SESSION_RECORD_VERSION) {
+		throw std::invalid_argument("Unsupported version of session record");
+	}
+}
+
+SimpleCom::SessionReader SimpleCom::SessionReader::FromFile(LPCTSTR filename) {
+	return SessionReader(ReadWholeFile(filename));
+}
+
+bool SimpleCom::SessionReader::Next(TSessionRecord* record) {
+	if (_pos >= _contents.length()) {
+		return false;
+	}
+
+	BYTE type = static_cast<BYTE>(_contents[_pos++]);
+	if (type != static_cast<BYTE>(RecordType::RX) && type != static_cast<BYTE>(RecordType::TX)) {
+		throw std::invalid_argument("Unknown record type at offset " + std::to_string(_pos - 1));
+	}
+
+	ULONGLONG delta_us;
+	ULONGLONG len;
+	if (!DecodeVarint(_contents, &_pos, &delta_us) || !DecodeVarint(_contents, &_pos, &len) || len > _contents.length() - _pos) {
+		// The file might be truncated if SimpleCom was killed.
+		throw std::invalid_argument("Session record is truncated at offset " + std::to_string(_pos));
+	}
+
+	_timestamp_us += delta_us;
+	*record = {
+		.type = static_cast<RecordType>(type),
+		.timestamp_us = _timestamp_us,
+		.data = _contents.c_str() + _pos,
+		.len = static_cast<DWORD>(len)
+	};
+	_pos += static_cast<size_t>(len);
+
+	return true;
+}
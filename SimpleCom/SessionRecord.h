@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+/*
+ * Format of the session record (all integers are little endian):
+ *
+ *   Header (16 bytes):
+ *     char[5]   "SCREC"
+ *     BYTE      version (1)
+ *     BYTE[2]   reserved
+ *     ULONGLONG start time (FILETIME)
+ *
+ *   Records:
+ *     BYTE      type (1: RX, 2: TX)
+ *     varint    delta from the previous record in microseconds
+ *     varint    length of data
+ *     BYTE[]    data
+ *
+ * varint is unsigned LEB128.
+ */
+static constexpr char SESSION_RECORD_MAGIC[] = { 'S', 'C', 'R', 'E', 'C' };
+static constexpr BYTE SESSION_RECORD_VERSION = 1;
+static constexpr size_t SESSION_RECORD_HEADER_SZ = 16;
+
+// Recorded data would be flushed to the file when the buffer exceeds this size, or at least this interval.
+static constexpr size_t session_record_flush_sz = 64 * 1024;
+static constexpr DWORD session_record_flush_interval_ms = 200;
+
+namespace SimpleCom {
+
+	enum class RecordType : BYTE {
+		RX = 1,
+		TX = 2
+	};
+
+	typedef struct {
+		RecordType type;
+		ULONGLONG timestamp_us;
+		const char* data;
+		DWORD len;
+	} TSessionRecord;
+
+	void EncodeVarint(std::string& out, ULONGLONG value);
+
+	// Returns false if the varint is truncated or too long. *pos would be advanced.
+	bool DecodeVarint(const std::string& in, size_t* pos, ULONGLONG* value);
+
+	/*
+	 * Records RX/TX data with timestamp.
+	 * Record() encodes data into the memory buffer only, so it can be called from reader / writer threads.
+	 * The buffer is written to the file on the flusher thread.
+	 */
+	class SessionRecorder
+	{
+	private:
+		HANDLE _hFile;
+		SRWLOCK _lock;
+		std::string _buf;
+		LARGE_INTEGER _freq;
+		LONGLONG _last_counter;
+		HANDLE _hFlushEvent;
+		HANDLE _hStopEvent;
+		HANDLE _hThread;
+		std::atomic<bool> _failed;
+
+		void Flush();
+
+	public:
+		SessionRecorder(LPCTSTR filename);
+		virtual ~SessionRecorder();
+
+		void Record(RecordType type, const char* data, const DWORD len);
+
+		void Run();
+	};
+
+	/*
+	 * Reads records from the session record.
+	 * std::invalid_argument would be thrown if the record is broken.
+	 */
+	class SessionReader
+	{
+	private:
+		std::string _contents;
+		size_t _pos;
+		ULONGLONG _timestamp_us;
+
+	public:
+		SessionReader(const std::string& contents);
+		virtual ~SessionReader() {};
+
+		static SessionReader FromFile(LPCTSTR filename);
+
+		// Returns false at the end of the record. record->data is valid while this reader is alive.
+		bool Next(TSessionRecord* record);
+	};
+
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "SessionStats.h"
+#include "WinAPIException.h"
+#include "util.h"
+#include "debug.h"
+
+
+SimpleCom::SessionStats::SessionStats() : _rx(), _tx(), _console(), _log() {
+	_start_ms = GetTickCount64();
+}
+
+void SimpleCom::SessionStats::CountCommErrors(DWORD errors) {
+	if (errors & CE_OVERRUN) {
+		Add(_rx.overruns, 1);
+	}
+	if (errors & CE_RXOVER) {
+		Add(_rx.rx_overflows, 1);
+	}
+	if (errors & CE_FRAME) {
+		Add(_rx.framing_errors, 1);
+	}
+	if (errors & CE_RXPARITY) {
+		Add(_rx.parity_errors, 1);
+	}
+	if (errors & CE_BREAK) {
+		Add(_rx.breaks, 1);
+	}
+}
+
+SimpleCom::TStatsSnapshot SimpleCom::SessionStats::Snapshot() const {
+	return {
+		.timestamp_ms = GetTickCount64(),
+		.rx_bytes = _rx.bytes.load(std::memory_order_relaxed),
+		.reads = _rx.reads.load(std::memory_order_relaxed),
+		.overruns = _rx.overruns.load(std::memory_order_relaxed),
+		.rx_overflows = _rx.rx_overflows.load(std::memory_order_relaxed),
+		.framing_errors = _rx.framing_errors.load(std::memory_order_relaxed),
+		.parity_errors = _rx.parity_errors.load(std::memory_order_relaxed),
+		.breaks = _rx.breaks.load(std::memory_order_relaxed),
+		.modem_events = _rx.modem_events.load(std::memory_order_relaxed),
+		.tx_bytes = _tx.bytes.load(std::memory_order_relaxed),
+		.breaks_sent = _tx.breaks_sent.load(std::memory_order_relaxed),
+		.console_stalls = _console.stalls.load(std::memory_order_relaxed),
+		.console_max_stall_ms = _console.max_stall_ms.load(std::memory_order_relaxed),
+		.log_depth = _log.depth.load(std::memory_order_relaxed),
+		.log_max_depth = _log.max_depth.load(std::memory_order_relaxed)
+	};
+}
+
+TString SimpleCom::SessionStats::FormatOverlay(const TStatsSnapshot& current, const TStatsSnapshot& prev) {
+	ULONGLONG elapsed_ms = max(current.timestamp_ms - prev.timestamp_ms, 1ULL);
+	ULONGLONG reads = current.reads - prev.reads;
+	ULONGLONG rx_bytes = current.rx_bytes - prev.rx_bytes;
+
+	TStringStream ss;
+	ss << _T("RX ") << (rx_bytes * 1000 / elapsed_ms) << _T(" B/s, ")
+	   << (reads * 1000 / elapsed_ms) << _T(" reads/s, avg ") << ((reads == 0) ? 0 : (rx_bytes / reads)) << _T(" B")
+	   << _T(" | TX ") << ((current.tx_bytes - prev.tx_bytes) * 1000 / elapsed_ms) << _T(" B/s")
+	   << _T(" | overrun ") << (current.overruns + current.rx_overflows)
+	   << _T(", framing ") << current.framing_errors
+	   << _T(", parity ") << current.parity_errors
+	   << _T(" | stall ") << current.console_stalls
+	   << _T(" | log queue ") << current.log_depth << _T(" B");
+	return ss.str();
+}
+
+std::string SimpleCom::SessionStats::Format(const TStatsSnapshot& snapshot) const {
+	double elapsed_sec = max(snapshot.timestamp_ms - _start_ms, 1ULL) / 1000.0;
+	char buf[1024];
+	snprintf(buf, sizeof(buf),
+		"elapsed_sec: %.3f\r\n"
+		"rx_bytes: %llu\r\n"
+		"reads: %llu\r\n"
+		"reads_per_sec: %.2f\r\n"
+		"avg_chunk_bytes: %.2f\r\n"
+		"overruns: %llu\r\n"
+		"rx_overflows: %llu\r\n"
+		"framing_errors: %llu\r\n"
+		"parity_errors: %llu\r\n"
+		"breaks: %llu\r\n"
+		"modem_events: %llu\r\n"
+		"tx_bytes: %llu\r\n"
+		"breaks_sent: %llu\r\n"
+		"console_stalls: %llu\r\n"
+		"console_max_stall_ms: %llu\r\n"
+		"log_queue_depth: %llu\r\n"
+		"log_queue_max_depth: %llu\r\n",
+		elapsed_sec,
+		snapshot.rx_bytes,
+		snapshot.reads,
+		snapshot.reads / elapsed_sec,
+		(snapshot.reads == 0) ? 0.0 : (static_cast<double>(snapshot.rx_bytes) / snapshot.reads),
+		snapshot.overruns,
+		snapshot.rx_overflows,
+		snapshot.framing_errors,
+		snapshot.parity_errors,
+		snapshot.breaks,
+		snapshot.modem_events,
+		snapshot.tx_bytes,
+		snapshot.breaks_sent,
+		snapshot.console_stalls,
+		snapshot.console_max_stall_ms,
+		snapshot.log_depth,
+		snapshot.log_max_depth);
+	return buf;
+}
+
+void SimpleCom::SessionStats::Dump(LPCTSTR filename) const {
+	std::string text = Format(Snapshot());
+
+	HandleHandler hFile(CreateFile(filename, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr), _T("CreateFile for statistics"));
+	DWORD nBytesWritten;
+	if (!WriteFile(hFile.handle(), text.c_str(), static_cast<DWORD>(text.length()), &nBytesWritten, nullptr)) {
+		throw WinAPIException(GetLastError(), _T("WriteFile for statistics"));
+	}
+}
+
+void SimpleCom::StatsOverlay::Toggle() {
+	_enabled = !_enabled;
+
+	if (_enabled) {
+		TCHAR title[MAX_PATH];
+		DWORD len = GetConsoleTitle(title, MAX_PATH);
+		_title = TString(title, len);
+		_prev = _stats->Snapshot();
+		_next_ms = _prev.timestamp_ms + stats_overlay_interval_ms;
+		CALL_WINAPI_WITH_LOG(SetConsoleTitle((_title + _T(" | collecting statistics...")).c_str()), TRUE)
+	}
+	else {
+		CALL_WINAPI_WITH_LOG(SetConsoleTitle(_title.c_str()), TRUE)
+	}
+}
+
+DWORD SimpleCom::StatsOverlay::GetTimeout() const {
+	if (!_enabled) {
+		return INFINITE;
+	}
+
+	ULONGLONG now = GetTickCount64();
+	return (now >= _next_ms) ? 0 : static_cast<DWORD>(_next_ms - now);
+}
+
+void SimpleCom::StatsOverlay::Poll() {
+	if (!_enabled || (GetTickCount64() < _next_ms)) {
+		return;
+	}
+
+	TStatsSnapshot current = _stats->Snapshot();
+	TString title = _title + _T(" | ") + SessionStats::FormatOverlay(current, _prev);
+	CALL_WINAPI_WITH_LOG(SetConsoleTitle(title.c_str()), TRUE)
+
+	_prev = current;
+	_next_ms = current.timestamp_ms + stats_overlay_interval_ms;
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Writing to the console longer than this is counted as a stall.
+static constexpr ULONGLONG console_stall_threshold_ms = 100;
+
+// Interval to refresh statistics in the title bar.
+static constexpr DWORD stats_overlay_interval_ms = 1000;
+
+namespace SimpleCom {
+
+	typedef struct {
+		ULONGLONG timestamp_ms;
+		ULONGLONG rx_bytes;
+		ULONGLONG reads;
+		ULONGLONG overruns;        // CE_OVERRUN: character buffer of the UART is overrun
+		ULONGLONG rx_overflows;    // CE_RXOVER: input buffer of the driver is overflowed
+		ULONGLONG framing_errors;  // CE_FRAME
+		ULONGLONG parity_errors;   // CE_RXPARITY
+		ULONGLONG breaks;          // CE_BREAK
+		ULONGLONG modem_events;    // Changes of CTS, DSR, DCD, and RI
+		ULONGLONG tx_bytes;
+		ULONGLONG breaks_sent;
+		ULONGLONG console_stalls;
+		ULONGLONG console_max_stall_ms;
+		ULONGLONG log_depth;       // Bytes which are received but not written to the log file yet
+		ULONGLONG log_max_depth;
+	} TStatsSnapshot;
+
+	/*
+	 * Counters of the serial session.
+	 * Counters are grouped by the thread which updates them, and each group has its own cache line.
+	 * Counters in RX, console, and log groups are written by one thread only, so they are updated without locked instructions.
+	 * TX counter is shared with writers on several threads (stdin, triggers, script).
+	 */
+	class SessionStats
+	{
+	private:
+		struct alignas(64) {
+			std::atomic<ULONGLONG> bytes;
+			std::atomic<ULONGLONG> reads;
+			std::atomic<ULONGLONG> overruns;
+			std::atomic<ULONGLONG> rx_overflows;
+			std::atomic<ULONGLONG> framing_errors;
+			std::atomic<ULONGLONG> parity_errors;
+			std::atomic<ULONGLONG> breaks;
+			std::atomic<ULONGLONG> modem_events;
+		} _rx;
+
+		struct alignas(64) {
+			std::atomic<ULONGLONG> bytes;
+			std::atomic<ULONGLONG> breaks_sent;
+		} _tx;
+
+		struct alignas(64) {
+			std::atomic<ULONGLONG> stalls;
+			std::atomic<ULONGLONG> max_stall_ms;
+		} _console;
+
+		struct alignas(64) {
+			std::atomic<ULONGLONG> depth;
+			std::atomic<ULONGLONG> max_depth;
+		} _log;
+
+		ULONGLONG _start_ms;
+
+		// For counters which have single writer.
+		static inline void Add(std::atomic<ULONGLONG>& counter, ULONGLONG value) {
+			counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		}
+
+		static inline void UpdateMax(std::atomic<ULONGLONG>& counter, ULONGLONG value) {
+			if (value > counter.load(std::memory_order_relaxed)) {
+				counter.store(value, std::memory_order_relaxed);
+			}
+		}
+
+	public:
+		SessionStats();
+		virtual ~SessionStats() {};
+
+		// Reader thread only.
+		inline void RecordRead(DWORD len) {
+			Add(_rx.bytes, len);
+			Add(_rx.reads, 1);
+		}
+
+		// Reader thread only. errors is the value from ClearCommError().
+		inline void RecordCommErrors(DWORD errors) {
+			if (errors != 0) {
+				CountCommErrors(errors);
+			}
+		}
+
+		void CountCommErrors(DWORD errors);
+
+		// Reader thread only. changed is MS_*_ON bits of lines which are changed.
+		inline void RecordModemEvents(DWORD changed) {
+			for (DWORD bits = changed; bits != 0; bits &= bits - 1) {
+				Add(_rx.modem_events, 1);
+			}
+		}
+
+		inline void RecordWrite(DWORD len) {
+			_tx.bytes.fetch_add(len, std::memory_order_relaxed);
+		}
+
+		inline void RecordBreakSent() {
+			_tx.breaks_sent.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		// Console sink only.
+		inline void RecordConsoleWrite(ULONGLONG elapsed_ms) {
+			if (elapsed_ms >= console_stall_threshold_ms) {
+				Add(_console.stalls, 1);
+				UpdateMax(_console.max_stall_ms, elapsed_ms);
+			}
+		}
+
+		// Log sink only.
+		inline void RecordLogDepth(ULONGLONG depth) {
+			_log.depth.store(depth, std::memory_order_relaxed);
+			UpdateMax(_log.max_depth, depth);
+		}
+
+		TStatsSnapshot Snapshot() const;
+
+		// One line summary for the title bar. Rates are calculated from the difference from prev.
+		static TString FormatOverlay(const TStatsSnapshot& current, const TStatsSnapshot& prev);
+
+		// Whole statistics since the start of the session.
+		std::string Format(const TStatsSnapshot& snapshot) const;
+
+		void Dump(LPCTSTR filename) const;
+	};
+
+	/*
+	 * Statistics in the title bar which is toggled by the hotkey.
+	 * This class is used on the stdin thread only.
+	 */
+	class StatsOverlay
+	{
+	private:
+		SessionStats* _stats;
+		bool _enabled;
+		TString _title;
+		TStatsSnapshot _prev;
+		ULONGLONG _next_ms;
+
+	public:
+		StatsOverlay(SessionStats* stats) : _stats(stats), _enabled(false), _title(), _prev(), _next_ms(0) {};
+		virtual ~StatsOverlay() {};
+
+		// Title would be restored when the overlay is disabled.
+		void Toggle();
+
+		// Timeout to the next refresh, or INFINITE if the overlay is disabled.
+		DWORD GetTimeout() const;
+
+		// Refresh the title if the interval has been elapsed.
+		void Poll();
+	};
+
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019, 2025, Yasumasa Suenaga
+ * Copyright (C) 2019, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,6 +21,12 @@
 #include "SerialSetup.h"
 #include "SerialDeviceScanner.h"
 #include "SerialConnection.h"
+#include "ExpectScript.h"
+#include "Trigger.h"
+#include "SessionRecord.h"
+#include "RxPipeline.h"
+#include "LogWriter.h"
+#include "Trace.h"
 #include "WinAPIException.h"
 #include "debug.h"
 
@@ -46,25 +52,57 @@ static HWND GetParentWindow() {
 
 }
 
-static int DoInteractiveMode(TString& device, DCB *dcb, SimpleCom::SerialSetup &setup, HWND parent_hwnd) {
+static int DoInteractiveMode(TString& device, DCB *dcb, SimpleCom::SerialSetup &setup, HWND parent_hwnd, SimpleCom::ExpectScript* script, SimpleCom::TriggerSet* triggers) {
 	try {
+		// Recorder is shared with reconnected sessions, so the record has one timeline.
+		std::unique_ptr<SimpleCom::SessionRecorder> recorder;
+		if (setup.GetRecordFile() != nullptr) {
+			recorder = std::make_unique<SimpleCom::SessionRecorder>(setup.GetRecordFile());
+		}
+
+		// Connection is shared with reconnected sessions to keep the log file open.
+		SimpleCom::SerialConnection conn(device, dcb, setup.GetLogFile(), setup.IsEnableStdinLogging());
+		conn.SetStatsFile(setup.GetStatsFile());
+		conn.SetShowLineErrors(setup.IsShowLineErrors());
+		conn.SetTraceFile(setup.GetTraceFile());
+		conn.SetAutoBaud(setup.IsAutoBaud());
+
+		// The adapter specified with serial number might be re-enumerated with another port after detaching.
+		conn.SetDeviceResolver([&setup]() -> TString {
+			SimpleCom::SerialDeviceScanner& scanner = setup.GetDeviceScanner();
+			scanner.RefreshIfChanged();
+			TString port = scanner.ResolvePort(setup.GetPort());
+			return port.empty() ? port : (_T(R"(\\.\)") + port);
+		});
+
+		// Detached device would be reopened in the session without the pause.
+		SimpleCom::ReconnectPolicy reconnect_policy(setup.GetAutoReconnectTimeoutInSec() * 1000);
+
 		while (true) {
-			SimpleCom::SerialConnection conn(device, dcb, setup.GetLogFile(), setup.IsEnableStdinLogging());
-			bool reattachable = conn.DoSession(setup.GetAutoReconnect(), setup.GetUseTTYResizer(), parent_hwnd);
+			bool reattachable = conn.DoSession(setup.GetAutoReconnect(), setup.GetUseTTYResizer(), setup.GetResizeDebounce(), parent_hwnd, script, triggers, recorder.get(),
+				setup.GetAutoReconnect() ? &reconnect_policy : nullptr);
 
+			if ((reconnect_policy.open_latency().GetCount() > 0) && SimpleCom::debug::IsEnabled(SimpleCom::LogLevel::INFO)) {
+				SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Latency from detaching to reopening:\n{}"), reconnect_policy.open_latency().Format(_T("ms")));
+			}
+			if (reconnect_policy.IsTimedOut()) {
+				throw SimpleCom::SerialDeviceScanException(_T("Waiting for serial device"), _T("Serial device is not available"));
+			}
+
+			// The session would be restarted if it is finished by errors other than detaching.
 			if (setup.GetAutoReconnect() && reattachable) {
-				SimpleCom::debug::log(_T("Sleep before reconnecting..."));
+				SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Sleep before reconnecting..."));
 				Sleep(setup.GetAutoReconnectPauseInSec() * 1000);
 
-				SimpleCom::debug::log(_T("Reconnect start"));
-				SimpleCom::SerialDeviceScanner scanner;
+				SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Reconnect start"));
+				SimpleCom::SerialDeviceScanner& scanner = setup.GetDeviceScanner();
 				scanner.SetTargetPort(setup.GetPort());
 				RegDisablePredefinedCacheEx();
 				scanner.WaitSerialDevices(parent_hwnd, setup.GetAutoReconnectTimeoutInSec());
 				if (scanner.GetDevices().empty()) {
 					throw SimpleCom::SerialDeviceScanException(_T("Waiting for serial device"), _T("Serial device is not available"));
 				}
-				SimpleCom::debug::log(_T("Reconnect device found"));
+				SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Reconnect device found"));
 			}
 			else {
 				break;
@@ -80,6 +118,99 @@ static int DoInteractiveMode(TString& device, DCB *dcb, SimpleCom::SerialSetup &
 		return -5;
 	}
 
+	if (script != nullptr) {
+		// Script might be used in batch job, so the result should not be shown in dialog.
+		if (!script->GetResultMessage().empty()) {
+			std::cerr << script->GetResultMessage() << std::endl;
+		}
+		return script->IsFinished() ? script->GetExitCode() : SCRIPT_EXIT_ABORTED;
+	}
+
+	return 0;
+}
+
+/*
+ * Feed received data in the record to the RX pipeline as well as live session.
+ * Data would be paced by the timestamp in the record unless the speed is 0.
+ * Throughput of the pipeline would be reported to stderr.
+ */
+static int DoReplayMode(SimpleCom::SerialSetup& setup, HWND parent_hwnd, SimpleCom::TriggerSet* triggers) {
+	ULONGLONG total_bytes = 0;
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+
+	try {
+		SimpleCom::SessionReader reader = SimpleCom::SessionReader::FromFile(setup.GetReplayFile());
+		std::unique_ptr<SimpleCom::LogWriter> logwriter;
+		if (setup.GetLogFile() != nullptr) {
+			logwriter = std::make_unique<SimpleCom::LogWriter>(setup.GetLogFile());
+		}
+
+		SimpleCom::RxPipeline pipeline(logwriter.get());
+		concurrency::concurrent_queue<SimpleCom::WinAPIException> exception_queue;
+		std::atomic<bool> failed = false;
+		pipeline.SetExceptionHandler([&](const SimpleCom::WinAPIException& e) {
+			exception_queue.push(e);
+			failed.store(true, std::memory_order_release);
+		});
+
+		// Actions which send data to the peripheral would fail because there is no serial port.
+		SimpleCom::SerialHandle no_serial(INVALID_HANDLE_VALUE);
+		std::unique_ptr<SimpleCom::TriggerEngine> trigger_engine;
+		if (triggers != nullptr) {
+			trigger_engine = std::make_unique<SimpleCom::TriggerEngine>(*triggers, no_serial, (logwriter == nullptr) ? nullptr : &pipeline.log_markers(), _T("SimpleCom: replay"));
+			pipeline.SetTriggerEngine(trigger_engine.get());
+			trigger_engine->Start();
+		}
+
+		const int speed = setup.GetReplaySpeed();
+		pipeline.Start();
+		QueryPerformanceCounter(&start);
+
+		SimpleCom::TSessionRecord record;
+		while (!failed.load(std::memory_order_acquire) && reader.Next(&record)) {
+			if (record.type != SimpleCom::RecordType::RX) {
+				continue;
+			}
+
+			if (speed > 0) {
+				LARGE_INTEGER now;
+				QueryPerformanceCounter(&now);
+				ULONGLONG elapsed_us = static_cast<ULONGLONG>(now.QuadPart - start.QuadPart) * 1000000ULL / freq.QuadPart;
+				ULONGLONG target_us = record.timestamp_us / speed;
+				if (target_us > elapsed_us) {
+					Sleep(static_cast<DWORD>((target_us - elapsed_us) / 1000));
+				}
+			}
+
+			if (!pipeline.Publish(record.data, record.len)) {
+				break;
+			}
+			total_bytes += record.len;
+		}
+
+		// Throughput includes the time to drain the data from all of consumers.
+		pipeline.Shutdown();
+		QueryPerformanceCounter(&end);
+		if (trigger_engine) {
+			trigger_engine->Stop();
+		}
+
+		SimpleCom::WinAPIException ex;
+		if (exception_queue.try_pop(ex)) {
+			throw ex;
+		}
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		MessageBox(parent_hwnd, e.GetErrorText().c_str(), e.GetErrorCaption(), MB_OK | MB_ICONERROR);
+		return -4;
+	}
+
+	double elapsed_sec = static_cast<double>(end.QuadPart - start.QuadPart) / freq.QuadPart;
+	char buf[128];
+	snprintf(buf, sizeof(buf), "Replayed %llu bytes in %.3f sec (%.2f MB/s)", total_bytes, elapsed_sec, (elapsed_sec > 0) ? (total_bytes / elapsed_sec / (1024 * 1024)) : 0.0);
+	std::cerr << std::endl << buf << std::endl;
+
 	return 0;
 }
 
@@ -90,6 +221,21 @@ static int DoBatchMode(TString& device, DCB* dcb) {
 	return 0;
 }
 
+/*
+ * Dump trace events of all threads on exit if --trace-file is specified.
+ */
+static int DumpTraceOnExit(SimpleCom::SerialSetup& setup, int exit_code) {
+	if (setup.GetTraceFile() != nullptr) {
+		try {
+			SimpleCom::trace::Dump(setup.GetTraceFile());
+		}
+		catch (SimpleCom::WinAPIException& e) {
+			std::wcerr << e.GetErrorText() << std::endl;
+		}
+	}
+	return exit_code;
+}
+
 // https://devblogs.microsoft.com/performance-diagnostics/reduce-process-interference-with-task-manager-efficiency-mode/
 static void SetEfficiencyMode() {
 	HANDLE hProc = GetCurrentProcess();
@@ -103,7 +249,7 @@ static void SetEfficiencyMode() {
 		.ControlMask = PROCESS_POWER_THROTTLING_EXECUTION_SPEED,
 		.StateMask = PROCESS_POWER_THROTTLING_EXECUTION_SPEED
 	};
-	CALL_WINAPI_WITH_DEBUGLOG(SetProcessInformation(hProc, ProcessPowerThrottling, &PowerThrottling, sizeof(PowerThrottling)), TRUE, __FILE__, __LINE__);
+	CALL_WINAPI_WITH_LOG(SetProcessInformation(hProc, ProcessPowerThrottling, &PowerThrottling, sizeof(PowerThrottling)), TRUE);
 }
 
 int _tmain(int argc, LPCTSTR argv[])
@@ -112,18 +258,32 @@ int _tmain(int argc, LPCTSTR argv[])
 	TString device;
 	HWND parent_hwnd = GetParentWindow();
 	SimpleCom::SerialSetup setup;
+	std::unique_ptr<SimpleCom::ExpectScript> script;
+	std::unique_ptr<SimpleCom::TriggerSet> triggers;
 
 	try {
 		// Serial port configuration
 		if (argc > 1) {
 			// command line mode
 			setup.ParseArguments(argc, argv);
+			SimpleCom::debug::SetLevel(setup.GetLogLevel());
 		}
 		else {
 			// GUI mode
 			setup.SetShowDialog(true);
 		}
 
+		if (setup.IsReplayMode()) {
+			// Replay does not need serial device. Broken record would be reported as invalid argument.
+			if (setup.GetTriggerFile() != nullptr) {
+				triggers = std::make_unique<SimpleCom::TriggerSet>(SimpleCom::TriggerSet::FromFile(setup.GetTriggerFile()));
+			}
+			if (setup.GetUseUTF8()) {
+				CALL_WINAPI_WITH_LOG(SetConsoleOutputCP(CP_UTF8), TRUE);
+			}
+			return DumpTraceOnExit(setup, DoReplayMode(setup, parent_hwnd, triggers.get()));
+		}
+
 		if (setup.IsEfficiencyMode()) {
 			SetEfficiencyMode();
 		}
@@ -143,8 +303,21 @@ int _tmain(int argc, LPCTSTR argv[])
 			return -1;
 		}
 
-		device = _T(R"(\\.\)") + setup.GetPort();
+		// Port might be specified with the serial number of the adapter.
+		TString port = setup.GetDeviceScanner().ResolvePort(setup.GetPort());
+		if (port.empty()) {
+			throw SimpleCom::SerialDeviceScanException(_T("configuration"), _T("Serial device with the serial number is not found"));
+		}
+		device = _T(R"(\\.\)") + port;
 		setup.SaveToDCB(&dcb);
+
+		// Load script and triggers before connecting to the peripheral to report syntax error early.
+		if (setup.GetScriptFile() != nullptr) {
+			script = std::make_unique<SimpleCom::ExpectScript>(SimpleCom::ExpectScript::FromFile(setup.GetScriptFile()));
+		}
+		if (setup.GetTriggerFile() != nullptr) {
+			triggers = std::make_unique<SimpleCom::TriggerSet>(SimpleCom::TriggerSet::FromFile(setup.GetTriggerFile()));
+		}
 	}
 	catch (SimpleCom::WinAPIException& e) {
 		MessageBox(parent_hwnd, e.GetErrorText().c_str(), e.GetErrorCaption(), MB_OK | MB_ICONERROR);
@@ -166,12 +339,10 @@ int _tmain(int argc, LPCTSTR argv[])
 	}
 
 	if (setup.GetUseUTF8()) {
-		CALL_WINAPI_WITH_DEBUGLOG(SetConsoleCP(CP_UTF8), TRUE, __FILE__, __LINE__);
-		CALL_WINAPI_WITH_DEBUGLOG(SetConsoleOutputCP(CP_UTF8), TRUE, __FILE__, __LINE__);
-		TStringStream ss2;
-		ss2 << "Code page changed: " << GetConsoleCP();
-		SimpleCom::debug::log(ss2.str().c_str());
+		CALL_WINAPI_WITH_LOG(SetConsoleCP(CP_UTF8), TRUE);
+		CALL_WINAPI_WITH_LOG(SetConsoleOutputCP(CP_UTF8), TRUE);
+		SimpleCom::debug::log(SimpleCom::LogLevel::DBG, _T("Code page changed: {}"), GetConsoleCP());
 	}
 
-	return setup.IsBatchMode() ? DoBatchMode(device, &dcb) : DoInteractiveMode(device, &dcb, setup, parent_hwnd);
+	return setup.IsBatchMode() ? DoBatchMode(device, &dcb) : DumpTraceOnExit(setup, DoInteractiveMode(device, &dcb, setup, parent_hwnd, script.get(), triggers.get()));
 }
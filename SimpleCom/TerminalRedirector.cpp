@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -19,6 +19,10 @@
 #include "stdafx.h"
 #include "TerminalRedirector.h"
 #include "SerialPortWriter.h"
+#include "ResizeDebouncer.h"
+#include "SessionStats.h"
+#include "Trigger.h"
+#include "Trace.h"
 #include "LogWriter.h"
 #include "debug.h"
 #include "WinAPIException.h"
@@ -28,25 +32,88 @@ static constexpr LPCTSTR CLEAR_CONSOLE_COMMAND = _T("\x1b[2J");
 static DWORD CLEAR_CONSOLE_COMMAND_LEN = static_cast<DWORD>(_tcslen(CLEAR_CONSOLE_COMMAND));
 
 
+/*
+ * Mark line errors at current position of received data, and grow input queue of the driver on overrun.
+ */
+static void HandleLineErrors(SimpleCom::TStdOutRedirectorParam* param, const HANDLE hSerial, const DWORD errors) {
+	SYSTEMTIME timestamp;
+	GetLocalTime(&timestamp);
+	param->pipeline->PushMarker(SimpleCom::FormatLogMarker(timestamp, "line error", SimpleCom::FormatCommErrors(errors)), param->showLineErrors);
+
+	DWORD queue_sz = param->queue_tuner->OnCommErrors(errors);
+	if (queue_sz > 0) {
+		CALL_WINAPI_WITH_LOG(SetupComm(hSerial, queue_sz, buf_sz), TRUE)
+		SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("Input queue of the driver is grown to {} bytes due to overrun"), queue_sz);
+	}
+}
+
+/*
+ * Read current state of modem status lines. Changes would be reported from here.
+ */
+static void ResetLineState(SimpleCom::TStdOutRedirectorParam* param, const HANDLE hSerial) {
+	DWORD status;
+	if (GetCommModemStatus(hSerial, &status)) {
+		param->line_state->Reset(status);
+	}
+}
+
+/*
+ * Mark changes of modem status lines at current position of received data, and count them.
+ */
+static void HandleModemEvents(SimpleCom::TStdOutRedirectorParam* param, const HANDLE hSerial, const DWORD events) {
+	DWORD status;
+	if (!GetCommModemStatus(hSerial, &status)) {
+		throw SimpleCom::SerialAPIException(GetLastError(), _T("GetCommModemStatus"));
+	}
+
+	DWORD changed = param->line_state->Update(events, status);
+	if (changed == 0) {
+		return;
+	}
+
+	if (changed & MS_CTS_ON) {
+		TRACE_INSTANT("modem(CTS)");
+	}
+	if (changed & MS_DSR_ON) {
+		TRACE_INSTANT("modem(DSR)");
+	}
+	if (changed & MS_RLSD_ON) {
+		TRACE_INSTANT("modem(DCD)");
+	}
+	if (changed & MS_RING_ON) {
+		TRACE_INSTANT("modem(RI)");
+	}
+	if (param->stats != nullptr) {
+		param->stats->RecordModemEvents(changed);
+	}
+
+	SYSTEMTIME timestamp;
+	GetLocalTime(&timestamp);
+	param->pipeline->PushMarker(SimpleCom::FormatLogMarker(timestamp, "modem", SimpleCom::FormatModemStatus(status)), param->showLineErrors);
+}
+
 /*
  * Entry point for stdout redirector.
- * stdout redirects serial (read op) to stdout.
+ * stdout redirects serial (read op) to the RX pipeline. Consumers of its ring buffer write the data to stdout, log file and so on.
  */
 DWORD WINAPI StdOutRedirector(_In_ LPVOID lpParameter) {
 	SimpleCom::TStdOutRedirectorParam* param = reinterpret_cast<SimpleCom::TStdOutRedirectorParam*>(lpParameter);
+	ResetLineState(param, param->serial->Get());
 
 	while (WaitForSingleObject(param->hTermEvent, 0) != WAIT_OBJECT_0) {
 		try {
+			// Handle might be swapped by reconnection.
+			HANDLE hSerial = param->serial->Get();
 
 			if (!ResetEvent(param->overlapped.hEvent)) {
 				throw SimpleCom::WinAPIException(GetLastError(), _T("ResetEvent for reading data from serial device"));
 			}
 
 			DWORD event_mask = 0;
-			if (!WaitCommEvent(param->hSerial, &event_mask, &param->overlapped)) {
+			if (!WaitCommEvent(hSerial, &event_mask, &param->overlapped)) {
 				if (GetLastError() == ERROR_IO_PENDING) {
 					DWORD unused = 0;
-					if (!GetOverlappedResult(param->hSerial, &param->overlapped, &unused, TRUE)) {
+					if (!GetOverlappedResult(hSerial, &param->overlapped, &unused, TRUE)) {
 						throw SimpleCom::SerialAPIException(GetLastError(), _T("GetOverlappedResult for WaitCommEvent"));
 					}
 				}
@@ -55,38 +122,56 @@ DWORD WINAPI StdOutRedirector(_In_ LPVOID lpParameter) {
 				}
 			}
 
+			if (event_mask & modem_event_mask) {
+				HandleModemEvents(param, hSerial, event_mask);
+			}
+
 			if (event_mask & EV_RXCHAR) {
 				DWORD errors;
 				COMSTAT comstat = { 0 };
-				if (!ClearCommError(param->hSerial, &errors, &comstat)) {
+				if (!ClearCommError(hSerial, &errors, &comstat)) {
 					throw SimpleCom::SerialAPIException(GetLastError(), _T("ClearCommError"));
 				}
+				if (param->stats != nullptr) {
+					param->stats->RecordCommErrors(errors);
+				}
+				if (errors != 0) {
+					HandleLineErrors(param, hSerial, errors);
+				}
 
-				char buf[buf_sz] = { 0 };
 				DWORD nBytesRead = 0;
 				DWORD remainBytes = comstat.cbInQue;
 				while (remainBytes > 0) {
 
-					if (!ReadFile(param->hSerial, buf, min(buf_sz, remainBytes), &nBytesRead, &param->overlapped)) {
-						if (GetLastError() == ERROR_IO_PENDING) {
-							if (!GetOverlappedResult(param->hSerial, &param->overlapped, &nBytesRead, FALSE)) {
-								throw SimpleCom::SerialAPIException(GetLastError(), _T("GetOverlappedResult for ReadFile"));
+					// Read into the ring directly to avoid copying the data.
+					DWORD available;
+					char* buf = param->pipeline->Claim(remainBytes, &available);
+					if (buf == nullptr) {
+						// The ring has been aborted.
+						return 0;
+					}
+
+					{
+						TRACE_SCOPE("ReadFile(serial)");
+						if (!ReadFile(hSerial, buf, available, &nBytesRead, &param->overlapped)) {
+							if (GetLastError() == ERROR_IO_PENDING) {
+								if (!GetOverlappedResult(hSerial, &param->overlapped, &nBytesRead, FALSE)) {
+									throw SimpleCom::SerialAPIException(GetLastError(), _T("GetOverlappedResult for ReadFile"));
+								}
+							}
+							else {
+								throw SimpleCom::SerialAPIException(GetLastError(), _T("ReadFile from serial device"));
 							}
-						}
-						else {
-							throw SimpleCom::SerialAPIException(GetLastError(), _T("ReadFile from serial device"));
 						}
 					}
 
 					if (nBytesRead > 0) {
-						DWORD nBytesWritten;
-						if (!WriteFile(param->hStdOut, buf, nBytesRead, &nBytesWritten, NULL)) {
-							throw SimpleCom::WinAPIException(GetLastError(), _T("WriteFile to stdout"));
+						if (param->stats != nullptr) {
+							param->stats->RecordRead(nBytesRead);
 						}
-						if (param->logwriter != nullptr) {
-							param->logwriter->Write(buf, nBytesRead);
-						}
-						remainBytes -= nBytesRead;
+						param->serial->NotifyReceived();
+						param->pipeline->Commit(buf, nBytesRead);
+						remainBytes -= min(remainBytes, nBytesRead);
 					}
 
 				}
@@ -95,6 +180,31 @@ DWORD WINAPI StdOutRedirector(_In_ LPVOID lpParameter) {
 		}
 		catch (SimpleCom::WinAPIException& e) {
 			if (WaitForSingleObject(param->hTermEvent, 0) != WAIT_OBJECT_0) {
+				if (e.IsSerialAPIException() && SimpleCom::IsDeviceDetachedError(e.GetErrorCode()) && param->reconnect) {
+					// Keep the session (threads, log, and console) as is, and swap the handle only.
+					SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Serial device is detached, waiting for re-arrival..."));
+					param->serial->Detach();
+					HANDLE hNewSerial = param->reconnect(param->hTermEvent);
+					if (hNewSerial != INVALID_HANDLE_VALUE) {
+						if (param->queue_tuner->GetSize() > buf_sz) {
+							// The queue which has been grown in this session should be kept.
+							CALL_WINAPI_WITH_LOG(SetupComm(hNewSerial, param->queue_tuner->GetSize(), buf_sz), TRUE)
+						}
+						param->serial->Attach(hNewSerial);
+						ResetLineState(param, hNewSerial);
+						if (param->modem != nullptr) {
+							// DTR and RTS are reset by SetCommState() for the new handle.
+							try {
+								param->modem->Reapply();
+							}
+							catch (SimpleCom::WinAPIException& modem_error) {
+								SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("{}"), modem_error.GetErrorText());
+							}
+						}
+						continue;
+					}
+				}
+
 				SetEvent(param->hTermEvent);
 				param->exception_handler(e);
 				break;
@@ -113,6 +223,8 @@ static bool ShouldTerminate(HWND parent_hwnd, SimpleCom::SerialPortWriter& write
 	// Write all keys in the buffer before F1
 	writer.WriteAsync();
 
+	TRACE_SCOPE("MessageBox(terminate)");
+
 	if (MessageBox(parent_hwnd, _T("Do you want to leave from this serial session?"), _T("SimpleCom"), MB_YESNO | MB_ICONQUESTION) == IDYES) {
 		SetEvent(hTermEvent);
 		return true;
@@ -142,6 +254,109 @@ static void ProcessKeyEvents(const KEY_EVENT_RECORD keyevent, SimpleCom::SerialP
 	}
 }
 
+/*
+ * Returns the last char of the escape sequence of F1 - F4 (ESC O P - ESC O S) at idx, or '\0' if it is not.
+ *
+ * Input sequence on Windows (ENABLE_VIRTUAL_TERMINAL_INPUT):
+ *   https://learn.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences#numpad--function-keys
+ */
+static char GetFunctionKey(const INPUT_RECORD* inputs, const DWORD idx, const DWORD n_read) {
+	if ((idx + 2 < n_read) &&
+		(inputs[idx].Event.KeyEvent.wRepeatCount == 1 && inputs[idx].Event.KeyEvent.uChar.AsciiChar == '\x1b' /* ESC */) &&
+		(inputs[idx + 1].Event.KeyEvent.wRepeatCount == 1 && inputs[idx + 1].Event.KeyEvent.uChar.AsciiChar == 'O') &&
+		(inputs[idx + 2].Event.KeyEvent.wRepeatCount == 1)) {
+		return inputs[idx + 2].Event.KeyEvent.uChar.AsciiChar;
+	}
+	return '\0';
+}
+
+/*
+ * Write escape sequence of the function key (ESC O [key]) to send buffer as typed keys.
+ */
+static void SendFunctionKey(const char key, SimpleCom::SerialPortWriter& writer, SimpleCom::LogWriter* logwriter) {
+	for (const char c : { '\x1b', 'O', key }) {
+		writer.Put(c);
+		if (logwriter != nullptr) {
+			logwriter->Write(c);
+		}
+	}
+}
+
+/*
+ * Dump trace events to the file. Failure would not affect the session.
+ */
+static void DumpTrace(LPCTSTR filename) {
+	try {
+		SimpleCom::trace::Dump(filename);
+		SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("Trace has been dumped to {}"), filename);
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("{}"), e.GetErrorText());
+	}
+}
+
+/*
+ * Call modem controller or line configurator on the stdin thread.
+ * Failure of them (e.g. RTS under hardware flow control, unsupported baud rate) should not terminate the session, but detaching should be handled as usual.
+ */
+static void CallSerialController(std::function<void()> func) {
+	try {
+		func();
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		if (e.IsSerialAPIException() && SimpleCom::IsDeviceDetachedError(e.GetErrorCode())) {
+			throw;
+		}
+		SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("{}"), e.GetErrorText());
+	}
+}
+
+/*
+ * Copy the message into the buffer of the writer.
+ * PutData() cannot be used for local strings because the memory is written asynchronously after the return.
+ */
+static void PutMessage(SimpleCom::SerialPortWriter& writer, const std::string& message) {
+	for (char ch : message) {
+		writer.Put(ch);
+	}
+}
+
+/*
+ * Send resize request to TTY Resizer if the debouncer allows.
+ */
+static void SendResizeRequest(SimpleCom::ResizeDebouncer& debouncer, SimpleCom::ResizerNegotiator* negotiator, SimpleCom::SerialPortWriter& writer) {
+	COORD size;
+	if (debouncer.Poll(&size)) {
+		PutMessage(writer, SimpleCom::EncodeResizeRequest(negotiator->GetVersion(), size));
+	}
+}
+
+/*
+ * TTY Resizer replied its version. Send HELLO with capabilities of SimpleCom, and sync the clock if it is supported.
+ */
+static void CompleteNegotiation(SimpleCom::ResizerNegotiator* negotiator, SimpleCom::SerialPortWriter& writer, bool* hello_sent) {
+	if (negotiator->GetVersion() < 2) {
+		return;
+	}
+
+	std::string message;
+	if (!*hello_sent) {
+		message = SimpleCom::EncodeResizerHello(RESIZER_CAPS);
+		*hello_sent = true;
+	}
+	else if (negotiator->GetCapabilities() & RESIZER_CAP_CLOCK_SYNC) {
+		// Reply for HELLO
+		FILETIME ft;
+		GetSystemTimeAsFileTime(&ft);
+		ULONGLONG filetime = (static_cast<ULONGLONG>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+		message = SimpleCom::EncodeResizerClockSync((filetime - 116444736000000000ULL) / 10);
+	}
+
+	if (!message.empty()) {
+		PutMessage(writer, message);
+	}
+}
+
 /*
  * Entry point for stdin redirector.
  * stdin redirects stdin to serial (write op).
@@ -153,72 +368,132 @@ DWORD WINAPI StdInRedirector(_In_ LPVOID lpParameter) {
 	DWORD n_read;
 
 	CONSOLE_SCREEN_BUFFER_INFO console_info = { 0 };
-	CALL_WINAPI_WITH_DEBUGLOG(GetConsoleScreenBufferInfo(param->hStdOut, &console_info), TRUE, __FILE__, __LINE__)
-	COORD current_window_sz = console_info.dwSize;
+	CALL_WINAPI_WITH_LOG(GetConsoleScreenBufferInfo(param->hStdOut, &console_info), TRUE)
+	SimpleCom::ResizeDebouncer debouncer(console_info.dwSize, param->resizeDebounceMs);
+	SimpleCom::StatsOverlay overlay(param->stats);
+	bool hello_sent = false;
+	bool modem_prefix = false;
 
-	SimpleCom::SerialPortWriter writer(param->hSerial, buf_sz);
+	SimpleCom::SerialPortWriter writer(*param->serial, buf_sz);
+	writer.SetRecorder(param->recorder);
 
 	try {
-		HANDLE waiters[] = { param->hStdIn, param->hTermEvent };
-		COORD newConsoleSize;
-		bool isConsoleSizeUpdated = false;
+		HANDLE waiters[] = { param->hStdIn, param->hTermEvent, param->negotiator->negotiated_event() };
+
+		if (param->useTTYResizer) {
+			// Start with v1 request for current size. TTY Resizer which supports v2 would reply to it.
+			PutMessage(writer, SimpleCom::EncodeResizeRequest(1, console_info.dwSize));
+			writer.WriteAsync();
+		}
 
 		while (true) {
-			DWORD result = WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, INFINITE);
-			if (result == WAIT_OBJECT_0) { // hStdIn
-				if (!ReadConsoleInput(param->hStdIn, inputs, sizeof(inputs) / sizeof(INPUT_RECORD), &n_read)) {
-					throw SimpleCom::WinAPIException(GetLastError());
-				}
+			// Wake up when pending resize request should be sent, statistics in the title bar should be refreshed, or BREAK should be cleared.
+			DWORD timeout = min(debouncer.GetTimeout(), overlay.GetTimeout());
+			if (param->modem != nullptr) {
+				timeout = min(timeout, param->modem->GetTimeout());
+			}
+			DWORD result = WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, timeout);
+			try {
+				if (result == WAIT_OBJECT_0) { // hStdIn
+					{
+						TRACE_SCOPE("ReadConsoleInput");
+						if (!ReadConsoleInput(param->hStdIn, inputs, sizeof(inputs) / sizeof(INPUT_RECORD), &n_read)) {
+							throw SimpleCom::WinAPIException(GetLastError());
+						}
+					}
 
-				for (DWORD idx = 0; idx < n_read; idx++) {
-					if (inputs[idx].EventType == KEY_EVENT) {
-						// Skip escape sequence of F1 (0x1B 0x4F 0x50)
-						//
-						// Input sequence on Windows (ENABLE_VIRTUAL_TERMINAL_INPUT):
-						//   https://learn.microsoft.com/en-us/windows/console/console-virtual-terminal-sequences#numpad--function-keys
-						if (idx + 2 < n_read &&
-							(inputs[idx].Event.KeyEvent.wRepeatCount == 1 && inputs[idx].Event.KeyEvent.uChar.AsciiChar == '\x1b' /* ESC */) &&
-							(inputs[idx + 1].Event.KeyEvent.wRepeatCount == 1 && inputs[idx + 1].Event.KeyEvent.uChar.AsciiChar == 'O') &&
-							(inputs[idx + 2].Event.KeyEvent.wRepeatCount == 1 && inputs[idx + 2].Event.KeyEvent.uChar.AsciiChar == 'P')) {
-							idx += 2;
-							if (ShouldTerminate(param->parent_hwnd, writer, param->hTermEvent)) {
-								*param->reattachable = false;
-								CALL_WINAPI_WITH_DEBUGLOG(CancelIoEx(param->hSerial, nullptr), TRUE, __FILE__, __LINE__)
-								return 0;
+					for (DWORD idx = 0; idx < n_read; idx++) {
+						if (inputs[idx].EventType == KEY_EVENT) {
+							// Key after F4 is a command for modem control lines or line configuration. Unknown key is discarded.
+							// F4 twice sends escape sequence of F4 to the peripheral.
+							const KEY_EVENT_RECORD& keyevent = inputs[idx].Event.KeyEvent;
+							if (modem_prefix && (GetFunctionKey(inputs, idx, n_read) == 'S')) {
+								idx += 2;
+								modem_prefix = false;
+								SendFunctionKey('S', writer, param->enableStdinLogging ? param->logwriter : nullptr);
+								continue;
 							}
-							else {
+							if (modem_prefix && keyevent.bKeyDown && (keyevent.uChar.AsciiChar != '\0')) {
+								modem_prefix = false;
+								const char key = keyevent.uChar.AsciiChar;
+								CallSerialController([param, &writer, key] {
+									if (!param->modem->HandleCommandKey(key) && (param->line_config != nullptr)) {
+										// Keys which are typed before F4 should be sent with current configuration.
+										writer.WriteAsync();
+										param->line_config->HandleCommandKey(key);
+									}
+								});
 								continue;
 							}
-						}
 
-						ProcessKeyEvents(inputs[idx].Event.KeyEvent, writer, param->enableStdinLogging ? param->logwriter : nullptr);
-					}
-					else if ((inputs[idx].EventType == WINDOW_BUFFER_SIZE_EVENT) && param->useTTYResizer) {
-						if (memcmp(&current_window_sz, &inputs[idx].Event.WindowBufferSizeEvent.dwSize, sizeof(COORD)) != 0) {
-							newConsoleSize = inputs[idx].Event.WindowBufferSizeEvent.dwSize;
-							isConsoleSizeUpdated = true;
+							// Skip escape sequence of F1 (ESC O P), F2 (ESC O Q), F3 (ESC O R), and F4 (ESC O S)
+							char function_key = GetFunctionKey(inputs, idx, n_read);
+							if ((function_key == 'S') && (param->modem != nullptr)) {
+								idx += 2;
+								modem_prefix = true;
+								continue;
+							}
+							if ((function_key == 'Q') && param->statsHotkey && (param->stats != nullptr)) {
+								idx += 2;
+								overlay.Toggle();
+								continue;
+							}
+							if ((function_key == 'R') && (param->traceFile != nullptr)) {
+								idx += 2;
+								DumpTrace(param->traceFile);
+								continue;
+							}
+							if (function_key == 'P') {
+								idx += 2;
+								if (ShouldTerminate(param->parent_hwnd, writer, param->hTermEvent)) {
+									*param->reattachable = false;
+									param->serial->CancelIo();
+									return 0;
+								}
+								else {
+									continue;
+								}
+							}
+
+							ProcessKeyEvents(inputs[idx].Event.KeyEvent, writer, param->enableStdinLogging ? param->logwriter : nullptr);
+						}
+						else if ((inputs[idx].EventType == WINDOW_BUFFER_SIZE_EVENT) && param->useTTYResizer) {
+							debouncer.Update(inputs[idx].Event.WindowBufferSizeEvent.dwSize);
 						}
 					}
 
-					if (isConsoleSizeUpdated) {
-						DWORD numOfEvents;
-						if (GetNumberOfConsoleInputEvents(param->hStdIn, &numOfEvents) && (numOfEvents == 0)) {
-							char buf[RINGBUF_SZ];
-							int len = snprintf(buf, sizeof(buf), "%c%d" RESIZER_SEPARATOR "%d%c", RESIZER_START_MARKER, newConsoleSize.Y, newConsoleSize.X, RESIZER_END_MARKER);
-							writer.PutData(buf, len);
-							isConsoleSizeUpdated = false;
-							current_window_sz = newConsoleSize;
-						}
+					SendResizeRequest(debouncer, param->negotiator, writer);
+					writer.WriteAsync();
+					overlay.Poll();
+					if (param->modem != nullptr) {
+						CallSerialController([param] { param->modem->Poll(); });
 					}
 				}
-
-				writer.WriteAsync();
-			}
-			else if (result == (WAIT_OBJECT_0 + 1)) { // hTermEvent
-				break;
+				else if (result == WAIT_TIMEOUT) { // Quiet period of resizing, interval of the overlay, or duration of BREAK has been elapsed
+					SendResizeRequest(debouncer, param->negotiator, writer);
+					writer.WriteAsync();
+					overlay.Poll();
+					if (param->modem != nullptr) {
+						CallSerialController([param] { param->modem->Poll(); });
+					}
+				}
+				else if (result == (WAIT_OBJECT_0 + 2)) { // Reply from TTY Resizer
+					CompleteNegotiation(param->negotiator, writer, &hello_sent);
+					writer.WriteAsync();
+				}
+				else if (result == (WAIT_OBJECT_0 + 1)) { // hTermEvent
+					break;
+				}
+				else {
+					throw SimpleCom::WinAPIException(GetLastError(), _T("WaitForMultipleObjects in StdInRedirector"));
+				}
 			}
-			else {
-				throw SimpleCom::WinAPIException(GetLastError(), _T("WaitForMultipleObjects in StdInRedirector"));
+			catch (SimpleCom::SerialAPIException& e) {
+				// Keys would be discarded while the reader waits for re-arrival of the device.
+				if (!param->reconnectable || !SimpleCom::IsDeviceDetachedError(e.GetErrorCode())) {
+					throw;
+				}
+				SimpleCom::debug::log(SimpleCom::LogLevel::DBG, _T("Discard keys because serial device is detached."));
 			}
 		}
 	}
@@ -232,55 +507,83 @@ DWORD WINAPI StdInRedirector(_In_ LPVOID lpParameter) {
 	return 0;
 }
 
-SimpleCom::TerminalRedirector::TerminalRedirector(HANDLE hSerial, SimpleCom::LogWriter* logwriter, bool enableStdinLogging, bool useTTYResizer, HWND parent_hwnd) :
-	TerminalRedirectorBase(hSerial),
+SimpleCom::TerminalRedirector::TerminalRedirector(SerialHandle& serial, SimpleCom::LogWriter* logwriter, bool enableStdinLogging, bool useTTYResizer, DWORD resizeDebounceMs, HWND parent_hwnd, std::function<HANDLE(HANDLE)> reconnect) :
+	TerminalRedirectorBase(serial.Get()),
+	_serial(serial),
 	_hTermEvent(CreateEvent(NULL, TRUE, FALSE, NULL), _T("CreateEvent for thread termination")),
 	_hIoEvent(CreateEvent(NULL, TRUE, TRUE, NULL), _T("CreateEvent for reading from serial device")),
 	_exception_queue(),
-	_reattachable(true)
+	_reattachable(true),
+	_negotiator(),
+	_rx_pipeline(logwriter),
+	_queue_tuner(buf_sz, driver_queue_max_sz),
+	_line_state()
 {
-	TStringStream ss;
-	ss << "Current code page: " << GetConsoleCP();
-	SimpleCom::debug::log(ss.str().c_str());
+	SimpleCom::debug::log(SimpleCom::LogLevel::DBG, _T("Current code page: {}"), GetConsoleCP());
 
 	DWORD mode;
 	HANDLE hStdIn = GetStdHandle(STD_INPUT_HANDLE);
 	if (hStdIn == INVALID_HANDLE_VALUE) {
 		throw SimpleCom::WinAPIException(GetLastError(), _T("GetStdHandle(stdin)"));
 	}
-	CALL_WINAPI_WITH_DEBUGLOG(GetConsoleMode(hStdIn, &mode), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(GetConsoleMode(hStdIn, &mode), TRUE)
 		mode &= ~ENABLE_PROCESSED_INPUT;
 	mode |= ENABLE_VIRTUAL_TERMINAL_INPUT;
-	CALL_WINAPI_WITH_DEBUGLOG(SetConsoleMode(hStdIn, mode), TRUE, __FILE__, __LINE__)
+	CALL_WINAPI_WITH_LOG(SetConsoleMode(hStdIn, mode), TRUE)
+
+	HANDLE hStdOut = _rx_pipeline.stdout_handle();
+	_hStdOut = hStdOut;
 
-	HANDLE hStdOut = GetStdHandle(STD_OUTPUT_HANDLE);
-	if (hStdOut == INVALID_HANDLE_VALUE) {
-		throw SimpleCom::WinAPIException(GetLastError(), _T("GetStdHandle(stdout)"));
+	// Error in sinks should terminate the session as well as redirector threads.
+	_rx_pipeline.SetExceptionHandler([&](const WinAPIException& e) {
+		if (WaitForSingleObject(_hTermEvent.handle(), 0) != WAIT_OBJECT_0) {
+			SetEvent(_hTermEvent.handle());
+			_exception_queue.push(e);
+			_serial.CancelIo();
+		}
+	});
+
+	if (useTTYResizer) {
+		// Reply from TTY Resizer is for the negotiator only. It should not be shown on the console nor written to the log.
+		_rx_pipeline.FilterResizerReply();
+		// Reply from TTY Resizer is small, and it is harmless to miss it (v1 would be kept), so this consumer should not block others.
+		_rx_pipeline.ring().Subscribe([this](const char* data, const DWORD len) { _negotiator.Feed(data, len); }, OverflowPolicy::DROP);
 	}
-	CALL_WINAPI_WITH_DEBUGLOG(GetConsoleMode(hStdOut, &mode), TRUE, __FILE__, __LINE__);
-	mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING | ENABLE_PROCESSED_OUTPUT;
-	CALL_WINAPI_WITH_DEBUGLOG(SetConsoleMode(hStdOut, mode), TRUE, __FILE__, __LINE__);
 
 	_stdin_param = {
-		.hSerial = hSerial,
+		.serial = &serial,
 		.hStdIn = hStdIn,
 		.hStdOut = hStdOut,
 		.enableStdinLogging = enableStdinLogging,
 		.logwriter = logwriter,
+		.recorder = nullptr,
 		.useTTYResizer = useTTYResizer,
+		.resizeDebounceMs = resizeDebounceMs,
+		.negotiator = &_negotiator,
 		.parent_hwnd = parent_hwnd,
 		.hTermEvent = _hTermEvent.handle(),
 		.exception_handler = [&](const WinAPIException& e) { _exception_queue.push(e); },
-		.reattachable = &_reattachable
+		.reattachable = &_reattachable,
+		.reconnectable = static_cast<bool>(reconnect),
+		.stats = nullptr,
+		.statsHotkey = false,
+		.traceFile = nullptr,
+		.modem = nullptr,
+		.line_config = nullptr
 	};
 
 	_stdout_param = {
-		.hSerial = hSerial,
-		.hStdOut = hStdOut,
+		.serial = &serial,
 		.overlapped = { .hEvent = _hIoEvent.handle() },
-		.logwriter = logwriter,
+		.pipeline = &_rx_pipeline,
 		.hTermEvent = _hTermEvent.handle(),
-		.exception_handler = [&](const WinAPIException& e) { _exception_queue.push(e); }
+		.exception_handler = [&](const WinAPIException& e) { _exception_queue.push(e); },
+		.reconnect = reconnect,
+		.stats = nullptr,
+		.showLineErrors = false,
+		.queue_tuner = &_queue_tuner,
+		.line_state = &_line_state,
+		.modem = nullptr
 	};
 }
 
@@ -292,13 +595,33 @@ std::tuple<LPTHREAD_START_ROUTINE, LPVOID> SimpleCom::TerminalRedirector::GetStd
 	return { &StdOutRedirector, &_stdout_param };
 }
 
+SimpleCom::TerminalRedirector::~TerminalRedirector() {
+	// Redirectors are still running if the session is not finished via AwaitTermination() (e.g. exception after StartRedirector()).
+	Terminate();
+	_tasks.Await();
+}
+
 void SimpleCom::TerminalRedirector::StartRedirector(){
 	// Clear console
-	WriteConsole(_stdout_param.hStdOut, CLEAR_CONSOLE_COMMAND, CLEAR_CONSOLE_COMMAND_LEN, nullptr, nullptr);
+	WriteConsole(_hStdOut, CLEAR_CONSOLE_COMMAND, CLEAR_CONSOLE_COMMAND_LEN, nullptr, nullptr);
 
+	_rx_pipeline.Start();
 	TerminalRedirectorBase::StartRedirector();
 }
 
+void SimpleCom::TerminalRedirector::AwaitTermination() {
+	TerminalRedirectorBase::AwaitTermination();
+
+	// Stdout redirector (producer) has been finished. Consumers would be finished after they drain the ring.
+	_rx_pipeline.Shutdown();
+}
+
+void SimpleCom::TerminalRedirector::Terminate() {
+	_reattachable = false;
+	SetEvent(_hTermEvent.handle());
+	_serial.CancelIo();
+}
+
 bool SimpleCom::TerminalRedirector::Reattachable() {
 	return _reattachable;
 }
\ No newline at end of file
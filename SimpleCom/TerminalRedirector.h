@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -22,41 +22,69 @@
 #include "TerminalRedirectorBase.h"
 #include "util.h"
 #include "LogWriter.h"
+#include "RxPipeline.h"
+#include "SessionRecord.h"
+#include "ResizerProtocol.h"
+#include "SerialHandle.h"
+#include "SessionStats.h"
+#include "LineErrors.h"
+#include "ModemControl.h"
+#include "LineConfig.h"
 #include "WinAPIException.h"
 
 
 namespace SimpleCom
 {
     typedef struct {
-        HANDLE hSerial;
-        HANDLE hStdOut;
+        SimpleCom::SerialHandle* serial;
         OVERLAPPED overlapped;
-        SimpleCom::LogWriter* logwriter;
+        SimpleCom::RxPipeline* pipeline;
         HANDLE hTermEvent;
         std::function<void(const SimpleCom::WinAPIException&)> exception_handler;
+        std::function<HANDLE(HANDLE)> reconnect;
+        SimpleCom::SessionStats* stats;
+        bool showLineErrors;
+        SimpleCom::DriverQueueTuner* queue_tuner;
+        SimpleCom::LineStateMonitor* line_state;
+        SimpleCom::ModemController* modem;
     } TStdOutRedirectorParam;
 
     typedef struct {
-        HANDLE hSerial;
+        SimpleCom::SerialHandle* serial;
         HANDLE hStdIn;
         HANDLE hStdOut;
         bool enableStdinLogging;
         SimpleCom::LogWriter* logwriter;
+        SimpleCom::SessionRecorder* recorder;
         bool useTTYResizer;
+        DWORD resizeDebounceMs;
+        SimpleCom::ResizerNegotiator* negotiator;
         HWND parent_hwnd;
         HANDLE hTermEvent;
         std::function<void(const SimpleCom::WinAPIException&)> exception_handler;
         bool* reattachable;
+        bool reconnectable;
+        SimpleCom::SessionStats* stats;
+        bool statsHotkey;
+        LPCTSTR traceFile;
+        SimpleCom::ModemController* modem;
+        SimpleCom::LineConfigurator* line_config;
     } TStdInRedirectorParam;
 
     class TerminalRedirector :
         public TerminalRedirectorBase
     {
     private:
+        SerialHandle& _serial;
         HandleHandler _hTermEvent;
         HandleHandler _hIoEvent;
         concurrency::concurrent_queue<WinAPIException> _exception_queue;
         bool _reattachable;
+        HANDLE _hStdOut;
+        ResizerNegotiator _negotiator;  // should outlive consumers of _rx_pipeline
+        RxPipeline _rx_pipeline;
+        DriverQueueTuner _queue_tuner;
+        LineStateMonitor _line_state;
         TStdInRedirectorParam _stdin_param;
         TStdOutRedirectorParam _stdout_param;
 
@@ -65,14 +93,81 @@ namespace SimpleCom
         virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdOutRedirector() override;
 
     public:
-        TerminalRedirector(HANDLE hSerial, LogWriter* logwriter, bool enableStdinLogging, bool useTTYResizer, HWND parent_hwnd);
-        virtual ~TerminalRedirector() {};
+        /*
+         * reconnect would be called on the reader thread when the device is detached. Its argument would be signaled when the session is terminated.
+         * It should return new handle which is initialized for the session, or INVALID_HANDLE_VALUE if the device is not available.
+         * The session would be finished on detaching if reconnect is empty.
+         */
+        TerminalRedirector(SerialHandle& serial, LogWriter* logwriter, bool enableStdinLogging, bool useTTYResizer, DWORD resizeDebounceMs, HWND parent_hwnd, std::function<HANDLE(HANDLE)> reconnect);
+        virtual ~TerminalRedirector();
 
         inline concurrency::concurrent_queue<WinAPIException> & exception_queue() {
             return _exception_queue;
 		}
 
+        // Sinks for received data can be added via this ring before StartRedirector().
+        inline BroadcastRing& rx_ring() {
+            return _rx_pipeline.ring();
+        }
+
+        // Markers in this queue would be written into the log file at their positions in received data.
+        inline LogMarkerQueue& log_markers() {
+            return _rx_pipeline.log_markers();
+        }
+
+        // Triggers would be scanned on the reader thread. This should be called before StartRedirector().
+        inline void SetTriggerEngine(TriggerEngine* triggers) {
+            _rx_pipeline.SetTriggerEngine(triggers);
+        }
+
+        // Both of received and sent data would be recorded. This should be called before StartRedirector().
+        inline void SetRecorder(SessionRecorder* recorder) {
+            _rx_pipeline.SetRecorder(recorder);
+            _stdin_param.recorder = recorder;
+        }
+
+        // Counters would be updated on redirector threads. This should be called before StartRedirector().
+        inline void SetStats(SessionStats* stats) {
+            _rx_pipeline.SetStats(stats);
+            _stdin_param.stats = stats;
+            _stdout_param.stats = stats;
+        }
+
+        // F2 shows statistics in the title bar if this is true. Otherwise F2 would be propagated to the peripheral.
+        inline void SetStatsHotkey(bool enable) {
+            _stdin_param.statsHotkey = enable;
+        }
+
+        // Line errors are always marked in the log file. They would be shown on the console as well if this is true.
+        inline void SetShowLineErrors(bool show) {
+            _stdout_param.showLineErrors = show;
+        }
+
+        // Trace events would be dumped to the file when F3 is pressed.
+        inline void SetTraceFile(LPCTSTR trace_file) {
+            _stdin_param.traceFile = trace_file;
+        }
+
+        // F4 followed by a command key drives BREAK, DTR, and RTS. F4 twice sends F4 to the peripheral. Lines would be set again on reconnection. This should be called before StartRedirector().
+        inline void SetModemController(ModemController* modem) {
+            _stdin_param.modem = modem;
+            _stdout_param.modem = modem;
+        }
+
+        // F4 followed by `+` or `-` changes the baud rate. This should be called before StartRedirector().
+        inline void SetLineConfigurator(LineConfigurator* line_config) {
+            _stdin_param.line_config = line_config;
+        }
+
+        inline HANDLE term_event() const {
+            return _hTermEvent.handle();
+        }
+
+        // Finish the session from outside of redirector threads. The session would not be reattached.
+        void Terminate();
+
         void StartRedirector() override;
+        void AwaitTermination() override;
         bool Reattachable() override;
     };
 }
\ No newline at end of file
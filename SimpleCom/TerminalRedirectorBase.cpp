@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -27,21 +27,14 @@ void SimpleCom::TerminalRedirectorBase::StartRedirector()
 	auto [StdInRedirector, stdin_param] = GetStdInRedirector();
 	auto [StdOutRedirector, stdout_param] = GetStdOutRedirector();
 
-	_hThreadStdIn = CreateThread(NULL, 0, StdInRedirector, stdin_param, 0, NULL);
-	if (GetLastError() != ERROR_SUCCESS) {
-		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateThread for StdInRedirector"));
-	}
-
-	_hThreadStdOut = CreateThread(NULL, 0, StdOutRedirector, stdout_param, 0, NULL);
-	if (GetLastError() != ERROR_SUCCESS) {
-		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateThread for StdOutRedirector"));
-	}
+	Executor& executor = Executor::Default();
+	executor.Submit(_tasks, [StdInRedirector, stdin_param] { StdInRedirector(stdin_param); });
+	executor.Submit(_tasks, [StdOutRedirector, stdout_param] { StdOutRedirector(stdout_param); });
 }
 
 void SimpleCom::TerminalRedirectorBase::AwaitTermination()
 {
-	HANDLE objs[] = { _hThreadStdIn, _hThreadStdOut };
-	WaitForMultipleObjects(sizeof(objs) / sizeof(HANDLE), objs, TRUE, INFINITE);
+	_tasks.Await();
 }
 
 bool SimpleCom::TerminalRedirectorBase::Reattachable()
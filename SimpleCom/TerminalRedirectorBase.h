@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2025, Yasumasa Suenaga
+ * Copyright (C) 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "stdafx.h"
+#include "Executor.h"
 
 static constexpr int buf_sz = 256;
 
@@ -28,21 +29,28 @@ namespace SimpleCom
 	{
 	protected:
 		HANDLE _hSerial;
-		HANDLE _hThreadStdIn;
-		HANDLE _hThreadStdOut;
+
+		// Redirectors refer members of derived classes, so the derived destructor should finish them before the members are destroyed.
+		TaskGroup _tasks;
 
 		virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdInRedirector() = 0;
 		virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdOutRedirector() = 0;
 
 	public:
-		TerminalRedirectorBase(HANDLE hSerial) : _hSerial(hSerial), _hThreadStdIn(INVALID_HANDLE_VALUE), _hThreadStdOut(INVALID_HANDLE_VALUE) {};
+		TerminalRedirectorBase(HANDLE hSerial) : _hSerial(hSerial), _tasks() {};
 		virtual ~TerminalRedirectorBase() {};
 
+		// Redirectors would be run on workers of the default executor. Each of them occupies one worker until the session is finished.
 		virtual void StartRedirector();
 
 		virtual void AwaitTermination();
 
 		// Returns true if the peripheral is reattachable.
 		virtual bool Reattachable();
+
+		// Latency from StartRedirector() to the start of each redirector.
+		inline LatencyHistogram GetSchedulingLatency() {
+			return _tasks.GetSchedulingLatency();
+		}
 	};
 }
\ No newline at end of file
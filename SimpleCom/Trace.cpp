@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "Trace.h"
+#include "WinAPIException.h"
+#include "util.h"
+
+
+/*
+ * Ring buffer of trace events which is written by one thread only.
+ * Buffers are kept until the process exits, so they can be dumped after their threads are finished.
+ */
+typedef struct {
+	DWORD tid;
+	std::unique_ptr<SimpleCom::trace::TTraceEvent[]> events;
+	std::atomic<ULONGLONG> count;
+} TThreadTraceBuffer;
+
+static SRWLOCK registry_lock = SRWLOCK_INIT;
+static thread_local TThreadTraceBuffer* current_buffer = nullptr;
+
+static std::vector<std::unique_ptr<TThreadTraceBuffer>>& GetRegistry() {
+	static std::vector<std::unique_ptr<TThreadTraceBuffer>> registry;
+	return registry;
+}
+
+static TThreadTraceBuffer* RegisterCurrentThread() {
+	auto buffer = std::make_unique<TThreadTraceBuffer>();
+	buffer->tid = GetCurrentThreadId();
+	buffer->events = std::make_unique<SimpleCom::trace::TTraceEvent[]>(trace_buffer_events);
+	buffer->count.store(0, std::memory_order_relaxed);
+
+	TThreadTraceBuffer* result = buffer.get();
+	AcquireSRWLockExclusive(&registry_lock);
+	GetRegistry().push_back(std::move(buffer));
+	ReleaseSRWLockExclusive(&registry_lock);
+	return result;
+}
+
+void SimpleCom::trace::Record(const char* name, LONGLONG start, LONGLONG end) {
+	if (current_buffer == nullptr) {
+		current_buffer = RegisterCurrentThread();
+	}
+
+	ULONGLONG idx = current_buffer->count.load(std::memory_order_relaxed);
+	current_buffer->events[idx % trace_buffer_events] = { .name = name, .start = start, .end = end };
+	current_buffer->count.store(idx + 1, std::memory_order_release);
+}
+
+std::string SimpleCom::trace::FormatChromeTrace() {
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	double us_per_count = 1000000.0 / freq.QuadPart;
+	DWORD pid = GetCurrentProcessId();
+
+	std::string result = "{\"traceEvents\":[";
+	bool first = true;
+	char buf[256];
+
+	AcquireSRWLockShared(&registry_lock);
+	for (auto& buffer : GetRegistry()) {
+		// Events might be overwritten while they are formatted if the thread is still running.
+		ULONGLONG count = buffer->count.load(std::memory_order_acquire);
+		ULONGLONG idx = (count > trace_buffer_events) ? (count - trace_buffer_events) : 0;
+		for (; idx < count; idx++) {
+			const TTraceEvent& event = buffer->events[idx % trace_buffer_events];
+			snprintf(buf, sizeof(buf), "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%lu}",
+				first ? "" : ",", event.name, event.start * us_per_count, (event.end - event.start) * us_per_count, pid, buffer->tid);
+			result += buf;
+			first = false;
+		}
+	}
+	ReleaseSRWLockShared(&registry_lock);
+
+	result += "\n]}\n";
+	return result;
+}
+
+void SimpleCom::trace::Dump(LPCTSTR filename) {
+	std::string json = FormatChromeTrace();
+
+	HandleHandler hFile(CreateFile(filename, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr), _T("CreateFile for trace"));
+	DWORD nBytesWritten;
+	if (!WriteFile(hFile.handle(), json.c_str(), static_cast<DWORD>(json.length()), &nBytesWritten, nullptr)) {
+		throw WinAPIException(GetLastError(), _T("WriteFile for trace"));
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+// Number of events which are kept per thread. Older events would be overwritten.
+static constexpr DWORD trace_buffer_events = 16384;
+
+/*
+ * TRACE_SCOPE records the time from the declaration to the end of the scope.
+ * TRACE_INSTANT records the event which does not have duration.
+ * Trace points are compiled in debug build, or release build with SIMPLECOM_TRACE. Otherwise they are removed completely.
+ */
+#if defined(_DEBUG) || defined(SIMPLECOM_TRACE)
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) SimpleCom::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#define TRACE_INSTANT(name) { LONGLONG trace_now = SimpleCom::trace::Now(); SimpleCom::trace::Record(name, trace_now, trace_now); }
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_INSTANT(name)
+#endif
+
+namespace SimpleCom {
+
+	namespace trace {
+
+		typedef struct {
+			const char* name;
+			LONGLONG start;  // QueryPerformanceCounter()
+			LONGLONG end;
+		} TTraceEvent;
+
+		// Record the event into the ring buffer of current thread. name should be a string literal because only the pointer is kept.
+		void Record(const char* name, LONGLONG start, LONGLONG end);
+
+		inline LONGLONG Now() {
+			LARGE_INTEGER counter;
+			QueryPerformanceCounter(&counter);
+			return counter.QuadPart;
+		}
+
+		class Scope
+		{
+		private:
+			const char* _name;
+			LONGLONG _start;
+
+		public:
+			Scope(const char* name) : _name(name), _start(Now()) {};
+			~Scope() {
+				Record(_name, _start, Now());
+			}
+		};
+
+		// Events of all threads in Chrome trace JSON format which can be loaded into chrome://tracing or Perfetto.
+		std::string FormatChromeTrace();
+
+		void Dump(LPCTSTR filename);
+
+	}
+
+}
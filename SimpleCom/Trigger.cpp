@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "Trigger.h"
+#include "ScriptTokenizer.h"
+#include "util.h"
+#include "WinAPIException.h"
+#include "debug.h"
+
+static constexpr LPCTSTR TRIGGER_ENV_NAME = _T("SIMPLECOM_TRIGGER");
+
+
+static std::vector<std::string> CollectPatterns(const SimpleCom::TriggerSet& triggers) {
+	std::vector<std::string> patterns;
+	for (auto& trigger : triggers.GetTriggers()) {
+		patterns.push_back(trigger.pattern);
+	}
+	return patterns;
+}
+
+/*
+ * Patterns are expected to be ASCII, so they are converted char by char.
+ */
+static TString ToTString(const std::string& str) {
+	return TString(str.begin(), str.end());
+}
+
+std::string SimpleCom::FormatLogMarker(const SYSTEMTIME& timestamp, const std::string& kind, const std::string& detail) {
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+		timestamp.wYear, timestamp.wMonth, timestamp.wDay, timestamp.wHour, timestamp.wMinute, timestamp.wSecond, timestamp.wMilliseconds);
+	return "\r\n[SimpleCom " + std::string(buf) + "] " + kind + ": " + detail + "\r\n";
+}
+
+SimpleCom::TriggerSet::TriggerSet(const std::string& source) : _triggers() {
+	std::istringstream stream(source);
+	std::string line;
+	int line_num = 0;
+
+	while (std::getline(stream, line)) {
+		line_num++;
+		std::vector<TScriptToken> tokens = TokenizeScriptLine(line, line_num);
+		if (tokens.empty()) {
+			continue;
+		}
+
+		if (tokens[0].quoted || tokens[0].text != "on") {
+			ThrowScriptSyntaxError(line_num, "Trigger should start with `on`");
+		}
+		if (tokens.size() < 3 || !tokens[1].quoted || tokens[1].text.empty() || tokens[2].quoted) {
+			ThrowScriptSyntaxError(line_num, "Trigger should be `on \"pattern\" <action> [argument]`");
+		}
+
+		TTrigger trigger = { .pattern = tokens[1].text, .argument = "", .line = line_num };
+		const std::string& action = tokens[2].text;
+		if (action == "mark" || action == "alert") {
+			if (tokens.size() != 3) {
+				ThrowScriptSyntaxError(line_num, action + " does not accept any argument");
+			}
+			trigger.action = (action == "mark") ? TriggerAction::MARK : TriggerAction::ALERT;
+		}
+		else if (action == "send" || action == "exec") {
+			if (tokens.size() != 4 || !tokens[3].quoted || tokens[3].text.empty()) {
+				ThrowScriptSyntaxError(line_num, action + " needs one string");
+			}
+			trigger.action = (action == "send") ? TriggerAction::SEND : TriggerAction::EXEC;
+			trigger.argument = tokens[3].text;
+		}
+		else if (action == "baud") {
+			if ((tokens.size() != 4) || (ParseScriptNumber(tokens[3], line_num) == 0)) {
+				ThrowScriptSyntaxError(line_num, "baud needs baud rate");
+			}
+			trigger.action = TriggerAction::BAUD;
+			trigger.argument = tokens[3].text;
+		}
+		else {
+			ThrowScriptSyntaxError(line_num, "Unknown action: " + action);
+		}
+
+		_triggers.push_back(trigger);
+	}
+}
+
+SimpleCom::TriggerSet SimpleCom::TriggerSet::FromFile(LPCTSTR filename) {
+	return TriggerSet(ReadWholeFile(filename));
+}
+
+SimpleCom::TriggerEngine::TriggerEngine(const TriggerSet& triggers, SerialHandle& serial, LogMarkerQueue* log_markers, const TString& title) :
+	_triggers(triggers),
+	_matcher(CollectPatterns(triggers)),
+	_serial(serial),
+	_log_markers(log_markers),
+	_title(title),
+	_events(),
+	_fired(0),
+	_line_config(nullptr),
+	_tasks()
+{
+	_hEventAvailable = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (_hEventAvailable == NULL) {
+		throw WinAPIException(GetLastError(), _T("CreateEvent for TriggerEngine"));
+	}
+	_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_hStopEvent == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_hEventAvailable);
+		throw WinAPIException(error, _T("CreateEvent for TriggerEngine"));
+	}
+}
+
+SimpleCom::TriggerEngine::~TriggerEngine() {
+	Stop();
+	CloseHandle(_hStopEvent);
+	CloseHandle(_hEventAvailable);
+}
+
+void SimpleCom::TriggerEngine::Scan(const char* data, const DWORD len, const ULONGLONG seq) {
+	_matcher.Feed(data, len, [&](const int pattern_id, const DWORD end) {
+		Fire(pattern_id, seq + end);
+		return true;
+	});
+}
+
+void SimpleCom::TriggerEngine::Fire(int trigger_id, ULONGLONG seq) {
+	const TTrigger& trigger = _triggers.GetTriggers()[trigger_id];
+	TTriggerEvent event = { .trigger_id = trigger_id, .seq = seq };
+	GetLocalTime(&event.timestamp);
+	_fired.fetch_add(1, std::memory_order_relaxed);
+
+	if (trigger.action == TriggerAction::MARK) {
+		// Marker should be queued before the data is committed to the ring,
+		// then the log sink can write it at the exact position.
+		if (_log_markers != nullptr) {
+			_log_markers->Push(seq, FormatLogMarker(event.timestamp, "trigger", trigger.pattern));
+		}
+		return;
+	}
+
+	_events.push(event);
+	SetEvent(_hEventAvailable);
+}
+
+void SimpleCom::TriggerEngine::Perform(const TTriggerEvent& event, SerialPortWriter& writer) {
+	const TTrigger& trigger = _triggers.GetTriggers()[event.trigger_id];
+
+	switch (trigger.action) {
+	case TriggerAction::ALERT: {
+		TString title = _title + _T(" [") + ToTString(trigger.pattern) + _T("]");
+		CALL_WINAPI_WITH_LOG(SetConsoleTitle(title.c_str()), TRUE)
+
+		HWND hwnd = GetConsoleWindow();
+		if (hwnd != NULL) {
+			FLASHWINFO flash_info = {
+				.cbSize = sizeof(FLASHWINFO),
+				.hwnd = hwnd,
+				.dwFlags = FLASHW_ALL | FLASHW_TIMERNOFG,
+				.uCount = 0,
+				.dwTimeout = 0
+			};
+			FlashWindowEx(&flash_info);
+		}
+		break;
+	}
+
+	case TriggerAction::SEND:
+		// trigger.argument is alive until the trigger set is discarded, so it can be written asynchronously.
+		writer.PutData(trigger.argument.c_str(), static_cast<int>(trigger.argument.length()));
+		break;
+
+	case TriggerAction::EXEC: {
+		TString cmdline = ToTString(trigger.argument);
+		STARTUPINFO si = { .cb = sizeof(STARTUPINFO) };
+		PROCESS_INFORMATION pi = { 0 };
+
+		// Child process inherits environment variables of SimpleCom. Only this thread updates it.
+		CALL_WINAPI_WITH_LOG(SetEnvironmentVariable(TRIGGER_ENV_NAME, ToTString(trigger.pattern).c_str()), TRUE)
+		if (!CreateProcess(nullptr, cmdline.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW | CREATE_NEW_PROCESS_GROUP, nullptr, nullptr, &si, &pi)) {
+			throw WinAPIException(GetLastError(), _T("CreateProcess for trigger"));
+		}
+
+		// SimpleCom does not wait for the command.
+		CloseHandle(pi.hThread);
+		CloseHandle(pi.hProcess);
+		break;
+	}
+
+	case TriggerAction::BAUD:
+		if (_line_config == nullptr) {
+			throw WinAPIException(_T("TriggerEngine"), _T("Reconfiguration is not available"));
+		}
+		// Data which is sent by former actions is drained before the baud rate is changed.
+		_line_config->SetBaudRate(std::stoul(trigger.argument));
+		break;
+
+	case TriggerAction::MARK:
+		// Performed in Fire()
+		break;
+	}
+}
+
+void SimpleCom::TriggerEngine::Start() {
+	Executor::Default().Submit(_tasks, [this] { Run(); });
+}
+
+void SimpleCom::TriggerEngine::Run() {
+	HANDLE waiters[] = { _hEventAvailable, _hStopEvent };
+
+	// Only PutData() is used, so the writer does not need its own buffer.
+	SerialPortWriter writer(_serial, 1);
+
+	while (WaitForMultipleObjects(sizeof(waiters) / sizeof(HANDLE), waiters, FALSE, INFINITE) == WAIT_OBJECT_0) {
+		TTriggerEvent event;
+		while (_events.try_pop(event)) {
+			try {
+				Perform(event, writer);
+			}
+			catch (WinAPIException& e) {
+				// Failure of the action should not affect the session.
+				debug::log(LogLevel::WARN, _T("{}"), e.GetErrorText());
+			}
+		}
+	}
+}
+
+void SimpleCom::TriggerEngine::Stop() {
+	SetEvent(_hStopEvent);
+	_tasks.Await();
+}
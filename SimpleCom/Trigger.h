@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "MultiPatternMatcher.h"
+#include "LogWriter.h"
+#include "SerialPortWriter.h"
+#include "LineConfig.h"
+#include "Executor.h"
+
+namespace SimpleCom {
+
+	/*
+	 * Action of the trigger.
+	 *   MARK:  Write timestamped marker into the log file just after the pattern.
+	 *   ALERT: Flash the console window, and show the pattern on the title bar.
+	 *   SEND:  Send bytes to the peripheral.
+	 *   EXEC:  Run a local command. The pattern is passed via SIMPLECOM_TRIGGER environment variable.
+	 *   BAUD:  Change baud rate without reopening the port (e.g. bootloader switches the speed).
+	 */
+	enum class TriggerAction {
+		MARK,
+		ALERT,
+		SEND,
+		EXEC,
+		BAUD
+	};
+
+	typedef struct {
+		std::string pattern;
+		TriggerAction action;
+		std::string argument;
+		int line;
+	} TTrigger;
+
+	/*
+	 * Set of triggers which is loaded from trigger file.
+	 * Each line has one trigger:
+	 *
+	 *   on "pattern" mark
+	 *   on "pattern" alert
+	 *   on "pattern" send "bytes"
+	 *   on "pattern" exec "command line"
+	 *   on "pattern" baud <rate>
+	 *
+	 * Syntax of strings and comments is same as script for --script.
+	 * std::invalid_argument would be thrown if the file has syntax error.
+	 */
+	class TriggerSet
+	{
+	private:
+		std::vector<TTrigger> _triggers;
+
+	public:
+		TriggerSet(const std::string& source);
+		virtual ~TriggerSet() {};
+
+		static TriggerSet FromFile(LPCTSTR filename);
+
+		inline const std::vector<TTrigger>& GetTriggers() const noexcept {
+			return _triggers;
+		}
+	};
+
+	typedef struct {
+		int trigger_id;
+		ULONGLONG seq;
+		SYSTEMTIME timestamp;
+	} TTriggerEvent;
+
+	/*
+	 * Runs triggers in the serial session.
+	 * Patterns of all triggers are compiled into one matcher, and Scan() runs it inline on each chunk from the serial port.
+	 * Actions excepting MARK are performed on the worker of the executor, so the reader would not be blocked by them.
+	 */
+	class TriggerEngine
+	{
+	private:
+		const TriggerSet& _triggers;
+		MultiPatternMatcher _matcher;
+		SerialHandle& _serial;
+		LogMarkerQueue* _log_markers;
+		TString _title;
+		concurrency::concurrent_queue<TTriggerEvent> _events;
+		HANDLE _hEventAvailable;
+		HANDLE _hStopEvent;
+		std::atomic<ULONGLONG> _fired;
+		LineConfigurator* _line_config;
+		TaskGroup _tasks;
+
+		void Fire(int trigger_id, ULONGLONG seq);
+		void Perform(const TTriggerEvent& event, SerialPortWriter& writer);
+
+	public:
+		// log_markers can be nullptr if logging is not enabled. title is base string of the console title for ALERT.
+		TriggerEngine(const TriggerSet& triggers, SerialHandle& serial, LogMarkerQueue* log_markers, const TString& title);
+		virtual ~TriggerEngine();
+
+		// Scan data which starts at seq in the RX stream. This is called on the reader thread.
+		void Scan(const char* data, const DWORD len, const ULONGLONG seq);
+
+		// BAUD would be performed via this configurator. This should be called before Start().
+		inline void SetLineConfigurator(LineConfigurator* line_config) {
+			_line_config = line_config;
+		}
+
+		void Start();
+		void Run();
+		void Stop();
+
+		inline ULONGLONG GetFiredCount() const noexcept {
+			return _fired.load(std::memory_order_relaxed);
+		}
+	};
+
+	// Format marker for the log. It starts and ends with CRLF to be a line.
+	std::string FormatLogMarker(const SYSTEMTIME& timestamp, const std::string& kind, const std::string& detail);
+
+}
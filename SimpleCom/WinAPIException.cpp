@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2019, 2024, Yasumasa Suenaga
+ * Copyright (C) 2019, 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -32,9 +32,7 @@ SimpleCom::WinAPIException::WinAPIException(DWORD error_code, LPCTSTR error_capt
 		DWORD errcode = GetLastError();
 		error_msg << _T("Error occured (") << std::showbase << std::hex << _error_code << _T(")");
 
-		TStringStream msg;
-		msg << _T("Error occurred in FormatMessage (") << std::showbase << std::hex << errcode << _T(")");
-		debug::log(msg.str().c_str());
+		debug::log(LogLevel::WARN, _T("Error occurred in FormatMessage ({})"), debug::Hex(errcode));
 	}
 	else {
 		error_msg << buf << _T(" (") << std::showbase << std::hex << _error_code << _T(")");
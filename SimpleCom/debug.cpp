@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021, Yasumasa Suenaga
+ * Copyright (C) 2021, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -20,16 +20,205 @@
 #include "stdafx.h"
 
 #include "debug.h"
+#include "WinAPIException.h"
 
-void SimpleCom::debug::log(LPCTSTR message) {
-#ifdef _DEBUG
+/*
+ * State of the sink. This is never freed because messages might be logged until the process exits.
+ */
+typedef struct {
+	concurrency::concurrent_queue<SimpleCom::debug::TLogRecord> queue;
+	HANDLE hWakeEvent;
+	HANDLE hThread;
+	SRWLOCK sink_lock;
+	SimpleCom::debug::TLogSink sink;
+} TLogSinkContext;
+
+static INIT_ONCE sink_init_once = INIT_ONCE_STATIC_INIT;
+static TLogSinkContext* sink_context = nullptr;
+
+static LPCTSTR LevelToString(int level) {
+	for (auto& value : SimpleCom::LogLevel::values) {
+		if (value == level) {
+			return value.tstr();
+		}
+	}
+	return _T("unknown");
+}
+
+static void WriteToStdErr(const TString& message) {
 #ifdef _UNICODE
-	std::wcerr.imbue(std::locale(""));
 	std::wcerr
 #else
-	std::cerr.imbue(std::locale(""));
 	std::cerr
 #endif
-		<< _T("SimpleCom DEBUG: ") << message << std::endl;
+		<< message << std::endl;
+}
+
+static TString FormatArg(const SimpleCom::debug::TLogArg& arg) {
+	TStringStream ss;
+	switch (arg.type) {
+	case SimpleCom::debug::LogArgType::INT:
+		ss << arg.i;
+		break;
+	case SimpleCom::debug::LogArgType::UINT:
+		ss << arg.u;
+		break;
+	case SimpleCom::debug::LogArgType::HEX:
+		ss << std::showbase << std::hex << arg.u;
+		break;
+	case SimpleCom::debug::LogArgType::DOUBLE:
+		ss << arg.d;
+		break;
+	case SimpleCom::debug::LogArgType::TSTR:
+		ss << arg.tstr;
+		break;
+	case SimpleCom::debug::LogArgType::STR:
+		// Only ASCII is expected (e.g. __FILE__), so it is converted char by char.
+		ss << TString(arg.str, arg.str + strlen(arg.str));
+		break;
+	case SimpleCom::debug::LogArgType::OWNED_TSTR:
+		ss << *arg.owned;
+		break;
+	case SimpleCom::debug::LogArgType::WIN32_ERROR:
+		ss << SimpleCom::WinAPIException(arg.error).GetErrorText();
+		break;
+	}
+	return ss.str();
+}
+
+TString SimpleCom::debug::Format(const TLogRecord& record) {
+	TString result;
+	int arg_idx = 0;
+
+	for (LPCTSTR ch = record.format; *ch != 0; ch++) {
+		if ((ch[0] == _T('{')) && (ch[1] == _T('}')) && (arg_idx < record.n_args)) {
+			result += FormatArg(record.args[arg_idx++]);
+			ch++;
+		}
+		else {
+			result += *ch;
+		}
+	}
+
+	return result;
+}
+
+static void WriteRecord(TLogSinkContext* context, SimpleCom::debug::TLogRecord& record) {
+	if (record.hFlushEvent != NULL) {
+		SetEvent(record.hFlushEvent);
+		return;
+	}
+
+	FILETIME local_time;
+	SYSTEMTIME timestamp;
+	FileTimeToLocalFileTime(&record.timestamp, &local_time);
+	FileTimeToSystemTime(&local_time, &timestamp);
+
+	TCHAR prefix[64];
+	_sntprintf_s(prefix, _TRUNCATE, _T("SimpleCom %s %02d:%02d:%02d.%03d [%lu]: "),
+		LevelToString(record.level), timestamp.wHour, timestamp.wMinute, timestamp.wSecond, timestamp.wMilliseconds, record.tid);
+	TString message = prefix + SimpleCom::debug::Format(record);
+
+	for (int idx = 0; idx < record.n_args; idx++) {
+		if (record.args[idx].type == SimpleCom::debug::LogArgType::OWNED_TSTR) {
+			delete record.args[idx].owned;
+		}
+	}
+
+	AcquireSRWLockShared(&context->sink_lock);
+	if (context->sink) {
+		context->sink(message);
+	}
+	else {
+		WriteToStdErr(message);
+	}
+	ReleaseSRWLockShared(&context->sink_lock);
+}
+
+static void Drain(TLogSinkContext* context) {
+	SimpleCom::debug::TLogRecord record;
+	while (context->queue.try_pop(record)) {
+		WriteRecord(context, record);
+	}
+}
+
+/*
+ * Entry point for the sink thread. The sink wakes up periodically, so loggers do not need to signal it.
+ */
+static DWORD WINAPI LogSinkEntry(_In_ LPVOID lpParameter) {
+	TLogSinkContext* context = reinterpret_cast<TLogSinkContext*>(lpParameter);
+	while (true) {
+		WaitForSingleObject(context->hWakeEvent, log_sink_interval_ms);
+		Drain(context);
+	}
+	return 0;
+}
+
+static void FlushOnExit() {
+	SimpleCom::debug::Flush();
+}
+
+static BOOL CALLBACK InitSink(PINIT_ONCE InitOnce, PVOID Parameter, PVOID* Context) {
+	TLogSinkContext* context = new TLogSinkContext();
+	InitializeSRWLock(&context->sink_lock);
+	context->hThread = NULL;
+
+	// Messages would be written on the caller thread if the sink thread is not available.
+	context->hWakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (context->hWakeEvent != NULL) {
+		context->hThread = CreateThread(NULL, 0, &LogSinkEntry, context, 0, NULL);
+	}
+
+#ifdef _UNICODE
+	std::wcerr.imbue(std::locale(""));
+#else
+	std::cerr.imbue(std::locale(""));
 #endif
-}
\ No newline at end of file
+
+	sink_context = context;
+	atexit(&FlushOnExit);
+	return TRUE;
+}
+
+static TLogSinkContext* GetSinkContext() {
+	InitOnceExecuteOnce(&sink_init_once, &InitSink, nullptr, nullptr);
+	return sink_context;
+}
+
+void SimpleCom::debug::Enqueue(TLogRecord& record) {
+	TLogSinkContext* context = GetSinkContext();
+	context->queue.push(record);
+	if (context->hThread == NULL) {
+		Drain(context);
+	}
+}
+
+void SimpleCom::debug::Flush() {
+	HANDLE hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (hEvent == NULL) {
+		return;
+	}
+
+	TLogRecord record = {
+		.level = static_cast<int>(LogLevel::NONE),
+		.tid = GetCurrentThreadId(),
+		.format = _T(""),
+		.n_args = 0,
+		.hFlushEvent = hEvent
+	};
+	Enqueue(record);
+
+	TLogSinkContext* context = GetSinkContext();
+	if (context->hThread != NULL) {
+		SetEvent(context->hWakeEvent);
+		WaitForSingleObject(hEvent, INFINITE);
+	}
+	CloseHandle(hEvent);
+}
+
+void SimpleCom::debug::SetSink(TLogSink sink) {
+	TLogSinkContext* context = GetSinkContext();
+	AcquireSRWLockExclusive(&context->sink_lock);
+	context->sink = sink;
+	ReleaseSRWLockExclusive(&context->sink_lock);
+}
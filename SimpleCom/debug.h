@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2021, Yasumasa Suenaga
+ * Copyright (C) 2021, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -19,22 +19,169 @@
 #pragma once
 
 #include "stdafx.h"
+#include "EnumValue.h"
 
-#define CALL_WINAPI_WITH_DEBUGLOG(func_call, expected, file, line)              \
-  if (func_call != expected) {                                                  \
-    SimpleCom::WinAPIException e(GetLastError());                               \
-    TStringStream ss;                                                           \
-    ss << file << _T(":") << line << _T(": ") << e.GetErrorText() << std::endl; \
-    SimpleCom::debug::log(ss.str().c_str());                                    \
+// Maximum number of arguments of one log message.
+static constexpr int log_max_args = 4;
+
+// Interval to write queued messages by the sink thread.
+static constexpr DWORD log_sink_interval_ms = 50;
+
+/*
+ * Log the error (GetLastError()) with file and line if func_call does not return expected value.
+ * Error message would be retrieved by FormatMessage() on the sink thread.
+ */
+#define CALL_WINAPI_WITH_LOG(func_call, expected)                                              \
+  if ((func_call) != (expected)) {                                                             \
+    SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("{}:{}: {}"), __FILE__, __LINE__,      \
+                          SimpleCom::debug::TWin32Error{ GetLastError() });                    \
   }
 
 namespace SimpleCom {
 
     namespace debug {
 
-        // Print debug message to the console if the binary is debug build
-        void log(LPCTSTR message);
+        // Win32 error code which would be formatted as the message from FormatMessage().
+        typedef struct {
+            DWORD code;
+        } TWin32Error;
+
+        enum class LogArgType {
+            INT,
+            UINT,
+            HEX,
+            DOUBLE,
+            TSTR,         // static string
+            STR,          // static string (char), e.g. __FILE__
+            OWNED_TSTR,   // copied string, it would be freed by the sink
+            WIN32_ERROR
+        };
+
+        typedef struct {
+            LogArgType type;
+            union {
+                LONGLONG i;
+                ULONGLONG u;
+                double d;
+                LPCTSTR tstr;
+                const char* str;
+                TString* owned;
+                DWORD error;
+            };
+        } TLogArg;
+
+        /*
+         * Log message in the queue.
+         * format should be a string literal because only the pointer is kept. `{}` in it would be replaced with args in order.
+         */
+        typedef struct {
+            int level;
+            DWORD tid;
+            FILETIME timestamp;
+            LPCTSTR format;
+            int n_args;
+            TLogArg args[log_max_args];
+            HANDLE hFlushEvent;  // not NULL if this is a flush request
+        } TLogRecord;
+
+        // Function to write formatted message. Default sink writes to stderr.
+        typedef std::function<void(const TString& message)> TLogSink;
+
+        // Initialized with raw values because LogLevel instances might not be initialized yet.
+#ifdef _DEBUG
+        inline std::atomic<int> current_level{ 4 };  // LogLevel::DBG
+#else
+        inline std::atomic<int> current_level{ 0 };  // LogLevel::NONE
+#endif
+
+        inline bool IsEnabled(const LogLevel& level) {
+            return static_cast<int>(level) <= current_level.load(std::memory_order_relaxed);
+        }
+
+        inline void SetLevel(const LogLevel& level) {
+            current_level.store(static_cast<int>(level), std::memory_order_relaxed);
+        }
+
+        template <typename T> TLogArg MakeLogArg(const T& value) {
+            TLogArg arg;
+            if constexpr (std::is_same_v<T, TLogArg>) {
+                arg = value;
+            }
+            else if constexpr (std::is_same_v<T, TWin32Error>) {
+                arg.type = LogArgType::WIN32_ERROR;
+                arg.error = value.code;
+            }
+            else if constexpr (std::is_same_v<T, TString>) {
+                arg.type = LogArgType::OWNED_TSTR;
+                arg.owned = new TString(value);
+            }
+            else if constexpr (std::is_convertible_v<T, LPCTSTR>) {
+                arg.type = LogArgType::TSTR;
+                arg.tstr = value;
+            }
+            else if constexpr (std::is_convertible_v<T, const char*>) {
+                arg.type = LogArgType::STR;
+                arg.str = value;
+            }
+            else if constexpr (std::is_floating_point_v<T>) {
+                arg.type = LogArgType::DOUBLE;
+                arg.d = value;
+            }
+            else if constexpr (std::is_signed_v<T>) {
+                arg.type = LogArgType::INT;
+                arg.i = value;
+            }
+            else if constexpr (std::is_unsigned_v<T>) {
+                arg.type = LogArgType::UINT;
+                arg.u = value;
+            }
+            else {
+                static_assert(sizeof(T) == 0, "Unsupported type for log argument");
+            }
+            return arg;
+        }
+
+        // Unsigned value which would be formatted in hex.
+        inline TLogArg Hex(ULONGLONG value) {
+            TLogArg arg;
+            arg.type = LogArgType::HEX;
+            arg.u = value;
+            return arg;
+        }
+
+        void Enqueue(TLogRecord& record);
+
+        // Format the message. OWNED_TSTR args would not be freed.
+        TString Format(const TLogRecord& record);
+
+        /*
+         * Queue the message if the level is enabled. Formatting would be performed on the sink thread,
+         * so the caller pays only for the check of the level and the copy of args.
+         */
+        template <typename... Args> void log(const LogLevel& level, LPCTSTR format, const Args&... args) {
+            static_assert(sizeof...(Args) <= log_max_args, "Too many arguments for log");
+            if (!IsEnabled(level)) {
+                return;
+            }
+
+            TLogRecord record = {
+                .level = static_cast<int>(level),
+                .tid = GetCurrentThreadId(),
+                .format = format,
+                .n_args = static_cast<int>(sizeof...(Args)),
+                .args = { MakeLogArg(args)... },
+                .hFlushEvent = NULL
+            };
+            GetSystemTimeAsFileTime(&record.timestamp);
+            Enqueue(record);
+        }
+
+        // Wait until all of queued messages are written.
+        void Flush();
+
+        // Replace the sink. nullptr restores the default sink. This should be called while no message is logged.
+        void SetSink(TLogSink sink);
 
     }
 
-}
\ No newline at end of file
+}
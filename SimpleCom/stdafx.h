@@ -19,8 +19,12 @@
 
 #include <tchar.h>
 
+#include <atomic>
+#include <deque>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <memory>
 #include <vector>
 #include <regex>
 #include <sstream>
@@ -28,6 +32,7 @@
 #include <codecvt>
 #include <concurrent_queue.h>
 #include <functional>
+#include <coroutine>
 
 #ifdef _UNICODE
 typedef std::wstring TString;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024, 2025, Yasumasa Suenaga
+ * Copyright (C) 2024, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -87,4 +87,22 @@ LPCTSTR ProductInfo::GetLegalCopyright() {
 	// Neutral codepage (000004b0)
 	LPCTSTR query_result = GetString(_T("\\StringFileInfo\\000004b0\\LegalCopyright"));
 	return query_result ? query_result : _T("Copyright (C) Yasumasa Suenaga");
-}
\ No newline at end of file
+}
+
+std::string ReadWholeFile(LPCTSTR filename) {
+	HandleHandler hFile(CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr), _T("Open file"));
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(hFile.handle(), &file_size)) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("GetFileSizeEx for reading whole file"));
+	}
+
+	std::string source(static_cast<size_t>(file_size.QuadPart), '\0');
+	DWORD nBytesRead;
+	if (!ReadFile(hFile.handle(), source.data(), static_cast<DWORD>(source.length()), &nBytesRead, nullptr)) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("ReadFile for reading whole file"));
+	}
+	source.resize(nBytesRead);
+
+	return source;
+}
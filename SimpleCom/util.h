@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2025, Yasumasa Suenaga
+ * Copyright (C) 2023, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -97,4 +97,9 @@ public:
       return exe_path;
     }
 
-};
\ No newline at end of file
+};
+
+/*
+ * Read whole of the file as bytes.
+ */
+std::string ReadWholeFile(LPCTSTR filename);
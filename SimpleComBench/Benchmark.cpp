@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "Benchmark.h"
+#include "SerialPortWriter.h"
+#include "WinAPIException.h"
+
+// Chunk size which the peer writes at once.
+static constexpr DWORD peer_chunk_sz = 4096;
+
+
+static DWORD WINAPI ReaderEntry(_In_ LPVOID lpParameter) {
+	SimpleComBench::PipelineBench* bench = reinterpret_cast<SimpleComBench::PipelineBench*>(lpParameter);
+	bench->RunReader();
+	return 0;
+}
+
+static DWORD WINAPI PeerEntry(_In_ LPVOID lpParameter) {
+	SimpleComBench::PipelineBench* bench = reinterpret_cast<SimpleComBench::PipelineBench*>(lpParameter);
+	bench->RunPeer();
+	return 0;
+}
+
+static ULONGLONG GetProcessCPUTimeIn100ns() {
+	FILETIME creation_time, exit_time, kernel_time, user_time;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("GetProcessTimes"));
+	}
+
+	ULONGLONG kernel = (static_cast<ULONGLONG>(kernel_time.dwHighDateTime) << 32) | kernel_time.dwLowDateTime;
+	ULONGLONG user = (static_cast<ULONGLONG>(user_time.dwHighDateTime) << 32) | user_time.dwLowDateTime;
+	return kernel + user;
+}
+
+SimpleComBench::PipelineBench::PipelineBench(DWORD baud_rate, DWORD read_buf_sz, HANDLE hOutput) :
+	_port(baud_rate),
+	_pipeline(hOutput, nullptr),
+	_read_buf_sz(read_buf_sz),
+	_overlapped({ 0 }),
+	_hReader(NULL),
+	_expected(0),
+	_delivered(0),
+	_stop(false),
+	_peer(),
+	_exception_queue()
+{
+	_overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (_overlapped.hEvent == NULL) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateEvent for reader"));
+	}
+	_hDelivered = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (_hDelivered == NULL) {
+		DWORD error = GetLastError();
+		CloseHandle(_overlapped.hEvent);
+		throw SimpleCom::WinAPIException(error, _T("CreateEvent for probe"));
+	}
+
+	// Probe is a consumer as well as the output, so the latency is measured until the data is delivered to sinks of the RX pipeline.
+	_pipeline.ring().Subscribe([this](const char* data, const DWORD len) {
+		ULONGLONG delivered = _delivered.fetch_add(len, std::memory_order_acq_rel) + len;
+		if (delivered >= _expected.load(std::memory_order_acquire)) {
+			SetEvent(_hDelivered);
+		}
+	}, SimpleCom::OverflowPolicy::BLOCK);
+
+	_pipeline.SetExceptionHandler([this](const SimpleCom::WinAPIException& e) {
+		_exception_queue.push(e);
+		SetEvent(_hDelivered);
+	});
+}
+
+SimpleComBench::PipelineBench::~PipelineBench() {
+	if (_hReader != NULL) {
+		// The reader might issue ReadFile() again after CancelIoEx(), so it should be repeated until the reader finishes.
+		_stop.store(true, std::memory_order_release);
+		while (WaitForSingleObject(_hReader, 10) == WAIT_TIMEOUT) {
+			CancelIoEx(_port.port(), &_overlapped);
+		}
+		CloseHandle(_hReader);
+	}
+	_pipeline.Shutdown();
+	CloseHandle(_hDelivered);
+	CloseHandle(_overlapped.hEvent);
+}
+
+void SimpleComBench::PipelineBench::Start() {
+	_pipeline.Start();
+	_hReader = CreateThread(NULL, 0, &ReaderEntry, this, 0, NULL);
+	if (_hReader == NULL) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateThread for reader"));
+	}
+}
+
+void SimpleComBench::PipelineBench::RunReader() {
+	try {
+		while (!_stop.load(std::memory_order_acquire)) {
+			DWORD available;
+			char* buf = _pipeline.Claim(_read_buf_sz, &available);
+			if (buf == nullptr) {
+				return;
+			}
+
+			DWORD nBytesRead;
+			if (!ReadFile(_port.port(), buf, available, &nBytesRead, &_overlapped)) {
+				if (GetLastError() != ERROR_IO_PENDING) {
+					throw SimpleCom::WinAPIException(GetLastError(), _T("ReadFile from loopback port"));
+				}
+				if (!GetOverlappedResult(_port.port(), &_overlapped, &nBytesRead, TRUE)) {
+					if (GetLastError() == ERROR_OPERATION_ABORTED) {
+						return;
+					}
+					throw SimpleCom::WinAPIException(GetLastError(), _T("GetOverlappedResult for ReadFile"));
+				}
+			}
+
+			_pipeline.Commit(buf, nBytesRead);
+		}
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		_exception_queue.push(e);
+		SetEvent(_hDelivered);
+	}
+}
+
+void SimpleComBench::PipelineBench::RunPeer() {
+	try {
+		_peer();
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		// ERROR_OPERATION_ABORTED would be reported by StopPeer().
+		if (e.GetErrorCode() != ERROR_OPERATION_ABORTED) {
+			_exception_queue.push(e);
+			SetEvent(_hDelivered);
+		}
+	}
+}
+
+HANDLE SimpleComBench::PipelineBench::StartPeer(std::function<void()> peer) {
+	_peer = peer;
+	HANDLE hPeer = CreateThread(NULL, 0, &PeerEntry, this, 0, NULL);
+	if (hPeer == NULL) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateThread for peer"));
+	}
+	return hPeer;
+}
+
+void SimpleComBench::PipelineBench::StopPeer(HANDLE hPeer) {
+	// The peer might not be in I/O at CancelSynchronousIo(), so it should be repeated until the peer finishes.
+	while (WaitForSingleObject(hPeer, 10) == WAIT_TIMEOUT) {
+		CancelSynchronousIo(hPeer);
+	}
+	CloseHandle(hPeer);
+}
+
+void SimpleComBench::PipelineBench::AwaitDelivered(ULONGLONG expected) {
+	_expected.store(expected, std::memory_order_release);
+
+	// Probe might see all of data before _expected is updated.
+	while (_delivered.load(std::memory_order_acquire) < expected) {
+		if (WaitForSingleObject(_hDelivered, 1000) == WAIT_FAILED) {
+			throw SimpleCom::WinAPIException(GetLastError(), _T("WaitForSingleObject for probe"));
+		}
+
+		SimpleCom::WinAPIException e;
+		if (_exception_queue.try_pop(e)) {
+			throw e;
+		}
+	}
+}
+
+SimpleComBench::TThroughputResult SimpleComBench::PipelineBench::MeasureThroughput(ULONGLONG bytes) {
+	// Printable chars with line breaks like boot log.
+	std::string chunk;
+	while (chunk.length() < peer_chunk_sz) {
+		chunk += "[    1.234567] usb 1-1: new high-speed USB device number 2 using xhci_hcd\r\n";
+	}
+
+	ULONGLONG cpu_start = GetProcessCPUTimeIn100ns();
+	LARGE_INTEGER freq, start, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&start);
+
+	HANDLE hPeer = StartPeer([&] { _port.SendFromPeer(chunk.c_str(), peer_chunk_sz, bytes); });
+	try {
+		AwaitDelivered(_delivered.load(std::memory_order_acquire) + bytes);
+	}
+	catch (...) {
+		StopPeer(hPeer);
+		throw;
+	}
+	QueryPerformanceCounter(&end);
+	ULONGLONG cpu_end = GetProcessCPUTimeIn100ns();
+	StopPeer(hPeer);
+
+	double seconds = static_cast<double>(end.QuadPart - start.QuadPart) / freq.QuadPart;
+	return {
+		.baud_rate = _port.baud_rate(),
+		.read_buf_sz = _read_buf_sz,
+		.bytes = bytes,
+		.seconds = seconds,
+		.mb_per_sec = bytes / seconds / (1024 * 1024),
+		.cpu_ns_per_byte = (cpu_end - cpu_start) * 100.0 / bytes
+	};
+}
+
+SimpleComBench::TEchoLatencyResult SimpleComBench::PipelineBench::MeasureEchoLatency(DWORD samples) {
+	HANDLE hPeer = StartPeer([&] { _port.EchoFromPeer(); });
+
+	std::vector<double> latencies_us;
+	latencies_us.reserve(samples);
+	LARGE_INTEGER freq;
+	QueryPerformanceFrequency(&freq);
+	ULONGLONG cpu_start = GetProcessCPUTimeIn100ns();
+
+	try {
+		// Keystroke is sent via SerialPortWriter as well as StdInRedirector.
+		SimpleCom::SerialPortWriter writer(_port.port(), 1);
+		ULONGLONG base = _delivered.load(std::memory_order_acquire);
+
+		for (DWORD idx = 0; idx < samples; idx++) {
+			LARGE_INTEGER start, end;
+			QueryPerformanceCounter(&start);
+			writer.Put('a' + (idx % 26));
+			AwaitDelivered(base + idx + 1);
+			QueryPerformanceCounter(&end);
+			latencies_us.push_back(static_cast<double>(end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart);
+		}
+	}
+	catch (...) {
+		StopPeer(hPeer);
+		throw;
+	}
+
+	ULONGLONG cpu_end = GetProcessCPUTimeIn100ns();
+	StopPeer(hPeer);
+
+	std::sort(latencies_us.begin(), latencies_us.end());
+	auto percentile = [&](double p) { return latencies_us[min(latencies_us.size() - 1, static_cast<size_t>(latencies_us.size() * p))]; };
+	return {
+		.baud_rate = _port.baud_rate(),
+		.samples = samples,
+		.p50_us = percentile(0.50),
+		.p99_us = percentile(0.99),
+		.max_us = latencies_us.back(),
+		.cpu_ns_per_byte = (cpu_end - cpu_start) * 100.0 / samples
+	};
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+#include "RxPipeline.h"
+#include "LoopbackPort.h"
+
+namespace SimpleComBench {
+
+	typedef struct {
+		DWORD baud_rate;
+		DWORD read_buf_sz;
+		ULONGLONG bytes;
+		double seconds;
+		double mb_per_sec;
+		double cpu_ns_per_byte;
+	} TThroughputResult;
+
+	typedef struct {
+		DWORD baud_rate;
+		DWORD samples;
+		double p50_us;
+		double p99_us;
+		double max_us;
+		double cpu_ns_per_byte;
+	} TEchoLatencyResult;
+
+	/*
+	 * RX pipeline which is equivalent to TerminalRedirector on the loopback port.
+	 * The reader thread reads the port into the ring directly as well as StdOutRedirector,
+	 * and the probe (consumer of the ring) notifies when expected bytes are delivered.
+	 */
+	class PipelineBench
+	{
+	private:
+		LoopbackPort _port;
+		SimpleCom::RxPipeline _pipeline;
+		DWORD _read_buf_sz;
+		OVERLAPPED _overlapped;
+		HANDLE _hReader;
+		HANDLE _hDelivered;
+		std::atomic<ULONGLONG> _expected;
+		std::atomic<ULONGLONG> _delivered;
+		std::atomic<bool> _stop;
+		std::function<void()> _peer;
+		concurrency::concurrent_queue<SimpleCom::WinAPIException> _exception_queue;
+
+		HANDLE StartPeer(std::function<void()> peer);
+		void StopPeer(HANDLE hPeer);
+
+	public:
+		PipelineBench(DWORD baud_rate, DWORD read_buf_sz, HANDLE hOutput);
+		virtual ~PipelineBench();
+
+		inline LoopbackPort& port() {
+			return _port;
+		}
+
+		void Start();
+		void RunReader();
+		void RunPeer();
+
+		// Wait until the total of delivered bytes reaches expected.
+		void AwaitDelivered(ULONGLONG expected);
+
+		TThroughputResult MeasureThroughput(ULONGLONG bytes);
+		TEchoLatencyResult MeasureEchoLatency(DWORD samples);
+	};
+
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "LoopbackPort.h"
+#include "WinAPIException.h"
+
+// Bits per byte on the wire (8N1)
+static constexpr ULONGLONG bits_per_byte = 10;
+
+// Buffer size of the named pipe. It should be enough for chunks in benchmark.
+static constexpr DWORD pipe_buf_sz = 64 * 1024;
+
+
+SimpleComBench::LoopbackPort::LoopbackPort(DWORD baud_rate) : _baud_rate(baud_rate) {
+	QueryPerformanceFrequency(&_freq);
+
+	TString name = _T(R"(\\.\pipe\SimpleComBench-)") + std::to_wstring(GetCurrentProcessId()) + _T("-") + std::to_wstring(GetTickCount64());
+	_hPort = CreateNamedPipe(name.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+		PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, pipe_buf_sz, pipe_buf_sz, 0, nullptr);
+	if (_hPort == INVALID_HANDLE_VALUE) {
+		throw SimpleCom::WinAPIException(GetLastError(), _T("CreateNamedPipe for loopback port"));
+	}
+
+	_hPeer = CreateFile(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (_hPeer == INVALID_HANDLE_VALUE) {
+		DWORD error = GetLastError();
+		CloseHandle(_hPort);
+		throw SimpleCom::WinAPIException(error, _T("CreateFile for loopback peer"));
+	}
+}
+
+SimpleComBench::LoopbackPort::~LoopbackPort() {
+	CloseHandle(_hPeer);
+	CloseHandle(_hPort);
+}
+
+void SimpleComBench::LoopbackPort::Pace(LONGLONG start, ULONGLONG len) {
+	if (_baud_rate == 0) {
+		return;
+	}
+
+	LONGLONG deadline = start + static_cast<LONGLONG>(len * bits_per_byte * _freq.QuadPart / _baud_rate);
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	while (now.QuadPart < deadline) {
+		// Sleep() cannot wait less than 1 ms, so spin for the rest to keep the latency of small writes.
+		LONGLONG remain_ms = (deadline - now.QuadPart) * 1000 / _freq.QuadPart;
+		if (remain_ms > 1) {
+			Sleep(static_cast<DWORD>(remain_ms - 1));
+		}
+		else {
+			YieldProcessor();
+		}
+		QueryPerformanceCounter(&now);
+	}
+}
+
+void SimpleComBench::LoopbackPort::SendFromPeer(const char* chunk, DWORD chunk_sz, ULONGLONG len) {
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+
+	ULONGLONG sent = 0;
+	while (sent < len) {
+		DWORD to_write = static_cast<DWORD>(min(static_cast<ULONGLONG>(chunk_sz), len - sent));
+		DWORD nBytesWritten;
+		if (!WriteFile(_hPeer, chunk, to_write, &nBytesWritten, nullptr)) {
+			throw SimpleCom::WinAPIException(GetLastError(), _T("WriteFile to loopback peer"));
+		}
+		sent += nBytesWritten;
+		Pace(start.QuadPart, sent);
+	}
+}
+
+void SimpleComBench::LoopbackPort::EchoFromPeer() {
+	char buf[pipe_buf_sz];
+
+	while (true) {
+		DWORD nBytesRead;
+		if (!ReadFile(_hPeer, buf, sizeof(buf), &nBytesRead, nullptr)) {
+			throw SimpleCom::WinAPIException(GetLastError(), _T("ReadFile from loopback peer"));
+		}
+
+		// Received bytes and echoed bytes are on the wire respectively.
+		LARGE_INTEGER start;
+		QueryPerformanceCounter(&start);
+		Pace(start.QuadPart, nBytesRead);
+
+		DWORD nBytesWritten;
+		if (!WriteFile(_hPeer, buf, nBytesRead, &nBytesWritten, nullptr)) {
+			throw SimpleCom::WinAPIException(GetLastError(), _T("WriteFile to loopback peer"));
+		}
+		Pace(start.QuadPart, static_cast<ULONGLONG>(nBytesRead) * 2);
+	}
+}
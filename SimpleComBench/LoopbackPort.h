@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#pragma once
+
+#include "stdafx.h"
+
+namespace SimpleComBench {
+
+	/*
+	 * Loopback device for benchmark instead of serial port.
+	 * It is a pair of named pipe. port() is opened with FILE_FLAG_OVERLAPPED as well as serial port in SimpleCom,
+	 * and peer() is the other end which emulates the peripheral.
+	 *
+	 * Peer emulates the wire at the baud rate (start bit + 8 data bits + stop bit) if baud_rate is not 0.
+	 */
+	class LoopbackPort
+	{
+	private:
+		HANDLE _hPort;
+		HANDLE _hPeer;
+		DWORD _baud_rate;
+		LARGE_INTEGER _freq;
+
+		// Wait until len bytes would be sent on the wire since start.
+		void Pace(LONGLONG start, ULONGLONG len);
+
+	public:
+		LoopbackPort(DWORD baud_rate);
+		virtual ~LoopbackPort();
+
+		inline HANDLE port() const {
+			return _hPort;
+		}
+
+		inline HANDLE peer() const {
+			return _hPeer;
+		}
+
+		inline DWORD baud_rate() const {
+			return _baud_rate;
+		}
+
+		// Send chunk repeatedly from the peer until len bytes are sent. This should be called from the peer thread.
+		void SendFromPeer(const char* chunk, DWORD chunk_sz, ULONGLONG len);
+
+		// Echo back every byte to the port until I/O on the peer thread is cancelled. This should be called from the peer thread.
+		void EchoFromPeer();
+	};
+
+}
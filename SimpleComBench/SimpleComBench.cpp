@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "stdafx.h"
+
+#include "Benchmark.h"
+#include "WinAPIException.h"
+#include "util.h"
+
+/*
+ * Benchmark for RX/TX pipeline of SimpleCom on the loopback port.
+ *
+ * Usage:
+ *   SimpleComBench.exe [--console] [--bytes <num>] [--samples <num>] [--output <file>]
+ *
+ *   --console: Render received data on the console instead of NUL.
+ *   --bytes:   Bytes to transfer in each throughput benchmark (16 MiB by default).
+ *              It is capped at 2 seconds of the wire if the baud rate is emulated.
+ *   --samples: Number of keystrokes in each echo latency benchmark (1000 by default).
+ *   --output:  Write the result in JSON to the file instead of stdout.
+ */
+
+// 0 means no emulation (as fast as possible).
+static constexpr DWORD baud_rates[] = { 0, 115200, 921600, 3000000 };
+
+// Size of each ReadFile() on the port. SimpleCom reads cbInQue bytes at most.
+static constexpr DWORD read_buf_sizes[] = { 64, 1024, 16384 };
+
+typedef struct {
+	bool console;
+	ULONGLONG bytes;
+	DWORD samples;
+	LPCTSTR output;
+} TBenchOptions;
+
+static TBenchOptions ParseOptions(int argc, LPCTSTR argv[]) {
+	TBenchOptions options = { .console = false, .bytes = 16 * 1024 * 1024, .samples = 1000, .output = nullptr };
+
+	for (int i = 1; i < argc; i++) {
+		if (_tcscmp(argv[i], _T("--console")) == 0) {
+			options.console = true;
+		}
+		else if ((_tcscmp(argv[i], _T("--bytes")) == 0) && (i + 1 < argc)) {
+			options.bytes = _tcstoull(argv[++i], nullptr, 10);
+		}
+		else if ((_tcscmp(argv[i], _T("--samples")) == 0) && (i + 1 < argc)) {
+			options.samples = _tcstoul(argv[++i], nullptr, 10);
+		}
+		else if ((_tcscmp(argv[i], _T("--output")) == 0) && (i + 1 < argc)) {
+			options.output = argv[++i];
+		}
+		else {
+			throw std::invalid_argument("Usage: SimpleComBench.exe [--console] [--bytes <num>] [--samples <num>] [--output <file>]");
+		}
+	}
+
+	if (options.bytes == 0 || options.samples == 0) {
+		throw std::invalid_argument("--bytes and --samples should be greater than 0");
+	}
+	return options;
+}
+
+static std::string FormatThroughput(const SimpleComBench::TThroughputResult& result) {
+	char buf[512];
+	snprintf(buf, sizeof(buf),
+		"{\"name\": \"throughput\", \"baud_rate\": %lu, \"read_buf_sz\": %lu, \"bytes\": %llu, \"seconds\": %.6f, \"mb_per_sec\": %.3f, \"cpu_ns_per_byte\": %.3f}",
+		result.baud_rate, result.read_buf_sz, result.bytes, result.seconds, result.mb_per_sec, result.cpu_ns_per_byte);
+	return buf;
+}
+
+static std::string FormatEchoLatency(const SimpleComBench::TEchoLatencyResult& result) {
+	char buf[512];
+	snprintf(buf, sizeof(buf),
+		"{\"name\": \"echo_latency\", \"baud_rate\": %lu, \"samples\": %lu, \"p50_us\": %.3f, \"p99_us\": %.3f, \"max_us\": %.3f, \"cpu_ns_per_byte\": %.3f}",
+		result.baud_rate, result.samples, result.p50_us, result.p99_us, result.max_us, result.cpu_ns_per_byte);
+	return buf;
+}
+
+static std::string RunAll(const TBenchOptions& options, HANDLE hOutput) {
+	std::vector<std::string> results;
+
+	for (DWORD baud_rate : baud_rates) {
+		// Emulated wire should not take too long time.
+		ULONGLONG bytes = (baud_rate == 0) ? options.bytes : min(options.bytes, static_cast<ULONGLONG>(baud_rate) / 10 * 2);
+
+		for (DWORD read_buf_sz : read_buf_sizes) {
+			SimpleComBench::PipelineBench bench(baud_rate, read_buf_sz, hOutput);
+			bench.Start();
+			results.push_back(FormatThroughput(bench.MeasureThroughput(bytes)));
+		}
+
+		SimpleComBench::PipelineBench bench(baud_rate, read_buf_sizes[0], hOutput);
+		bench.Start();
+		results.push_back(FormatEchoLatency(bench.MeasureEchoLatency(options.samples)));
+	}
+
+	SYSTEMTIME now;
+	GetSystemTime(&now);
+	char timestamp[64];
+	snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02dT%02d:%02d:%02dZ", now.wYear, now.wMonth, now.wDay, now.wHour, now.wMinute, now.wSecond);
+
+	std::string json = "{\n  \"benchmark\": \"SimpleComBench\",\n  \"timestamp\": \"" + std::string(timestamp) + "\",\n  \"results\": [\n";
+	for (size_t idx = 0; idx < results.size(); idx++) {
+		json += "    " + results[idx] + ((idx + 1 < results.size()) ? ",\n" : "\n");
+	}
+	json += "  ]\n}\n";
+	return json;
+}
+
+int _tmain(int argc, LPCTSTR argv[])
+{
+	try {
+		TBenchOptions options = ParseOptions(argc, argv);
+
+		HANDLE hOutput = options.console ? GetStdHandle(STD_OUTPUT_HANDLE) :
+			CreateFile(_T("NUL"), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hOutput == INVALID_HANDLE_VALUE) {
+			throw SimpleCom::WinAPIException(GetLastError(), _T("Open output for received data"));
+		}
+
+		std::string json = RunAll(options, hOutput);
+		if (!options.console) {
+			CloseHandle(hOutput);
+		}
+
+		if (options.output == nullptr) {
+			std::cout << json;
+		}
+		else {
+			HandleHandler hFile(CreateFile(options.output, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr), _T("Open output file"));
+			DWORD nBytesWritten;
+			if (!WriteFile(hFile.handle(), json.c_str(), static_cast<DWORD>(json.length()), &nBytesWritten, nullptr)) {
+				throw SimpleCom::WinAPIException(GetLastError(), _T("WriteFile to output file"));
+			}
+		}
+	}
+	catch (SimpleCom::WinAPIException& e) {
+		std::wcerr << e.GetErrorCaption() << _T(": ") << e.GetErrorText() << std::endl;
+		return 1;
+	}
+	catch (std::invalid_argument& e) {
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "AutoBaud.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Captured from U-Boot at 115200 baud with sampling at each rate.
+static const std::string CAPTURE_CORRECT_RATE =
+	"\r\n\r\nU-Boot 2023.04 (Apr 10 2023 - 12:00:00 +0000)\r\n\r\n"
+	"CPU:   ARMv8\r\nModel: \x1b[1mGeneric board\x1b[0m\r\nDRAM:  1 GiB\r\n"
+	"Hit any key to stop autoboot:  0 \r\n";
+static const std::string CAPTURE_TOO_SLOW("\x00\x80\x00\xf8\x00\x80\xfe\x00\x80\x00\x00\xf8\x80\x00\x80\x00\xfe\x00\x00\x80", 20);
+static const std::string CAPTURE_TOO_FAST("\xe6\x9e\x1c\x7e\xf8\x60\x98\xe0\x86\x66\x1e\x80\xfe\x66\x18\x9e\x78\x06\xe6\x80\x9e\x1c\xe0\x66", 24);
+
+namespace SimpleComTest
+{
+	/*
+	 * Returns recorded captures for the baud rate instead of the serial port.
+	 * Time of the clock would be advanced by sampling.
+	 */
+	class FakeBaudSampler : public SimpleCom::BaudSampler
+	{
+	private:
+		std::map<DWORD, SimpleCom::TBaudSample> _captures;
+		DWORD _baud_rate;
+		ULONGLONG& _now;
+
+	public:
+		std::vector<DWORD> rates;
+
+		FakeBaudSampler(std::map<DWORD, SimpleCom::TBaudSample> captures, ULONGLONG& now) : _captures(captures), _baud_rate(0), _now(now) {};
+
+		virtual void SetBaudRate(DWORD baud_rate) override {
+			_baud_rate = baud_rate;
+			rates.push_back(baud_rate);
+		}
+
+		virtual SimpleCom::TBaudSample Sample(DWORD duration_ms) override {
+			_now += duration_ms;
+			auto capture = _captures.find(_baud_rate);
+			return (capture == _captures.end()) ? SimpleCom::TBaudSample{ .data = "", .slices = 10, .error_slices = 0 } : capture->second;
+		}
+	};
+
+	TEST_CLASS(AutoBaudTest)
+	{
+	public:
+
+		TEST_METHOD(ScoreTest)
+		{
+			double correct = SimpleCom::ScoreBaudSample({ .data = CAPTURE_CORRECT_RATE, .slices = 10, .error_slices = 0 });
+			double too_slow = SimpleCom::ScoreBaudSample({ .data = CAPTURE_TOO_SLOW, .slices = 10, .error_slices = 10 });
+			double too_fast = SimpleCom::ScoreBaudSample({ .data = CAPTURE_TOO_FAST, .slices = 10, .error_slices = 6 });
+
+			Assert::AreEqual(1.0, correct);
+			Assert::AreEqual(0.0, too_slow);
+			Assert::IsTrue(too_fast < autobaud_min_score);
+
+			// Garbage without line errors should not be accepted.
+			Assert::IsTrue(SimpleCom::ScoreBaudSample({ .data = CAPTURE_TOO_FAST, .slices = 10, .error_slices = 0 }) < autobaud_min_score);
+
+			// Occasional line error is acceptable.
+			Assert::IsTrue(SimpleCom::ScoreBaudSample({ .data = CAPTURE_CORRECT_RATE, .slices = 10, .error_slices = 1 }) >= autobaud_min_score);
+
+			// Text without newline (e.g. prompt) is acceptable, but it is worse than the text with newlines.
+			double prompt = SimpleCom::ScoreBaudSample({ .data = "Password: ********", .slices = 10, .error_slices = 0 });
+			Assert::IsTrue(prompt >= autobaud_min_score);
+			Assert::IsTrue(prompt < correct);
+
+			// Too short sample cannot be scored.
+			Assert::AreEqual(0.0, SimpleCom::ScoreBaudSample({ .data = "U-Boot\r\n", .slices = 10, .error_slices = 0 }));
+		}
+
+		TEST_METHOD(DetectTest)
+		{
+			ULONGLONG now = 0;
+			FakeBaudSampler sampler({
+				{ 9600, { .data = CAPTURE_TOO_SLOW, .slices = 10, .error_slices = 10 } },
+				{ 115200, { .data = CAPTURE_CORRECT_RATE, .slices = 10, .error_slices = 0 } },
+				{ 230400, { .data = CAPTURE_TOO_FAST, .slices = 10, .error_slices = 6 } }
+			}, now);
+			SimpleCom::AutoBaudDetector detector(sampler, std::vector<DWORD>(std::begin(autobaud_candidates), std::end(autobaud_candidates)), [&now] { return now; });
+
+			Assert::AreEqual(static_cast<DWORD>(115200), detector.Detect(autobaud_timeout_ms));
+
+			// All candidates should be tried in one round, and it should be finished in a second.
+			size_t num_candidates = std::size(autobaud_candidates);
+			Assert::AreEqual(num_candidates, sampler.rates.size());
+			Assert::AreEqual(num_candidates, detector.GetScores().size());
+			Assert::IsTrue(now < 1000);
+		}
+
+		TEST_METHOD(TimeoutTest)
+		{
+			ULONGLONG now = 0;
+			FakeBaudSampler sampler({
+				{ 9600, { .data = CAPTURE_TOO_SLOW, .slices = 10, .error_slices = 10 } }
+			}, now);
+			SimpleCom::AutoBaudDetector detector(sampler, { 9600, 115200 }, [&now] { return now; });
+
+			// Rounds should be repeated until the timeout.
+			Assert::AreEqual(static_cast<DWORD>(0), detector.Detect(1000));
+			Assert::IsTrue(now >= 1000);
+			Assert::AreEqual(static_cast<size_t>(10), sampler.rates.size());
+
+			Assert::ExpectException<std::invalid_argument>([&sampler] { SimpleCom::AutoBaudDetector empty(sampler, {}, &GetTickCount64); });
+		}
+
+	};
+}
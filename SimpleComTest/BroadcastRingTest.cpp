@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "BroadcastRing.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(BroadcastRingTest)
+	{
+	public:
+
+		TEST_METHOD(InvalidCapacityTest)
+		{
+			auto test = [] { SimpleCom::BroadcastRing ring(10); };
+			Assert::ExpectException<std::invalid_argument>(test);
+		}
+
+		TEST_METHOD(BroadcastTest)
+		{
+			std::string received1;
+			std::string received2;
+
+			SimpleCom::BroadcastRing ring(8);
+			ring.Subscribe([&](const char* data, const DWORD len) { received1.append(data, len); }, SimpleCom::OverflowPolicy::BLOCK);
+			ring.Subscribe([&](const char* data, const DWORD len) { received2.append(data, len); }, SimpleCom::OverflowPolicy::BLOCK);
+			ring.Start();
+
+			// Data should wrap around the ring several times.
+			const std::string expected = "0123456789abcdefghijklmnopqrstuvwxyz";
+			for (size_t idx = 0; idx < expected.length(); idx += 5) {
+				Assert::IsTrue(ring.Publish(&expected[idx], static_cast<DWORD>(min(static_cast<size_t>(5), expected.length() - idx))));
+			}
+			ring.Shutdown();
+
+			Assert::AreEqual(expected, received1);
+			Assert::AreEqual(expected, received2);
+			Assert::AreEqual(static_cast<ULONGLONG>(expected.length()), ring.GetHead());
+		}
+
+		TEST_METHOD(ClaimCommitTest)
+		{
+			std::string received;
+
+			SimpleCom::BroadcastRing ring(8);
+			ring.Subscribe([&](const char* data, const DWORD len) { received.append(data, len); }, SimpleCom::OverflowPolicy::BLOCK);
+			ring.Start();
+
+			DWORD available;
+			char* buf = ring.Claim(16, &available);
+			Assert::IsNotNull(buf);
+			// Claimed area should not exceed the end of the ring.
+			Assert::AreEqual(static_cast<DWORD>(8), available);
+			CopyMemory(buf, "abc", 3);
+			ring.Commit(3);
+			ring.Shutdown();
+
+			Assert::AreEqual(std::string("abc"), received);
+		}
+
+		TEST_METHOD(DropPolicyTest)
+		{
+			HANDLE hEntered = CreateEvent(NULL, TRUE, FALSE, NULL);
+			HANDLE hRelease = CreateEvent(NULL, TRUE, FALSE, NULL);
+			std::string received;
+
+			SimpleCom::BroadcastRing ring(8);
+			SimpleCom::BroadcastConsumer* consumer = ring.Subscribe([&](const char* data, const DWORD len) {
+				received.append(data, len);
+				SetEvent(hEntered);
+				WaitForSingleObject(hRelease, INFINITE);
+			}, SimpleCom::OverflowPolicy::DROP);
+			ring.Start();
+
+			Assert::IsTrue(ring.Publish("abcd", 4));
+			WaitForSingleObject(hEntered, INFINITE);
+
+			// Producer should not be blocked by DROP consumer even if the ring is full.
+			Assert::IsTrue(ring.Publish("efghijklmnopqrst", 16));
+			SetEvent(hRelease);
+			ring.Shutdown();
+
+			// "efghijkl" should be overwritten by "mnopqrst".
+			Assert::AreEqual(std::string("abcdmnopqrst"), received);
+			Assert::AreEqual(static_cast<ULONGLONG>(8), consumer->GetDropped());
+
+			CloseHandle(hRelease);
+			CloseHandle(hEntered);
+		}
+
+		TEST_METHOD(IdleConsumerTest)
+		{
+			std::atomic<DWORD> received = 0;
+			SimpleCom::Executor& executor = SimpleCom::Executor::Default();
+
+			SimpleCom::BroadcastRing ring(8);
+			for (int idx = 0; idx < 4; idx++) {
+				ring.Subscribe([&](const char* data, const DWORD len) { received += len; }, SimpleCom::OverflowPolicy::BLOCK);
+			}
+			ring.Start();
+			Assert::IsTrue(ring.Publish("abc", 3));
+
+			// Consumers should return their workers after they catch up with the producer.
+			for (int retry = 0; (retry < 100) && ((received.load() < 12) || (executor.GetIdleWorkerCount() != executor.GetWorkerCount())); retry++) {
+				Sleep(10);
+			}
+			Assert::AreEqual(static_cast<DWORD>(12), received.load());
+			Assert::AreEqual(executor.GetWorkerCount(), executor.GetIdleWorkerCount());
+
+			// Idle consumers should be scheduled again for new data.
+			Assert::IsTrue(ring.Publish("de", 2));
+			ring.Shutdown();
+			Assert::AreEqual(static_cast<DWORD>(20), received.load());
+		}
+
+		TEST_METHOD(ExceptionInHandlerTest)
+		{
+			DWORD error_code = 0;
+
+			SimpleCom::BroadcastRing ring(4);
+			ring.Subscribe([](const char* data, const DWORD len) { throw SimpleCom::WinAPIException(ERROR_INVALID_HANDLE); }, SimpleCom::OverflowPolicy::BLOCK);
+			ring.SetExceptionHandler([&](const SimpleCom::WinAPIException& e) { error_code = e.GetErrorCode(); });
+			ring.Start();
+
+			// Producer should not be blocked by the consumer which has been failed.
+			Assert::IsTrue(ring.Publish("0123456789abcdef", 16));
+			ring.Shutdown();
+
+			Assert::AreEqual(static_cast<DWORD>(ERROR_INVALID_HANDLE), error_code);
+		}
+
+	};
+}
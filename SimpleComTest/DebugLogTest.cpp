@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "debug.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(DebugLogTest)
+	{
+	public:
+
+		TEST_METHOD(FormatTest)
+		{
+			TString owned = _T("owned");
+			SimpleCom::debug::TLogRecord record = {
+				.level = static_cast<int>(SimpleCom::LogLevel::INFO),
+				.tid = 0,
+				.format = _T("{} {} {} {} {}"),
+				.n_args = 4,
+				.args = {
+					SimpleCom::debug::MakeLogArg(-1),
+					SimpleCom::debug::MakeLogArg(SimpleCom::debug::Hex(0x1f)),
+					SimpleCom::debug::MakeLogArg("file.cpp"),
+					SimpleCom::debug::MakeLogArg(owned)
+				},
+				.hFlushEvent = NULL
+			};
+
+			// Placeholders which do not have arguments should be kept.
+			Assert::AreEqual(TString(_T("-1 0x1f file.cpp owned {}")), SimpleCom::debug::Format(record));
+			delete record.args[3].owned;
+		}
+
+		TEST_METHOD(LevelTest)
+		{
+			std::vector<TString> messages;
+			SimpleCom::debug::SetSink([&messages](const TString& message) { messages.push_back(message); });
+			SimpleCom::debug::SetLevel(SimpleCom::LogLevel::WARN);
+
+			SimpleCom::debug::log(SimpleCom::LogLevel::INFO, _T("should not be logged"));
+			SimpleCom::debug::log(SimpleCom::LogLevel::WARN, _T("warning {}"), TString(_T("message")));
+			SimpleCom::debug::log(SimpleCom::LogLevel::ERR, _T("error {}"), 100);
+			SimpleCom::debug::Flush();
+
+			SimpleCom::debug::SetLevel(SimpleCom::LogLevel::DBG);
+			SimpleCom::debug::SetSink(nullptr);
+
+			Assert::AreEqual(static_cast<size_t>(2), messages.size());
+			Assert::IsTrue(messages[0].find(_T("warn")) != TString::npos);
+			Assert::IsTrue(messages[0].ends_with(_T("warning message")));
+			Assert::IsTrue(messages[1].find(_T("error")) != TString::npos);
+			Assert::IsTrue(messages[1].ends_with(_T("error 100")));
+		}
+
+		TEST_METHOD(DisabledTest)
+		{
+			// Nothing should be queued if the level is disabled.
+			SimpleCom::debug::SetLevel(SimpleCom::LogLevel::NONE);
+			Assert::IsFalse(SimpleCom::debug::IsEnabled(SimpleCom::LogLevel::ERR));
+			SimpleCom::debug::SetLevel(SimpleCom::LogLevel::DBG);
+			Assert::IsTrue(SimpleCom::debug::IsEnabled(SimpleCom::LogLevel::DBG));
+		}
+
+	};
+}
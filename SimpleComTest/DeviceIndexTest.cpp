@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "DeviceIndex.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(DeviceIndexTest)
+	{
+	private:
+		static SimpleCom::TDeviceInfo MakeInfo(LPCTSTR port, LPCTSTR iface, LPCTSTR instance_id) {
+			SimpleCom::TDeviceInfo info = { .port = port, .iface = iface, .instance_id = instance_id };
+			SimpleCom::DeviceIndex::ParseInstanceId(&info);
+			return info;
+		}
+
+	public:
+
+		TEST_METHOD(ParseInstanceIdTest)
+		{
+			// usbser (CDC ACM)
+			auto info = MakeInfo(_T("COM3"), _T(R"(\Device\USBSER000)"), _T(R"(USB\VID_2E8A&PID_000A\E6614103E7452D2F)"));
+			Assert::AreEqual(_T("2E8A"), info.vid.c_str());
+			Assert::AreEqual(_T("000A"), info.pid.c_str());
+			Assert::AreEqual(_T("E6614103E7452D2F"), info.serial.c_str());
+
+			// FTDI VCP driver
+			info = MakeInfo(_T("COM4"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)"));
+			Assert::AreEqual(_T("0403"), info.vid.c_str());
+			Assert::AreEqual(_T("6001"), info.pid.c_str());
+			Assert::AreEqual(_T("A50285BIA"), info.serial.c_str());
+
+			// Interface of composite device. Serial number is generated by Windows.
+			info = MakeInfo(_T("COM5"), _T(R"(\Device\USBSER001)"), _T(R"(USB\VID_2341&PID_0043&MI_00\6&1A2B3C4D&0&0000)"));
+			Assert::AreEqual(_T("2341"), info.vid.c_str());
+			Assert::AreEqual(_T("0043"), info.pid.c_str());
+			Assert::IsTrue(info.serial.empty());
+
+			// Built-in serial port
+			info = MakeInfo(_T("COM1"), _T(R"(\Device\Serial0)"), _T(R"(ACPI\PNP0501\0)"));
+			Assert::IsTrue(info.vid.empty());
+			Assert::IsTrue(info.serial.empty());
+		}
+
+		TEST_METHOD(SyncTest)
+		{
+			SimpleCom::DeviceIndex index;
+			index.Put(MakeInfo(_T("COM3"), _T(R"(\Device\USBSER000)"), _T(R"(USB\VID_2E8A&PID_000A\SERIAL3)")));
+			index.Put(MakeInfo(_T("COM4"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+SERIAL4\0000)")));
+
+			// Nothing is changed, so metadata is not needed.
+			Assert::IsFalse(index.Sync({ { _T("COM3"), _T(R"(\Device\USBSER000)") }, { _T("COM4"), _T(R"(\Device\VCP0)") } }));
+			Assert::AreEqual(static_cast<size_t>(2), index.GetDevices().size());
+
+			// COM4 is detached, COM3 is re-assigned to another adapter, and COM5 is arrived.
+			Assert::IsTrue(index.Sync({ { _T("COM3"), _T(R"(\Device\USBSER002)") }, { _T("COM5"), _T(R"(\Device\USBSER003)") } }));
+			Assert::AreEqual(static_cast<size_t>(0), index.GetDevices().size());
+			Assert::IsTrue(index.FindBySerial(_T("SERIAL3")) == nullptr);
+			Assert::IsTrue(index.FindBySerial(_T("SERIAL4")) == nullptr);
+		}
+
+		TEST_METHOD(ResolveTest)
+		{
+			SimpleCom::DeviceIndex index;
+			index.Put(MakeInfo(_T("COM7"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)")));
+
+			Assert::AreEqual(_T("COM7"), index.Resolve(_T("serial:A50285BIA")).c_str());
+			Assert::IsTrue(index.Resolve(_T("serial:UNKNOWN")).empty());
+
+			// COM port should be passed through even if it is not in the index.
+			Assert::AreEqual(_T("COM9"), index.Resolve(_T("COM9")).c_str());
+
+			// Same adapter is re-enumerated as another port.
+			index.Sync({ { _T("COM8"), _T(R"(\Device\VCP0)") } });
+			index.Put(MakeInfo(_T("COM8"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)")));
+			Assert::AreEqual(_T("COM8"), index.Resolve(_T("serial:A50285BIA")).c_str());
+		}
+
+		TEST_METHOD(UsbSelectorTest)
+		{
+			SimpleCom::DeviceIndex index;
+			index.Put(MakeInfo(_T("COM7"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)")));
+			index.Put(MakeInfo(_T("COM9"), _T(R"(\Device\USBSER000)"), _T(R"(USB\VID_2E8A&PID_000A\E6614103E7452D2F)")));
+
+			Assert::AreEqual(_T("COM7"), index.Resolve(_T("usb:0403:6001:A50285BIA")).c_str());
+			Assert::AreEqual(_T("COM9"), index.Resolve(_T("usb:2e8a:000a:E6614103E7452D2F")).c_str());
+
+			// Serial number is same, but VID/PID are different.
+			Assert::IsTrue(index.Resolve(_T("usb:0403:6015:A50285BIA")).empty());
+			Assert::IsTrue(index.Resolve(_T("usb:0403:6001")).empty());
+
+			// Re-enumerated port should be resolved, and the old port should not.
+			index.Sync({ { _T("COM8"), _T(R"(\Device\VCP0)") }, { _T("COM9"), _T(R"(\Device\USBSER000)") } });
+			Assert::IsTrue(index.Resolve(_T("usb:0403:6001:A50285BIA")).empty());
+			index.Put(MakeInfo(_T("COM8"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)")));
+			Assert::AreEqual(_T("COM8"), index.Resolve(_T("usb:0403:6001:A50285BIA")).c_str());
+		}
+
+		TEST_METHOD(FtdiChannelTest)
+		{
+			SimpleCom::DeviceIndex index;
+			index.Put(MakeInfo(_T("COM7"), _T(R"(\Device\VCP0)"), _T(R"(FTDIBUS\VID_0403+PID_6001+A50285BIA\0000)")));
+
+			// Serial number of the adapter (shown by usbser) should match FTDI VCP driver.
+			Assert::AreEqual(_T("COM7"), index.Resolve(_T("serial:A50285BIA")).c_str());
+			Assert::AreEqual(_T("COM7"), index.Resolve(_T("serial:A50285BI")).c_str());
+			Assert::AreEqual(_T("COM7"), index.Resolve(_T("usb:0403:6001:A50285BI")).c_str());
+
+			// Serial number in the form of FTDI VCP driver should match usbser.
+			index.Put(MakeInfo(_T("COM9"), _T(R"(\Device\USBSER000)"), _T(R"(USB\VID_0403&PID_6015\DN05ABCD)")));
+			Assert::AreEqual(_T("COM9"), index.Resolve(_T("serial:DN05ABCDA")).c_str());
+			Assert::AreEqual(_T("COM9"), index.Resolve(_T("usb:0403:6015:DN05ABCDA")).c_str());
+
+			// Other channels of multi-channel adapter should be matched with the exact form only.
+			index.Put(MakeInfo(_T("COM10"), _T(R"(\Device\VCP1)"), _T(R"(FTDIBUS\VID_0403+PID_6010+FT4ABCDB\0000)")));
+			Assert::AreEqual(_T("COM10"), index.Resolve(_T("serial:FT4ABCDB")).c_str());
+			Assert::IsTrue(index.Resolve(_T("serial:FT4ABCD")).empty());
+
+			// Both forms should be dropped with the port.
+			index.Sync({ { _T("COM9"), _T(R"(\Device\USBSER000)") }, { _T("COM10"), _T(R"(\Device\VCP1)") } });
+			Assert::IsTrue(index.Resolve(_T("serial:A50285BIA")).empty());
+			Assert::IsTrue(index.Resolve(_T("serial:A50285BI")).empty());
+		}
+
+		TEST_METHOD(CaseInsensitiveTest)
+		{
+			SimpleCom::DeviceIndex index;
+			index.Put(MakeInfo(_T("COM3"), _T(R"(\Device\USBSER000)"), _T(R"(USB\VID_2E8A&PID_000A\E6614103E7452D2F)")));
+
+			Assert::AreEqual(_T("COM3"), index.Resolve(_T("serial:e6614103e7452d2f")).c_str());
+			Assert::AreEqual(_T("COM3"), index.Resolve(_T("usb:2e8a:000a:e6614103E7452D2F")).c_str());
+			Assert::IsTrue(index.FindBySerial(_T("e6614103e7452d2f")) != nullptr);
+		}
+
+		TEST_METHOD(ResolveLatencyTest)
+		{
+			SimpleCom::DeviceIndex index;
+			auto to_tstring = [](int value) { TStringStream ss; ss << value; return ss.str(); };
+			for (int idx = 0; idx < 256; idx++) {
+				index.Put(MakeInfo((_T("COM") + to_tstring(idx + 1)).c_str(), (_T(R"(\Device\VCP)") + to_tstring(idx)).c_str(),
+					(_T(R"(FTDIBUS\VID_0403+PID_6001+FT)") + to_tstring(idx) + _T(R"(A\0000)")).c_str()));
+			}
+
+			// Resolution is called for each attempt of reconnection, so it should take a few microseconds at most.
+			constexpr int iterations = 100000;
+			TString port;
+			LARGE_INTEGER freq, start, end;
+			QueryPerformanceFrequency(&freq);
+			QueryPerformanceCounter(&start);
+			for (int idx = 0; idx < iterations; idx++) {
+				port = index.Resolve(_T("usb:0403:6001:FT200A"));
+			}
+			QueryPerformanceCounter(&end);
+
+			Assert::AreEqual(_T("COM201"), port.c_str());
+			double us_per_resolve = static_cast<double>(end.QuadPart - start.QuadPart) * 1000000 / freq.QuadPart / iterations;
+			Assert::IsTrue(us_per_resolve < 10.0);
+		}
+
+		TEST_METHOD(ManyPortsTest)
+		{
+			SimpleCom::DeviceIndex index;
+			SimpleCom::TDeviceMap ports;
+			auto to_tstring = [](int value) { TStringStream ss; ss << value; return ss.str(); };
+			for (int idx = 0; idx < 256; idx++) {
+				TString port = _T("COM") + to_tstring(idx + 1);
+				TString iface = _T(R"(\Device\VCP)") + to_tstring(idx);
+				TString instance_id = _T(R"(FTDIBUS\VID_0403+PID_6001+FT)") + to_tstring(idx) + _T(R"(A\0000)");
+				ports[port] = iface;
+				index.Put(MakeInfo(port.c_str(), iface.c_str(), instance_id.c_str()));
+			}
+
+			// One port is detached, and others are kept in the index.
+			ports.erase(_T("COM100"));
+			Assert::IsFalse(index.Sync(ports));
+			Assert::AreEqual(static_cast<size_t>(255), index.GetDevices().size());
+			Assert::IsTrue(index.FindBySerial(_T("FT99A")) == nullptr);
+			Assert::AreEqual(_T("COM201"), index.Resolve(_T("serial:FT200A")).c_str());
+		}
+
+	};
+}
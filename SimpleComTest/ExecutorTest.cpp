@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "Executor.h"
+#include "WinAPIException.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(ExecutorTest)
+	{
+	private:
+		HANDLE hReleaseEvent;
+
+	public:
+
+		TEST_METHOD_INITIALIZE(Init)
+		{
+			hReleaseEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		}
+
+		TEST_METHOD_CLEANUP(Cleanup)
+		{
+			CloseHandle(hReleaseEvent);
+		}
+
+		TEST_METHOD(BlockingTasksTest)
+		{
+			SimpleCom::Executor executor;
+			SimpleCom::TaskGroup group;
+			std::atomic<int> started = 0;
+
+			// Both tasks block until they are released, so they should run on different workers.
+			for (int idx = 0; idx < 2; idx++) {
+				executor.Submit(group, [&] {
+					started++;
+					WaitForSingleObject(hReleaseEvent, INFINITE);
+				});
+			}
+			while (started.load() < 2) {
+				Sleep(1);
+			}
+			Assert::AreEqual(static_cast<DWORD>(2), executor.GetWorkerCount());
+			Assert::AreEqual(static_cast<DWORD>(0), executor.GetIdleWorkerCount());
+
+			SetEvent(hReleaseEvent);
+			group.Await();
+			Assert::AreEqual(static_cast<DWORD>(2), executor.GetIdleWorkerCount());
+			Assert::AreEqual(static_cast<ULONGLONG>(2), group.GetSchedulingLatency().GetCount());
+		}
+
+		TEST_METHOD(ReuseTest)
+		{
+			SimpleCom::Executor executor;
+
+			// Sessions after reconnection should not create workers again.
+			for (int session = 0; session < 3; session++) {
+				SimpleCom::TaskGroup group;
+				int value = 0;
+				executor.Submit(group, [&value] { value = 1; });
+				group.Await();
+				Assert::AreEqual(1, value);
+				Assert::AreEqual(static_cast<ULONGLONG>(1), group.GetSchedulingLatency().GetCount());
+			}
+			Assert::AreEqual(static_cast<DWORD>(1), executor.GetWorkerCount());
+		}
+
+		TEST_METHOD(ExceptionTest)
+		{
+			SimpleCom::Executor executor;
+			SimpleCom::TaskGroup group;
+
+			// Any exception from tasks should not kill the worker, and the group should be finished.
+			executor.Submit(group, [] { throw SimpleCom::WinAPIException(ERROR_INVALID_HANDLE); });
+			executor.Submit(group, [] { throw std::invalid_argument("invalid"); });
+			executor.Submit(group, [] { throw 1; });
+			group.Await();
+
+			int value = 0;
+			executor.Submit(group, [&value] { value = 1; });
+			group.Await();
+			Assert::AreEqual(1, value);
+			Assert::AreEqual(executor.GetWorkerCount(), executor.GetIdleWorkerCount());
+		}
+
+		TEST_METHOD(RetireTest)
+		{
+			SimpleCom::Executor executor;
+			SimpleCom::TaskGroup group;
+			const DWORD num_tasks = executor_max_idle_workers + 2;
+
+			for (DWORD idx = 0; idx < num_tasks; idx++) {
+				executor.Submit(group, [&] { WaitForSingleObject(hReleaseEvent, INFINITE); });
+			}
+			SetEvent(hReleaseEvent);
+			group.Await();
+
+			// Extra workers exit after they notify the group.
+			ULONGLONG deadline = GetTickCount64() + 5000;
+			while ((executor.GetWorkerCount() > executor_max_idle_workers) && (GetTickCount64() < deadline)) {
+				Sleep(1);
+			}
+			Assert::AreEqual(executor_max_idle_workers, executor.GetWorkerCount());
+			Assert::AreEqual(executor_max_idle_workers, executor.GetIdleWorkerCount());
+		}
+
+	};
+}
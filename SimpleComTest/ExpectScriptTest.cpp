@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ExpectScript.h"
+#include "ScriptRunner.h"
+#include "BroadcastRing.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(ExpectScriptTest)
+	{
+	private:
+		HANDLE hWrite;
+		HANDLE hRead;
+		HANDLE hTermEvent;
+
+		std::string ReadFromPipe(DWORD len) {
+			std::string result(len, '\0');
+			DWORD nBytesRead;
+			if (!ReadFile(hRead, result.data(), len, &nBytesRead, NULL)) {
+				throw _T("ReadFile()");
+			}
+			result.resize(nBytesRead);
+			return result;
+		}
+
+	public:
+
+		TEST_METHOD_INITIALIZE(Initialize) {
+			if (!CreatePipe(&hRead, &hWrite, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+			hTermEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		}
+
+		TEST_METHOD_CLEANUP(Cleanup) {
+			CloseHandle(hTermEvent);
+			CloseHandle(hRead);
+			CloseHandle(hWrite);
+		}
+
+		TEST_METHOD(ParseTest)
+		{
+			SimpleCom::ExpectScript script(
+				"# comment\n"
+				"timeout 5\n"
+				"fail \"panic\" 3\n"
+				"expect \"login: \" \"\\x23 \"  # trailing comment\n"
+				"send \"root\\r\\n\"\n"
+				"sleep 100\n"
+				"exit 2\n");
+			auto& steps = script.GetSteps();
+
+			Assert::AreEqual(static_cast<size_t>(5), steps.size());
+
+			Assert::IsTrue(steps[0].command == SimpleCom::ScriptCommand::TIMEOUT);
+			Assert::AreEqual(5000, steps[0].value);
+
+			Assert::IsTrue(steps[1].command == SimpleCom::ScriptCommand::EXPECT);
+			Assert::AreEqual(4, steps[1].line);
+			Assert::AreEqual(2, steps[1].num_expected);
+			Assert::AreEqual(std::string("# "), steps[1].matcher.GetPatterns()[1]);
+			Assert::AreEqual(std::string("panic"), steps[1].matcher.GetPatterns()[2]);
+			Assert::AreEqual(3, steps[1].fail_codes[0]);
+
+			Assert::IsTrue(steps[2].command == SimpleCom::ScriptCommand::SEND);
+			Assert::AreEqual(std::string("root\r\n"), steps[2].data);
+
+			Assert::IsTrue(steps[3].command == SimpleCom::ScriptCommand::SLEEP);
+			Assert::AreEqual(100, steps[3].value);
+
+			Assert::IsTrue(steps[4].command == SimpleCom::ScriptCommand::EXIT);
+			Assert::AreEqual(2, steps[4].value);
+		}
+
+		TEST_METHOD(SyntaxErrorTest)
+		{
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("unknown \"a\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("expect\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("expect \"\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("send \"abc\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("send \"\\q\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("send \"\\x4\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("sleep abc\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("break 100 200\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("dtr\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("rts \"on\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("baud\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("baud 0\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::ExpectScript script("flow xon\n"); });
+		}
+
+		TEST_METHOD(ModemCommandTest)
+		{
+			SimpleCom::ExpectScript script(
+				"break\n"
+				"break 500\n"
+				"dtr off\n"
+				"rts on\n");
+			auto& steps = script.GetSteps();
+
+			Assert::AreEqual(static_cast<size_t>(4), steps.size());
+			Assert::IsTrue(steps[0].command == SimpleCom::ScriptCommand::BREAK);
+			Assert::AreEqual(static_cast<int>(modem_default_break_ms), steps[0].value);
+			Assert::AreEqual(500, steps[1].value);
+			Assert::IsTrue(steps[2].command == SimpleCom::ScriptCommand::DTR);
+			Assert::AreEqual(0, steps[2].value);
+			Assert::IsTrue(steps[3].command == SimpleCom::ScriptCommand::RTS);
+			Assert::AreEqual(1, steps[3].value);
+		}
+
+		TEST_METHOD(ReconfigureCommandTest)
+		{
+			SimpleCom::ExpectScript script(
+				"baud 1500000\n"
+				"flow hardware\n");
+			auto& steps = script.GetSteps();
+
+			Assert::AreEqual(static_cast<size_t>(2), steps.size());
+			Assert::IsTrue(steps[0].command == SimpleCom::ScriptCommand::BAUD);
+			Assert::AreEqual(1500000, steps[0].value);
+			Assert::IsTrue(steps[1].command == SimpleCom::ScriptCommand::FLOW);
+			Assert::AreEqual(static_cast<int>(SimpleCom::FlowControl::HARDWARE), steps[1].value);
+		}
+
+		TEST_METHOD(RunTest)
+		{
+			bool terminated = false;
+			SimpleCom::ExpectScript script(
+				"expect \"login: \"\n"
+				"send \"root\\r\"\n"
+				"expect \"# \"\n"
+				"exit 7\n");
+
+			SimpleCom::BroadcastRing ring(64);
+			SimpleCom::SerialHandle serial(hWrite);
+			SimpleCom::ScriptRunner runner(script, serial, ring, hTermEvent, [&] { terminated = true; });
+			ring.Start();
+			runner.Start();
+
+			// Pattern is split into chunks.
+			ring.Publish("Welcome\r\nlog", 12);
+			ring.Publish("in: ", 4);
+			Assert::AreEqual(std::string("root\r"), ReadFromPipe(5));
+
+			// Prompt which arrives with the echo back should be found in the backlog.
+			ring.Publish("root\r\n# ", 8);
+			runner.AwaitTermination();
+			ring.Shutdown();
+
+			Assert::IsTrue(script.IsFinished());
+			Assert::AreEqual(7, script.GetExitCode());
+			Assert::IsTrue(terminated);
+		}
+
+		TEST_METHOD(TimeoutTest)
+		{
+			bool terminated = false;
+			SimpleCom::ExpectScript script(
+				"timeout 1\n"
+				"expect \"never\"\n");
+
+			SimpleCom::BroadcastRing ring(64);
+			SimpleCom::SerialHandle serial(hWrite);
+			SimpleCom::ScriptRunner runner(script, serial, ring, hTermEvent, [&] { terminated = true; });
+			ring.Start();
+			runner.Start();
+			runner.AwaitTermination();
+			ring.Shutdown();
+
+			Assert::AreEqual(SCRIPT_EXIT_TIMEOUT, script.GetExitCode());
+			Assert::IsTrue(terminated);
+		}
+
+		TEST_METHOD(FailPatternTest)
+		{
+			SimpleCom::ExpectScript script(
+				"fail \"Kernel panic\" 3\n"
+				"expect \"login: \"\n");
+
+			SimpleCom::BroadcastRing ring(64);
+			SimpleCom::SerialHandle serial(hWrite);
+			SimpleCom::ScriptRunner runner(script, serial, ring, hTermEvent, [] {});
+			ring.Start();
+			runner.Start();
+
+			ring.Publish("Kernel panic - not syncing", 26);
+			runner.AwaitTermination();
+			ring.Shutdown();
+
+			Assert::AreEqual(3, script.GetExitCode());
+		}
+
+		TEST_METHOD(SessionFinishedTest)
+		{
+			bool terminated = false;
+			SimpleCom::ExpectScript script("expect \"login: \"\n");
+
+			SimpleCom::BroadcastRing ring(64);
+			SimpleCom::SerialHandle serial(hWrite);
+			SimpleCom::ScriptRunner runner(script, serial, ring, hTermEvent, [&] { terminated = true; });
+			ring.Start();
+			runner.Start();
+
+			SetEvent(hTermEvent);
+			runner.AwaitTermination();
+			ring.Shutdown();
+
+			Assert::AreEqual(SCRIPT_EXIT_ABORTED, script.GetExitCode());
+			Assert::IsFalse(terminated);
+		}
+
+	};
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "LineConfig.h"
+#include "WinAPIException.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	/*
+	 * Records DCBs and modem control functions in the order of calls instead of the serial port.
+	 * Apply() fails if the baud rate is not supported.
+	 */
+	class FakeLinePort : public SimpleCom::LinePort, public SimpleCom::ModemPort
+	{
+	public:
+		std::vector<DCB> applied;
+		std::vector<DWORD> escapes;
+		DWORD max_baud_rate = 921600;
+
+		virtual void Apply(const DCB& dcb) override {
+			if (dcb.BaudRate > max_baud_rate) {
+				throw SimpleCom::SerialAPIException(ERROR_INVALID_PARAMETER, _T("SetCommState"));
+			}
+			applied.push_back(dcb);
+		}
+
+		virtual void Escape(DWORD func) override {
+			escapes.push_back(func);
+		}
+	};
+
+	TEST_CLASS(LineConfigTest)
+	{
+	private:
+		DCB InitialDCB() {
+			DCB dcb = { .DCBlength = sizeof(DCB), .BaudRate = 115200 };
+			SimpleCom::SetFlowControlToDCB(&dcb, SimpleCom::FlowControl::NONE);
+			return dcb;
+		}
+
+	public:
+
+		TEST_METHOD(BaudRateTest)
+		{
+			FakeLinePort port;
+			SimpleCom::ModemController modem(port, false, true);
+			SimpleCom::LineConfigurator config(port, InitialDCB());
+			config.SetModemController(&modem);
+			DWORD notified = 0;
+			config.SetListener([&notified](const DCB& dcb) { notified = dcb.BaudRate; });
+
+			config.SetBaudRate(460800);
+			Assert::AreEqual(static_cast<size_t>(1), port.applied.size());
+			Assert::AreEqual(static_cast<DWORD>(460800), port.applied[0].BaudRate);
+			Assert::AreEqual(static_cast<DWORD>(460800), config.GetDCB().BaudRate);
+			Assert::AreEqual(static_cast<DWORD>(460800), notified);
+
+			// DTR and RTS should be set again because SetCommState() resets them.
+			Assert::AreEqual(static_cast<size_t>(2), port.escapes.size());
+			Assert::AreEqual(static_cast<DWORD>(CLRDTR), port.escapes[0]);
+			Assert::AreEqual(static_cast<DWORD>(SETRTS), port.escapes[1]);
+
+			// DCB should be kept if the port rejects new one.
+			notified = 0;
+			Assert::ExpectException<SimpleCom::SerialAPIException>([&config] { config.SetBaudRate(1500000); });
+			Assert::AreEqual(static_cast<DWORD>(460800), config.GetDCB().BaudRate);
+			Assert::AreEqual(static_cast<DWORD>(0), notified);
+		}
+
+		TEST_METHOD(StepTest)
+		{
+			FakeLinePort port;
+			SimpleCom::LineConfigurator config(port, InitialDCB());
+
+			Assert::IsTrue(config.HandleCommandKey('+'));
+			Assert::AreEqual(static_cast<DWORD>(230400), config.GetDCB().BaudRate);
+			Assert::IsTrue(config.HandleCommandKey('-'));
+			Assert::IsTrue(config.HandleCommandKey('-'));
+			Assert::AreEqual(static_cast<DWORD>(57600), config.GetDCB().BaudRate);
+			Assert::IsFalse(config.HandleCommandKey('b'));
+
+			// Rate which is not in the list should be stepped to the neighbor.
+			config.SetBaudRate(74880);
+			config.StepBaudRate(true);
+			Assert::AreEqual(static_cast<DWORD>(115200), config.GetDCB().BaudRate);
+
+			// Nothing would happen at the end of the list.
+			config.SetBaudRate(9600);
+			size_t num_applied = port.applied.size();
+			config.StepBaudRate(false);
+			Assert::AreEqual(num_applied, port.applied.size());
+		}
+
+		TEST_METHOD(FlowControlTest)
+		{
+			FakeLinePort port;
+			SimpleCom::LineConfigurator config(port, InitialDCB());
+
+			config.SetFlowControl(SimpleCom::FlowControl::HARDWARE);
+			DCB dcb = config.GetDCB();
+			Assert::IsTrue(dcb.fOutxCtsFlow);
+			Assert::AreEqual(static_cast<DWORD>(RTS_CONTROL_HANDSHAKE), static_cast<DWORD>(dcb.fRtsControl));
+			Assert::AreEqual(static_cast<DWORD>(115200), dcb.BaudRate);
+
+			// Fields for hardware flow control should be cleared.
+			config.SetFlowControl(SimpleCom::FlowControl::SOFTWARE);
+			dcb = config.GetDCB();
+			Assert::IsFalse(dcb.fOutxCtsFlow);
+			Assert::AreEqual(static_cast<DWORD>(RTS_CONTROL_ENABLE), static_cast<DWORD>(dcb.fRtsControl));
+			Assert::IsTrue(dcb.fOutX);
+			Assert::IsTrue(dcb.fInX);
+		}
+
+	};
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "LineErrors.h"
+#include "RxPipeline.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(LineErrorsTest)
+	{
+	public:
+
+		TEST_METHOD(FormatCommErrorsTest)
+		{
+			Assert::AreEqual(std::string(""), SimpleCom::FormatCommErrors(0));
+			Assert::AreEqual(std::string("overrun"), SimpleCom::FormatCommErrors(CE_OVERRUN));
+			Assert::AreEqual(std::string("overrun, framing, parity"), SimpleCom::FormatCommErrors(CE_OVERRUN | CE_FRAME | CE_RXPARITY));
+		}
+
+		TEST_METHOD(DriverQueueTunerTest)
+		{
+			SimpleCom::DriverQueueTuner tuner(256, 1024);
+
+			// Framing error is not caused by the size of the queue.
+			Assert::AreEqual(static_cast<DWORD>(0), tuner.OnCommErrors(CE_FRAME));
+			Assert::AreEqual(static_cast<DWORD>(256), tuner.GetSize());
+
+			Assert::AreEqual(static_cast<DWORD>(512), tuner.OnCommErrors(CE_OVERRUN));
+			Assert::AreEqual(static_cast<DWORD>(1024), tuner.OnCommErrors(CE_RXOVER));
+
+			// The queue should not be grown beyond the max.
+			Assert::AreEqual(static_cast<DWORD>(0), tuner.OnCommErrors(CE_OVERRUN));
+			Assert::AreEqual(static_cast<DWORD>(1024), tuner.GetSize());
+		}
+
+		TEST_METHOD(ConsoleMarkerTest)
+		{
+			HANDLE hRead;
+			HANDLE hWrite;
+			if (!CreatePipe(&hRead, &hWrite, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+
+			{
+				SimpleCom::RxPipeline pipeline(hWrite, nullptr);
+				pipeline.Start();
+				pipeline.Publish("abc", 3);
+				pipeline.PushMarker("<marker>", true);
+				pipeline.PushMarker("<log only>", false);
+				pipeline.Publish("def", 3);
+				pipeline.Shutdown();
+			}
+
+			// Marker should be placed between data which are received before and after the error.
+			char buf[32] = { 0 };
+			DWORD nBytesRead;
+			if (!ReadFile(hRead, buf, 14, &nBytesRead, NULL)) {
+				Assert::Fail(_T("ReadFile() failed"));
+			}
+			Assert::AreEqual("abc<marker>def", buf);
+
+			CloseHandle(hRead);
+			CloseHandle(hWrite);
+		}
+
+	};
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2024, Yasumasa Suenaga
+ * Copyright (C) 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -93,5 +93,29 @@ namespace SimpleComTest
 			}
 		}
 
+		TEST_METHOD(LogMarkerTest)
+		{
+			SimpleCom::LogMarkerQueue markers;
+			std::string log;
+			auto writer = [&](const char* data, const DWORD len) { log.append(data, len); };
+
+			markers.Push(2, "<A>");
+			markers.Push(2, "<B>");
+			markers.Push(6, "<C>");
+
+			// Markers should be placed at their sequence.
+			markers.Write("abcd", 4, 0, writer);
+			Assert::AreEqual(std::string("ab<A><B>cd"), log);
+
+			// Marker at the end of data should be written with the data.
+			markers.Write("ef", 2, 4, writer);
+			Assert::AreEqual(std::string("ab<A><B>cdef<C>"), log);
+
+			// Marker for the data which has been already written should be written immediately.
+			markers.Push(3, "<D>");
+			markers.Write("gh", 2, 6, writer);
+			Assert::AreEqual(std::string("ab<A><B>cdef<C><D>gh"), log);
+		}
+
 	};
 }
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ModemControl.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	/*
+	 * Records functions for EscapeCommFunction() instead of the serial port.
+	 */
+	class FakeModemPort : public SimpleCom::ModemPort
+	{
+	public:
+		std::vector<DWORD> calls;
+
+		virtual void Escape(DWORD func) override {
+			calls.push_back(func);
+		}
+	};
+
+	TEST_CLASS(ModemControlTest)
+	{
+	public:
+
+		TEST_METHOD(BreakTest)
+		{
+			FakeModemPort port;
+			SimpleCom::SessionStats stats;
+			ULONGLONG now = 1000;
+			SimpleCom::ModemController modem(port, true, true, [&now] { return now; });
+			modem.SetStats(&stats);
+
+			Assert::AreEqual(static_cast<DWORD>(INFINITE), modem.GetTimeout());
+			modem.StartBreak(250);
+			Assert::AreEqual(static_cast<size_t>(1), port.calls.size());
+			Assert::AreEqual(static_cast<DWORD>(SETBREAK), port.calls[0]);
+			Assert::AreEqual(static_cast<DWORD>(250), modem.GetTimeout());
+
+			// BREAK should be extended without SETBREAK again.
+			now += 100;
+			modem.StartBreak(250);
+			modem.Poll();
+			Assert::AreEqual(static_cast<size_t>(1), port.calls.size());
+			Assert::AreEqual(static_cast<DWORD>(250), modem.GetTimeout());
+
+			now += 250;
+			modem.Poll();
+			Assert::AreEqual(static_cast<size_t>(2), port.calls.size());
+			Assert::AreEqual(static_cast<DWORD>(CLRBREAK), port.calls[1]);
+			Assert::AreEqual(static_cast<DWORD>(INFINITE), modem.GetTimeout());
+			Assert::AreEqual(1ULL, stats.Snapshot().breaks_sent);
+		}
+
+		TEST_METHOD(CommandKeyTest)
+		{
+			FakeModemPort port;
+			SimpleCom::ModemController modem(port, true, false, [] { return 0ULL; });
+
+			Assert::IsTrue(modem.HandleCommandKey('d'));
+			Assert::IsTrue(modem.HandleCommandKey('r'));
+			Assert::IsFalse(modem.HandleCommandKey('x'));
+			Assert::IsFalse(modem.GetDTR());
+			Assert::IsTrue(modem.GetRTS());
+
+			// Lines should be set again after reconnection.
+			modem.Reapply();
+			std::vector<DWORD> expected = { CLRDTR, SETRTS, CLRDTR, SETRTS };
+			Assert::IsTrue(expected == port.calls);
+		}
+
+		TEST_METHOD(LineStateTest)
+		{
+			SimpleCom::LineStateMonitor monitor;
+			monitor.Reset(MS_CTS_ON | MS_DSR_ON);
+
+			Assert::AreEqual(static_cast<DWORD>(MS_CTS_ON), monitor.Update(EV_CTS, MS_DSR_ON));
+			Assert::AreEqual(static_cast<DWORD>(0), monitor.Update(EV_DSR, MS_DSR_ON));
+
+			// Ring would be reported at the trailing edge, so RI might be off already.
+			Assert::AreEqual(static_cast<DWORD>(MS_RING_ON), monitor.Update(EV_RING, MS_DSR_ON));
+			Assert::AreEqual(static_cast<DWORD>(MS_RLSD_ON | MS_DSR_ON), monitor.Update(EV_RLSD | EV_DSR, MS_RLSD_ON));
+			Assert::AreEqual(4ULL, monitor.GetChanges());
+
+			Assert::AreEqual(std::string("CTS=off DSR=off DCD=on RI=off"), SimpleCom::FormatModemStatus(monitor.GetStatus()));
+		}
+
+	};
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "MultiPatternMatcher.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(MultiPatternMatcherTest)
+	{
+	private:
+		std::vector<std::pair<int, DWORD>> FeedAll(SimpleCom::MultiPatternMatcher& matcher, const std::string& data) {
+			std::vector<std::pair<int, DWORD>> matches;
+			matcher.Feed(data.c_str(), static_cast<DWORD>(data.length()), [&](const int pattern_id, const DWORD end) {
+				matches.push_back({ pattern_id, end });
+				return true;
+			});
+			return matches;
+		}
+
+	public:
+
+		TEST_METHOD(EmptyPatternTest)
+		{
+			auto test = [] { SimpleCom::MultiPatternMatcher matcher({ "abc", "" }); };
+			Assert::ExpectException<std::invalid_argument>(test);
+		}
+
+		TEST_METHOD(OverlappedPatternsTest)
+		{
+			SimpleCom::MultiPatternMatcher matcher({ "he", "she", "his", "hers" });
+			auto matches = FeedAll(matcher, "ushers");
+
+			// "she" and "he" end at the same position, then "hers" follows.
+			Assert::AreEqual(static_cast<size_t>(3), matches.size());
+			Assert::AreEqual(1, matches[0].first);
+			Assert::AreEqual(static_cast<DWORD>(4), matches[0].second);
+			Assert::AreEqual(0, matches[1].first);
+			Assert::AreEqual(static_cast<DWORD>(4), matches[1].second);
+			Assert::AreEqual(3, matches[2].first);
+			Assert::AreEqual(static_cast<DWORD>(6), matches[2].second);
+		}
+
+		TEST_METHOD(SplitChunkTest)
+		{
+			SimpleCom::MultiPatternMatcher matcher({ "login: " });
+
+			// Pattern should be found even if it is split across chunks.
+			Assert::AreEqual(static_cast<size_t>(0), FeedAll(matcher, "\r\nbuildroot log").size());
+			Assert::AreEqual(static_cast<size_t>(0), FeedAll(matcher, "in").size());
+			auto matches = FeedAll(matcher, ": ");
+			Assert::AreEqual(static_cast<size_t>(1), matches.size());
+			Assert::AreEqual(static_cast<DWORD>(2), matches[0].second);
+
+			// Partial match should be discarded by Reset().
+			FeedAll(matcher, "log");
+			matcher.Reset();
+			Assert::AreEqual(static_cast<size_t>(0), FeedAll(matcher, "in: ").size());
+		}
+
+		TEST_METHOD(StopScanTest)
+		{
+			SimpleCom::MultiPatternMatcher matcher({ "#", "$" });
+			int matched = -1;
+			const char* data = "ab$cd#ef";
+
+			DWORD scanned = matcher.Feed(data, 8, [&](const int pattern_id, const DWORD end) {
+				matched = pattern_id;
+				return false;
+			});
+
+			Assert::AreEqual(1, matched);
+			Assert::AreEqual(static_cast<DWORD>(3), scanned);
+		}
+
+		TEST_METHOD(BinaryPatternTest)
+		{
+			SimpleCom::MultiPatternMatcher matcher({ std::string("\x00\xff", 2) });
+			auto matches = FeedAll(matcher, std::string("\xff\x00\x00\xff", 4));
+
+			Assert::AreEqual(static_cast<size_t>(1), matches.size());
+			Assert::AreEqual(static_cast<DWORD>(4), matches[0].second);
+		}
+
+		TEST_METHOD(ThroughputTest)
+		{
+			// Hundreds of patterns should be scanned faster than 3 Mbaud (about 300 KB/s) with enough margin.
+			std::vector<std::string> patterns;
+			for (int idx = 0; idx < 500; idx++) {
+				patterns.push_back("pattern-" + std::to_string(idx) + ":");
+			}
+			SimpleCom::MultiPatternMatcher matcher(patterns);
+
+			std::string data;
+			while (data.length() < 4 * 1024 * 1024) {
+				data += "[    1.234567] pattern-1 usb 1-1: new high-speed USB device number 2 using xhci_hcd\r\n";
+			}
+			data += "pattern-499:";
+
+			int matched = -1;
+			LARGE_INTEGER freq, start, end;
+			QueryPerformanceFrequency(&freq);
+			QueryPerformanceCounter(&start);
+			matcher.Feed(data.c_str(), static_cast<DWORD>(data.length()), [&](const int pattern_id, const DWORD match_end) {
+				matched = pattern_id;
+				return true;
+			});
+			QueryPerformanceCounter(&end);
+
+			Assert::AreEqual(499, matched);
+			double bytes_per_sec = data.length() / (static_cast<double>(end.QuadPart - start.QuadPart) / freq.QuadPart);
+			Assert::IsTrue(bytes_per_sec > 3.0 * 1024 * 1024);
+		}
+
+	};
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ReconnectPolicy.h"
+#include "LatencyHistogram.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	/*
+	 * Device which arrives at arrival_ms on the virtual clock.
+	 */
+	class FakeDeviceProvider : public SimpleCom::DeviceProvider
+	{
+	public:
+		ULONGLONG now;
+		ULONGLONG arrival_ms;
+		ULONGLONG cancel_ms;
+		std::vector<ULONGLONG> attempts;
+		std::vector<DWORD> waits;
+
+		FakeDeviceProvider(ULONGLONG arrival) : now(1000), arrival_ms(1000 + arrival), cancel_ms(ULLONG_MAX), attempts(), waits() {};
+
+		virtual HANDLE Open() override {
+			attempts.push_back(now);
+			// Handle is not used by the policy.
+			return (now >= arrival_ms) ? reinterpret_cast<HANDLE>(1) : INVALID_HANDLE_VALUE;
+		}
+
+		virtual ULONGLONG Now() override {
+			return now;
+		}
+
+		virtual bool Wait(DWORD ms) override {
+			waits.push_back(ms);
+			now += ms;
+			return now < cancel_ms;
+		}
+	};
+
+	TEST_CLASS(ReconnectPolicyTest)
+	{
+	public:
+
+		TEST_METHOD(BackoffTest)
+		{
+			SimpleCom::ReconnectPolicy policy(10, 100, 10000);
+			FakeDeviceProvider provider(500);
+
+			Assert::IsTrue(policy.Open(provider) != INVALID_HANDLE_VALUE);
+			Assert::IsFalse(policy.IsTimedOut());
+
+			// Interval should be doubled from 10 ms, and should be capped at 100 ms.
+			std::vector<DWORD> expected = { 10, 20, 40, 80, 100, 100, 100, 100 };
+			Assert::AreEqual(expected.size(), provider.waits.size());
+			for (size_t idx = 0; idx < expected.size(); idx++) {
+				Assert::AreEqual(expected[idx], provider.waits[idx]);
+			}
+		}
+
+		TEST_METHOD(EarlyArrivalTest)
+		{
+			SimpleCom::ReconnectPolicy policy(120 * 1000);
+
+			// Device which is already available should be opened without waiting.
+			FakeDeviceProvider available(0);
+			Assert::IsTrue(policy.Open(available) != INVALID_HANDLE_VALUE);
+			Assert::AreEqual(static_cast<size_t>(0), available.waits.size());
+
+			// Device which re-enumerates quickly should be opened within short interval of the arrival.
+			FakeDeviceProvider quick(35);
+			Assert::IsTrue(policy.Open(quick) != INVALID_HANDLE_VALUE);
+			Assert::IsTrue(quick.now - quick.arrival_ms < 40);
+
+			// Late device should be opened within the max interval of the arrival.
+			FakeDeviceProvider late(5000);
+			Assert::IsTrue(policy.Open(late) != INVALID_HANDLE_VALUE);
+			Assert::IsTrue(late.now - late.arrival_ms <= reconnect_max_interval_ms);
+
+			// All of latencies should be recorded.
+			const SimpleCom::LatencyHistogram& histogram = policy.open_latency();
+			Assert::AreEqual(static_cast<ULONGLONG>(3), histogram.GetCount());
+			Assert::AreEqual(static_cast<ULONGLONG>(1), histogram.GetBucket(0));
+			Assert::AreEqual(static_cast<ULONGLONG>(1), histogram.GetBucket(SimpleCom::LatencyHistogram::GetBucketIndex(quick.now - 1000)));
+			Assert::AreEqual(late.now - 1000, histogram.GetMax());
+		}
+
+		TEST_METHOD(TimeoutTest)
+		{
+			SimpleCom::ReconnectPolicy policy(10, 500, 3000);
+			FakeDeviceProvider provider(ULLONG_MAX / 2);
+
+			Assert::IsTrue(policy.Open(provider) == INVALID_HANDLE_VALUE);
+			Assert::IsTrue(policy.IsTimedOut());
+
+			// The last attempt should be performed at the timeout exactly.
+			Assert::AreEqual(static_cast<ULONGLONG>(1000 + 3000), provider.attempts.back());
+			Assert::AreEqual(static_cast<ULONGLONG>(0), policy.open_latency().GetCount());
+		}
+
+		TEST_METHOD(CancelTest)
+		{
+			SimpleCom::ReconnectPolicy policy(10, 500, 3000);
+			FakeDeviceProvider provider(2000);
+			provider.cancel_ms = 1000 + 100;
+
+			Assert::IsTrue(policy.Open(provider) == INVALID_HANDLE_VALUE);
+			Assert::IsFalse(policy.IsTimedOut());
+		}
+
+		TEST_METHOD(HistogramTest)
+		{
+			SimpleCom::LatencyHistogram histogram;
+			Assert::AreEqual(0, SimpleCom::LatencyHistogram::GetBucketIndex(0));
+			Assert::AreEqual(1, SimpleCom::LatencyHistogram::GetBucketIndex(1));
+			Assert::AreEqual(2, SimpleCom::LatencyHistogram::GetBucketIndex(3));
+			Assert::AreEqual(4, SimpleCom::LatencyHistogram::GetBucketIndex(8));
+			Assert::AreEqual(latency_histogram_buckets - 1, SimpleCom::LatencyHistogram::GetBucketIndex(ULLONG_MAX));
+
+			histogram.Record(5);
+			histogram.Record(6);
+			histogram.Record(100);
+			Assert::AreEqual(static_cast<ULONGLONG>(2), histogram.GetBucket(3));
+			Assert::AreEqual(static_cast<ULONGLONG>(100), histogram.GetMax());
+			Assert::AreEqual(TString(_T("[4, 8) ms: 2\n[64, 128) ms: 1\n")), histogram.Format(_T("ms")));
+		}
+
+	};
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ResizeDebouncer.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(ResizeDebouncerTest)
+	{
+	private:
+		ULONGLONG _now;
+
+		SimpleCom::ResizeDebouncer CreateDebouncer(DWORD quiet_ms, DWORD min_interval_ms) {
+			return SimpleCom::ResizeDebouncer({ .X = 80, .Y = 24 }, quiet_ms, min_interval_ms, [this] { return _now; });
+		}
+
+	public:
+
+		TEST_METHOD_INITIALIZE(Initialize) {
+			_now = 10000;
+		}
+
+		TEST_METHOD(NoChangeTest)
+		{
+			auto debouncer = CreateDebouncer(100, 250);
+			COORD size;
+
+			Assert::AreEqual(INFINITE, debouncer.GetTimeout());
+			Assert::IsFalse(debouncer.Poll(&size));
+
+			// Same size as current one should not be sent.
+			debouncer.Update({ .X = 80, .Y = 24 });
+			Assert::AreEqual(INFINITE, debouncer.GetTimeout());
+		}
+
+		TEST_METHOD(CoalesceTest)
+		{
+			auto debouncer = CreateDebouncer(100, 250);
+			COORD size;
+
+			// Dragging the window edge
+			for (SHORT cols = 81; cols <= 120; cols++) {
+				debouncer.Update({ .X = cols, .Y = 24 });
+				Assert::IsFalse(debouncer.Poll(&size));
+				_now += 20;
+			}
+
+			// Quiet period has not been elapsed yet since the last change.
+			Assert::AreEqual(static_cast<DWORD>(80), debouncer.GetTimeout());
+			_now += 80;
+
+			// Only the final size would be sent.
+			Assert::IsTrue(debouncer.Poll(&size));
+			Assert::AreEqual(static_cast<SHORT>(120), size.X);
+			Assert::AreEqual(static_cast<SHORT>(24), size.Y);
+			Assert::AreEqual(INFINITE, debouncer.GetTimeout());
+		}
+
+		TEST_METHOD(MinIntervalTest)
+		{
+			auto debouncer = CreateDebouncer(10, 250);
+			COORD size;
+
+			debouncer.Update({ .X = 100, .Y = 30 });
+			_now += 10;
+			Assert::IsTrue(debouncer.Poll(&size));
+			_now += 10;
+
+			// Quiet period has been elapsed, but it is too early from the previous request.
+			debouncer.Update({ .X = 120, .Y = 40 });
+			_now += 10;
+			Assert::IsFalse(debouncer.Poll(&size));
+			Assert::AreEqual(static_cast<DWORD>(230), debouncer.GetTimeout());
+
+			_now += 230;
+			Assert::IsTrue(debouncer.Poll(&size));
+			Assert::AreEqual(static_cast<SHORT>(120), size.X);
+			Assert::AreEqual(static_cast<SHORT>(40), size.Y);
+		}
+
+		TEST_METHOD(BackToSentSizeTest)
+		{
+			auto debouncer = CreateDebouncer(100, 250);
+			COORD size;
+
+			// Window is resized, and back to the original size before the quiet period.
+			debouncer.Update({ .X = 100, .Y = 30 });
+			_now += 50;
+			debouncer.Update({ .X = 80, .Y = 24 });
+			_now += 1000;
+
+			Assert::IsFalse(debouncer.Poll(&size));
+			Assert::AreEqual(INFINITE, debouncer.GetTimeout());
+		}
+
+		TEST_METHOD(NoDebounceTest)
+		{
+			auto debouncer = CreateDebouncer(0, 0);
+			COORD size;
+
+			debouncer.Update({ .X = 100, .Y = 30 });
+			Assert::IsTrue(debouncer.Poll(&size));
+			debouncer.Update({ .X = 101, .Y = 30 });
+			Assert::IsTrue(debouncer.Poll(&size));
+			Assert::AreEqual(static_cast<SHORT>(101), size.X);
+		}
+
+	};
+}
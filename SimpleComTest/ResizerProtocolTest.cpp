@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "ResizerProtocol.h"
+#include "../common/common.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(ResizerProtocolTest)
+	{
+	public:
+
+		TEST_METHOD(V1RequestTest)
+		{
+			std::string request = SimpleCom::EncodeResizeRequest(1, { .X = 120, .Y = 40 });
+			Assert::AreEqual(std::string("\x12" "40;120t"), request);
+		}
+
+		TEST_METHOD(V2RequestTest)
+		{
+			std::string request = SimpleCom::EncodeResizeRequest(2, { .X = 256, .Y = 18 });
+
+			// DC2, marker, type, length, rows, cols, CRC16, end marker
+			Assert::AreEqual(static_cast<size_t>(RESIZER_V2_OVERHEAD + 8), request.length());
+			Assert::AreEqual(std::string("\x12#010400120100"), request.substr(0, 14));
+
+			const unsigned char decoded[] = { 0x01, 0x04, 0x00, 0x12, 0x01, 0x00 };
+			unsigned short crc = 0xffff;
+			for (unsigned char ch : decoded) {
+				crc = resizer_crc16_update(crc, ch);
+			}
+			char crc_hex[5];
+			snprintf(crc_hex, sizeof(crc_hex), "%04x", crc);
+			Assert::AreEqual(std::string(crc_hex) + "t", request.substr(14));
+		}
+
+		TEST_METHOD(PrintableFrameTest)
+		{
+			// Bytes which are special for the line discipline (VINTR, VEOF, VSUSP, VQUIT, IXON, CR, DEL) should not appear.
+			const unsigned char specials[] = { 0x03, 0x04, 0x0d, 0x11, 0x13, 0x1a, 0x1c, 0x7f };
+			BYTE payload[RESIZER_V2_MAX_PAYLOAD];
+			for (int idx = 0; idx < RESIZER_V2_MAX_PAYLOAD; idx++) {
+				payload[idx] = specials[idx % sizeof(specials)];
+			}
+
+			std::string frames[] = {
+				SimpleCom::EncodeResizerHello(RESIZER_CAPS),
+				SimpleCom::EncodeResizerClockSync(0x0304111a1c7f0d13ULL),
+				SimpleCom::EncodeResizerFrame(RESIZER_MSG_KEEPALIVE, payload, sizeof(payload))
+			};
+			for (auto& frame : frames) {
+				Assert::AreEqual(RESIZER_START_MARKER, frame[0]);
+				for (size_t idx = 1; idx < frame.length(); idx++) {
+					Assert::IsTrue((frame[idx] >= 0x20) && (frame[idx] < 0x7f));
+				}
+			}
+		}
+
+		TEST_METHOD(CRC16Test)
+		{
+			// Check value of CRC-16/CCITT-FALSE
+			unsigned short crc = 0xffff;
+			for (const char* ch = "123456789"; *ch != '\0'; ch++) {
+				crc = resizer_crc16_update(crc, *ch);
+			}
+			Assert::AreEqual(static_cast<unsigned short>(0x29b1), crc);
+		}
+
+		TEST_METHOD(MessagesTest)
+		{
+			Assert::AreEqual(std::string("04020203"), SimpleCom::EncodeResizerHello(RESIZER_CAPS).substr(2, 8));
+			Assert::AreEqual(std::string("020400000102"), SimpleCom::EncodeResizerKeepalive(0x102).substr(2, 12));
+			Assert::AreEqual(std::string("03080000000000000100"), SimpleCom::EncodeResizerClockSync(0x100).substr(2, 20));
+
+			BYTE payload[RESIZER_V2_MAX_PAYLOAD + 1] = { 0 };
+			Assert::ExpectException<std::invalid_argument>([&] { SimpleCom::EncodeResizerFrame(RESIZER_MSG_KEEPALIVE, payload, sizeof(payload)); });
+		}
+
+		TEST_METHOD(NegotiationTest)
+		{
+			SimpleCom::ResizerNegotiator negotiator;
+			Assert::AreEqual(1, negotiator.GetVersion());
+
+			// Reply is split across chunks, and it is surrounded by other data.
+			std::string chunk1 = "login: \x1b\x1b]53";
+			std::string chunk2 = "79;2;03\x07$ ";
+			negotiator.Feed(chunk1.c_str(), static_cast<DWORD>(chunk1.length()));
+			Assert::AreEqual(1, negotiator.GetVersion());
+			negotiator.Feed(chunk2.c_str(), static_cast<DWORD>(chunk2.length()));
+
+			Assert::AreEqual(2, negotiator.GetVersion());
+			Assert::AreEqual(static_cast<BYTE>(RESIZER_CAPS), negotiator.GetCapabilities());
+			Assert::AreEqual(static_cast<DWORD>(WAIT_OBJECT_0), WaitForSingleObject(negotiator.negotiated_event(), 0));
+		}
+
+		TEST_METHOD(InvalidReplyTest)
+		{
+			SimpleCom::ResizerNegotiator negotiator;
+
+			std::string data = "\x1b]5379;x;03\x07" "\x1b]5379;2\x07" "\x1b]5379;2;0000000000000000000003\x07";
+			negotiator.Feed(data.c_str(), static_cast<DWORD>(data.length()));
+
+			Assert::AreEqual(1, negotiator.GetVersion());
+			Assert::AreEqual(static_cast<DWORD>(WAIT_TIMEOUT), WaitForSingleObject(negotiator.negotiated_event(), 0));
+		}
+
+		TEST_METHOD(ReplyFilterTest)
+		{
+			SimpleCom::ResizerReplyFilter filter;
+			std::string result;
+			auto writer = [&](const char* data, const DWORD len) { result.append(data, len); };
+
+			// Reply is split across chunks, and it is surrounded by other data.
+			std::string chunk1 = "login: \x1b\x1b]53";
+			std::string chunk2 = "79;2;03\x07$ ";
+			filter.Filter(chunk1.c_str(), static_cast<DWORD>(chunk1.length()), writer);
+			Assert::AreEqual(std::string("login: \x1b"), result);
+			filter.Filter(chunk2.c_str(), static_cast<DWORD>(chunk2.length()), writer);
+			Assert::AreEqual(std::string("login: \x1b$ "), result);
+
+			// Other escape sequences and invalid replies should be passed as they are.
+			result.clear();
+			std::string data = "\x1b[1m\x1b]0;title\x07\x1b]5379;x;03\x07\x1b]5379;2;0000000000000000000003\x07";
+			filter.Filter(data.c_str(), static_cast<DWORD>(data.length()), writer);
+			Assert::AreEqual(data, result);
+		}
+
+	};
+}
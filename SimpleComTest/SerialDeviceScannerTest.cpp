@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "SerialDeviceScanner.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	/*
+	 * Devices in memory instead of the registry and SetupAPI.
+	 */
+	class FixtureDeviceSource : public SimpleCom::DeviceSource
+	{
+	public:
+		std::vector<SimpleCom::TDeviceInfo> devices;
+		bool changed = true;
+		int metadata_queries = 0;
+
+		virtual SimpleCom::TDeviceMap ListPorts() override {
+			SimpleCom::TDeviceMap ports;
+			for (auto& info : devices) {
+				ports[info.port] = info.iface;
+			}
+			changed = false;
+			return ports;
+		}
+
+		virtual std::vector<SimpleCom::TDeviceInfo> QueryMetadata() override {
+			metadata_queries++;
+			return devices;
+		}
+
+		virtual bool HasChanged() override {
+			return changed;
+		}
+	};
+
+	TEST_CLASS(SerialDeviceScannerTest)
+	{
+	public:
+
+		TEST_METHOD(MergeDevicesTest)
+		{
+			SimpleCom::TDeviceMap devices = {
+				{ _T("COM1"), _T(R"(\Device\Serial0)") },
+				{ _T("COM3"), _T(R"(\Device\USBSER000)") }
+			};
+
+			// COM3 is detached, and COM4 is arrived.
+			SimpleCom::TDeviceMap latest = {
+				{ _T("COM1"), _T(R"(\Device\Serial0)") },
+				{ _T("COM4"), _T(R"(\Device\USBSER001)") }
+			};
+
+			auto arrived = SimpleCom::SerialDeviceScanner::MergeDevices(devices, latest);
+			Assert::AreEqual(static_cast<size_t>(1), arrived.size());
+			Assert::AreEqual(_T("COM4"), arrived[0].c_str());
+			Assert::AreEqual(static_cast<size_t>(2), devices.size());
+			Assert::IsFalse(devices.contains(_T("COM3")));
+			Assert::AreEqual(_T(R"(\Device\USBSER001)"), devices[_T("COM4")].c_str());
+
+			// Nothing is changed.
+			arrived = SimpleCom::SerialDeviceScanner::MergeDevices(devices, latest);
+			Assert::IsTrue(arrived.empty());
+			Assert::AreEqual(static_cast<size_t>(2), devices.size());
+		}
+
+		TEST_METHOD(InterfaceChangedTest)
+		{
+			SimpleCom::TDeviceMap devices = { { _T("COM3"), _T(R"(\Device\USBSER000)") } };
+
+			// Same port is assigned to another interface after re-enumeration. It is not a new arrival.
+			auto arrived = SimpleCom::SerialDeviceScanner::MergeDevices(devices, { { _T("COM3"), _T(R"(\Device\USBSER002)") } });
+			Assert::IsTrue(arrived.empty());
+			Assert::AreEqual(_T(R"(\Device\USBSER002)"), devices[_T("COM3")].c_str());
+		}
+
+		TEST_METHOD(ReenumerationTest)
+		{
+			auto source = std::make_unique<FixtureDeviceSource>();
+			FixtureDeviceSource* fixture = source.get();
+			fixture->devices = { { .port = _T("COM7"), .iface = _T(R"(\Device\VCP0)"), .vid = _T("0403"), .pid = _T("6001"), .serial = _T("A50285BIA") } };
+			SimpleCom::SerialDeviceScanner scanner(std::move(source));
+
+			scanner.ScanSerialDevices();
+			Assert::AreEqual(_T("COM7"), scanner.ResolvePort(_T("usb:0403:6001:A50285BIA")).c_str());
+			Assert::AreEqual(1, fixture->metadata_queries);
+
+			// Nothing is changed, so devices should not be scanned.
+			scanner.RefreshIfChanged();
+			Assert::AreEqual(1, fixture->metadata_queries);
+
+			// Adapter is detached.
+			fixture->devices.clear();
+			fixture->changed = true;
+			scanner.RefreshIfChanged();
+			Assert::IsTrue(scanner.GetDevices().empty());
+			Assert::IsTrue(scanner.ResolvePort(_T("usb:0403:6001:A50285BIA")).empty());
+
+			// Adapter is re-enumerated with another port.
+			fixture->devices = { { .port = _T("COM8"), .iface = _T(R"(\Device\VCP0)"), .vid = _T("0403"), .pid = _T("6001"), .serial = _T("A50285BIA") } };
+			fixture->changed = true;
+			scanner.RefreshIfChanged();
+			Assert::AreEqual(_T("COM8"), scanner.ResolvePort(_T("usb:0403:6001:A50285BIA")).c_str());
+			Assert::AreEqual(_T("COM8"), scanner.ResolvePort(_T("serial:A50285BIA")).c_str());
+		}
+
+	};
+}
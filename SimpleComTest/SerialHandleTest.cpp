@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "SerialHandle.h"
+#include "SerialPortWriter.h"
+#include "WinAPIException.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(SerialHandleTest)
+	{
+	private:
+		static std::string ReadAll(HANDLE hRead, DWORD len) {
+			std::string result(len, '\0');
+			DWORD nBytesRead;
+			if (!ReadFile(hRead, result.data(), len, &nBytesRead, NULL)) {
+				throw _T("ReadFile()");
+			}
+			result.resize(nBytesRead);
+			return result;
+		}
+
+	public:
+
+		TEST_METHOD(DetachTest)
+		{
+			HANDLE hRead;
+			HANDLE hWrite;
+			if (!CreatePipe(&hRead, &hWrite, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+
+			SimpleCom::SerialHandle serial(hWrite, true);
+			Assert::IsTrue(serial.Get() == hWrite);
+
+			serial.Detach();
+			Assert::IsTrue(serial.Get() == INVALID_HANDLE_VALUE);
+
+			// Writing to detached device should be reported as same as removed device.
+			OVERLAPPED overlapped = { 0 };
+			Assert::IsFalse(serial.Write("a", 1, &overlapped));
+			DWORD error = GetLastError();
+			Assert::AreEqual(static_cast<DWORD>(ERROR_DEVICE_REMOVED), error);
+			Assert::IsTrue(SimpleCom::IsDeviceDetachedError(error));
+
+			DCB dcb = { .DCBlength = sizeof(DCB), .BaudRate = 115200 };
+			Assert::IsFalse(serial.Reconfigure(dcb));
+			Assert::AreEqual(static_cast<DWORD>(ERROR_DEVICE_REMOVED), GetLastError());
+
+			// Owned handle should be closed, so the reader would see EOF.
+			char ch;
+			DWORD nBytesRead;
+			Assert::IsFalse(ReadFile(hRead, &ch, 1, &nBytesRead, NULL));
+
+			CloseHandle(hRead);
+		}
+
+		TEST_METHOD(WriterFollowsSwapTest)
+		{
+			HANDLE hRead1, hWrite1, hRead2, hWrite2;
+			if (!CreatePipe(&hRead1, &hWrite1, NULL, 0) || !CreatePipe(&hRead2, &hWrite2, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+
+			{
+				SimpleCom::SerialHandle serial(hWrite1, true);
+				SimpleCom::SerialPortWriter writer(serial, 4);
+
+				writer.PutData("abc", 3);
+				Assert::AreEqual(std::string("abc"), ReadAll(hRead1, 3));
+
+				// Simulate detaching of the device. Keys would be lost, and the writer should not be stuck.
+				serial.Detach();
+				writer.Put('x');
+				Assert::ExpectException<SimpleCom::SerialAPIException>([&] { writer.WriteAsync(); });
+				Assert::ExpectException<SimpleCom::SerialAPIException>([&] { writer.PutData("y", 1); });
+
+				// Same writer should be used for the re-arrived device.
+				serial.Attach(hWrite2);
+				writer.PutData("def", 3);
+				Assert::AreEqual(std::string("def"), ReadAll(hRead2, 3));
+				Assert::AreEqual(static_cast<DWORD>(1), serial.GetReconnectCount());
+			}
+
+			CloseHandle(hRead1);
+			CloseHandle(hRead2);
+		}
+
+		TEST_METHOD(ReconnectLatencyTest)
+		{
+			HANDLE hRead1, hWrite1, hRead2, hWrite2;
+			if (!CreatePipe(&hRead1, &hWrite1, NULL, 0) || !CreatePipe(&hRead2, &hWrite2, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+
+			SimpleCom::SerialHandle serial(hRead1, true);
+
+			// Data before reconnection should not be measured.
+			WriteFile(hWrite1, "a", 1, nullptr, NULL);
+			Assert::AreEqual(std::string("a"), ReadAll(serial.Get(), 1));
+			serial.NotifyReceived();
+			Assert::AreEqual(static_cast<DWORD>(0), serial.GetReconnectCount());
+
+			// Simulate detach and re-arrival of the device.
+			CloseHandle(hWrite1);
+			serial.Detach();
+			serial.Attach(hRead2);
+
+			// The peripheral starts to talk after 50 ms from the arrival.
+			Sleep(50);
+			WriteFile(hWrite2, "login: ", 7, nullptr, NULL);
+			Assert::AreEqual(std::string("login: "), ReadAll(serial.Get(), 7));
+			serial.NotifyReceived();
+
+			ULONGLONG latency_us = serial.GetLastReconnectLatencyUs();
+			Assert::IsTrue(latency_us >= 50 * 1000);
+			Assert::IsTrue(latency_us < 1000 * 1000);
+
+			// Only the first data after reconnection should be measured.
+			WriteFile(hWrite2, "b", 1, nullptr, NULL);
+			ReadAll(serial.Get(), 1);
+			serial.NotifyReceived();
+			Assert::AreEqual(latency_us, serial.GetLastReconnectLatencyUs());
+
+			CloseHandle(hWrite2);
+		}
+
+	};
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2025, Yasumasa Suenaga
+ * Copyright (C) 2023, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -223,6 +223,7 @@ namespace SimpleComTest
 			Assert::AreEqual(_T("none"), setup.GetFlowControl().tstr());
 			Assert::AreEqual(false, setup.GetUseUTF8());
 			Assert::AreEqual(false, setup.GetUseTTYResizer());
+			Assert::AreEqual(100, setup.GetResizeDebounce());
 			Assert::AreEqual(0, setup.GetWaitDevicePeriod());
 			Assert::AreEqual(false, setup.GetAutoReconnect());
 			Assert::AreEqual(3, setup.GetAutoReconnectPauseInSec());
@@ -244,6 +245,7 @@ namespace SimpleComTest
 				_T("--flow-control"), _T("hardware"),
 				_T("--utf8"),
 				_T("--tty-resizer"),
+				_T("--resize-debounce"), _T("50"),
 				_T("--show-dialog"),
 				_T("--wait-serial-device"), _T("10"),
 				_T("--auto-reconnect"),
@@ -265,6 +267,7 @@ namespace SimpleComTest
 			Assert::AreEqual(_T("hardware"), setup.GetFlowControl().tstr());
 			Assert::AreEqual(true, setup.GetUseUTF8());
 			Assert::AreEqual(true, setup.GetUseTTYResizer());
+			Assert::AreEqual(50, setup.GetResizeDebounce());
 			Assert::AreEqual(10, setup.GetWaitDevicePeriod());
 			Assert::AreEqual(true, setup.GetAutoReconnect());
 			Assert::AreEqual(5, setup.GetAutoReconnectPauseInSec());
@@ -468,5 +471,44 @@ namespace SimpleComTest
 			Assert::AreEqual(true, setup.IsBatchMode());
 		}
 
+		TEST_METHOD(SerialNumberPortTest)
+		{
+			SimpleCom::SerialSetup setup;
+
+			LPCTSTR args[] = {
+				_T("SimpleCom.exe"), // argv[0] is an executable in main()
+				_T("serial:A50285BI")
+			};
+			setup.ParseArguments(sizeof(args) / sizeof(char*), args);
+			Assert::AreEqual(_T("serial:A50285BI"), setup.GetPort().c_str());
+
+			LPCTSTR empty_serial[] = {
+				_T("SimpleCom.exe"), // argv[0] is an executable in main()
+				_T("serial:")
+			};
+			auto test = [&] { setup.ParseArguments(sizeof(empty_serial) / sizeof(char*), empty_serial); };
+			Assert::ExpectException<SimpleCom::SerialSetupException>(test);
+		}
+
+		TEST_METHOD(UsbPortTest)
+		{
+			SimpleCom::SerialSetup setup;
+
+			LPCTSTR args[] = {
+				_T("SimpleCom.exe"), // argv[0] is an executable in main()
+				_T("usb:0403:6001:A50285BI")
+			};
+			setup.ParseArguments(sizeof(args) / sizeof(char*), args);
+			Assert::AreEqual(_T("usb:0403:6001:A50285BI"), setup.GetPort().c_str());
+
+			// PID is not 4 hex digits.
+			LPCTSTR invalid_pid[] = {
+				_T("SimpleCom.exe"), // argv[0] is an executable in main()
+				_T("usb:0403:601:A50285BI")
+			};
+			auto test = [&] { setup.ParseArguments(sizeof(invalid_pid) / sizeof(char*), invalid_pid); };
+			Assert::ExpectException<SimpleCom::SerialSetupException>(test);
+		}
+
 	};
 }
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "SessionPipeline.h"
+#include "WinAPIException.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	/*
+	 * In-memory backend. Completions are called on another thread if async is true, as the real backend does.
+	 */
+	class FakeStream : public SimpleCom::AsyncStream
+	{
+	private:
+		typedef struct {
+			TCompletion completion;
+			DWORD error;
+			DWORD transferred;
+		} TPendingCompletion;
+
+		static DWORD WINAPI CompletionThread(LPVOID lpParameter) {
+			TPendingCompletion* pending = reinterpret_cast<TPendingCompletion*>(lpParameter);
+			pending->completion(pending->error, pending->transferred);
+			delete pending;
+			return 0;
+		}
+
+		void Complete(TCompletion completion, DWORD error, DWORD transferred) {
+			if (!async) {
+				completion(error, transferred);
+				return;
+			}
+
+			HANDLE hThread = CreateThread(NULL, 0, &CompletionThread, new TPendingCompletion{ completion, error, transferred }, 0, NULL);
+			if (hThread == NULL) {
+				Assert::Fail(_T("CreateThread() failed"));
+			}
+			CloseHandle(hThread);
+		}
+
+	public:
+		std::deque<std::string> chunks;
+		std::string written;
+		bool async = false;
+		DWORD max_write = MAXDWORD;
+		DWORD read_error = ERROR_SUCCESS;
+		size_t read_pos = 0;
+
+		virtual void BeginRead(char* buf, DWORD len, TCompletion completion) override {
+			if (chunks.empty()) {
+				Complete(completion, read_error, 0);
+				return;
+			}
+
+			std::string& chunk = chunks.front();
+			size_t remain = chunk.length() - read_pos;
+			DWORD n = (remain < len) ? static_cast<DWORD>(remain) : len;
+			CopyMemory(buf, chunk.c_str() + read_pos, n);
+			read_pos += n;
+			if (read_pos == chunk.length()) {
+				chunks.pop_front();
+				read_pos = 0;
+			}
+			Complete(completion, ERROR_SUCCESS, n);
+		}
+
+		virtual void BeginWrite(const char* data, DWORD len, TCompletion completion) override {
+			DWORD n = (len < max_write) ? len : max_write;
+			written.append(data, n);
+			Complete(completion, ERROR_SUCCESS, n);
+		}
+	};
+
+	// Filter which replaces CR LF with LF.
+	class NewlineFilter : public SimpleCom::PipelineStage
+	{
+	public:
+		virtual SimpleCom::PipelineTask Process(const char* data, DWORD len) override {
+			std::string converted;
+			for (DWORD idx = 0; idx < len; idx++) {
+				if ((data[idx] != '\r') || (idx + 1 >= len) || (data[idx + 1] != '\n')) {
+					converted.push_back(data[idx]);
+				}
+			}
+			co_await Emit(converted.c_str(), static_cast<DWORD>(converted.length()));
+		}
+	};
+
+	TEST_CLASS(SessionPipelineTest)
+	{
+	public:
+
+		TEST_METHOD(StagesTest)
+		{
+			FakeStream source;
+			source.chunks = { "login:\r\n", "root\r\n" };
+			FakeStream console;
+			console.max_write = 3;  // Partial write should be continued.
+			FakeStream log;
+
+			std::vector<const char*> tapped;
+			SimpleCom::TapStage tap([&](const char* data, DWORD len) { tapped.push_back(data); });
+			SimpleCom::WriteStage console_writer(console);
+			NewlineFilter filter;
+			SimpleCom::WriteStage log_writer(log);
+
+			SimpleCom::SessionPipeline pipeline(source, 256);
+			pipeline.AddStage(&tap);
+			pipeline.AddStage(&console_writer);
+			pipeline.AddStage(&filter);
+			pipeline.AddStage(&log_writer);
+			pipeline.Run().Wait();
+
+			Assert::AreEqual(std::string("login:\r\nroot\r\n"), console.written);
+			Assert::AreEqual(std::string("login:\nroot\n"), log.written);
+
+			// Stages receive the buffer of the source as it is.
+			Assert::AreEqual(static_cast<size_t>(2), tapped.size());
+			Assert::IsTrue(tapped[0] == tapped[1]);
+		}
+
+		TEST_METHOD(AsyncCompletionTest)
+		{
+			FakeStream source;
+			source.async = true;
+			std::string expected;
+			for (int idx = 0; idx < 1000; idx++) {
+				std::string chunk = std::to_string(idx) + "\n";
+				source.chunks.push_back(chunk);
+				expected += chunk;
+			}
+			FakeStream dest;
+			dest.async = true;
+
+			SimpleCom::WriteStage writer(dest);
+			SimpleCom::SessionPipeline pipeline(source, 4);
+			pipeline.AddStage(&writer);
+			pipeline.Run().Wait();
+
+			Assert::AreEqual(expected, dest.written);
+		}
+
+		TEST_METHOD(SyncCompletionTest)
+		{
+			// Many chunks which are completed immediately should not consume the stack.
+			FakeStream source;
+			source.chunks.push_back(std::string(1024 * 1024, 'x'));
+			FakeStream dest;
+			dest.max_write = 1;
+
+			SimpleCom::WriteStage writer(dest);
+			SimpleCom::SessionPipeline pipeline(source, 1);
+			pipeline.AddStage(&writer);
+			pipeline.Run().Wait();
+
+			Assert::AreEqual(static_cast<size_t>(1024 * 1024), dest.written.length());
+		}
+
+		TEST_METHOD(WaitWithEventTest)
+		{
+			// Stages can be driven chunk by chunk from normal function (e.g. consumer of the RX ring) with one event.
+			FakeStream dest;
+			dest.async = true;
+			std::string tapped;
+			SimpleCom::TapStage tap([&](const char* data, DWORD len) { tapped.append(data, len); });
+			SimpleCom::WriteStage writer(dest);
+			tap.SetNext(&writer);
+
+			HANDLE hDoneEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+			tap.Process("abc", 3).Wait(hDoneEvent);
+			tap.Process("def", 3).Wait(hDoneEvent);
+			CloseHandle(hDoneEvent);
+
+			Assert::AreEqual(std::string("abcdef"), tapped);
+			Assert::AreEqual(std::string("abcdef"), dest.written);
+		}
+
+		TEST_METHOD(ErrorTest)
+		{
+			FakeStream source;
+			source.async = true;
+			source.chunks = { "abc" };
+			source.read_error = ERROR_ACCESS_DENIED;
+			FakeStream dest;
+
+			SimpleCom::WriteStage writer(dest);
+			SimpleCom::SessionPipeline pipeline(source, 256);
+			pipeline.AddStage(&writer);
+
+			try {
+				pipeline.Run().Wait();
+				Assert::Fail(_T("WinAPIException should be thrown"));
+			}
+			catch (SimpleCom::WinAPIException& e) {
+				Assert::AreEqual(static_cast<DWORD>(ERROR_ACCESS_DENIED), e.GetErrorCode());
+			}
+			Assert::AreEqual(std::string("abc"), dest.written);
+		}
+
+	};
+}
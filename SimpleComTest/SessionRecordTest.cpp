@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "SessionRecord.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(SessionRecordTest)
+	{
+	private:
+		std::string Header() {
+			std::string header("SCREC\x01\x00\x00", 8);
+			header.append(8, '\0');
+			return header;
+		}
+
+	public:
+
+		TEST_METHOD(VarintTest)
+		{
+			const ULONGLONG values[] = { 0, 1, 127, 128, 300, 0xffffffffULL, 0xffffffffffffffffULL };
+			std::string encoded;
+			for (auto value : values) {
+				SimpleCom::EncodeVarint(encoded, value);
+			}
+			// 300 = 0b10_0101100
+			Assert::AreEqual(std::string("\xac\x02", 2), encoded.substr(5, 2));
+
+			size_t pos = 0;
+			for (auto value : values) {
+				ULONGLONG decoded;
+				Assert::IsTrue(SimpleCom::DecodeVarint(encoded, &pos, &decoded));
+				Assert::AreEqual(value, decoded);
+			}
+			Assert::AreEqual(encoded.length(), pos);
+
+			// Truncated
+			ULONGLONG decoded;
+			pos = 0;
+			Assert::IsFalse(SimpleCom::DecodeVarint(std::string("\x80\x80", 2), &pos, &decoded));
+		}
+
+		TEST_METHOD(ReadTest)
+		{
+			std::string contents = Header();
+			contents += std::string("\x01\x00\x03" "abc", 6);   // RX at 0 us
+			contents += std::string("\x02\xe8\x07\x01" "x", 5); // TX at 1000 us
+			contents += std::string("\x01\x0a\x00", 3);         // RX at 1010 us, empty
+			SimpleCom::SessionReader reader(contents);
+			SimpleCom::TSessionRecord record;
+
+			Assert::IsTrue(reader.Next(&record));
+			Assert::IsTrue(record.type == SimpleCom::RecordType::RX);
+			Assert::AreEqual(static_cast<ULONGLONG>(0), record.timestamp_us);
+			Assert::AreEqual(std::string("abc"), std::string(record.data, record.len));
+
+			Assert::IsTrue(reader.Next(&record));
+			Assert::IsTrue(record.type == SimpleCom::RecordType::TX);
+			Assert::AreEqual(static_cast<ULONGLONG>(1000), record.timestamp_us);
+			Assert::AreEqual(std::string("x"), std::string(record.data, record.len));
+
+			Assert::IsTrue(reader.Next(&record));
+			Assert::AreEqual(static_cast<ULONGLONG>(1010), record.timestamp_us);
+			Assert::AreEqual(static_cast<DWORD>(0), record.len);
+
+			Assert::IsFalse(reader.Next(&record));
+		}
+
+		TEST_METHOD(BrokenRecordTest)
+		{
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::SessionReader reader("SCREC"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::SessionReader reader(std::string("SCREC\x02\x00\x00", 8) + std::string(8, '\0')); });
+
+			SimpleCom::TSessionRecord record;
+			SimpleCom::SessionReader unknown_type(Header() + std::string("\x03\x00\x00", 3));
+			Assert::ExpectException<std::invalid_argument>([&] { unknown_type.Next(&record); });
+
+			// Data is shorter than its length, e.g. SimpleCom was killed while recording.
+			SimpleCom::SessionReader truncated(Header() + std::string("\x01\x00\x05" "ab", 5));
+			Assert::ExpectException<std::invalid_argument>([&] { truncated.Next(&record); });
+		}
+
+	};
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "SessionStats.h"
+#include "util.h"
+
+
+constexpr LPCTSTR STATS_TESTFILENAME = _T("test.stats");
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(SessionStatsTest)
+	{
+	public:
+
+		TEST_METHOD_CLEANUP(Cleanup) {
+			DeleteFile(STATS_TESTFILENAME);
+		}
+
+		TEST_METHOD(CountersTest)
+		{
+			SimpleCom::SessionStats stats;
+			stats.RecordRead(100);
+			stats.RecordRead(28);
+			stats.RecordWrite(5);
+
+			// Errors from ClearCommError() might be combined.
+			stats.RecordCommErrors(0);
+			stats.RecordCommErrors(CE_OVERRUN | CE_FRAME);
+			stats.RecordCommErrors(CE_RXPARITY);
+
+			// Only slow writes should be counted as stalls.
+			stats.RecordConsoleWrite(1);
+			stats.RecordConsoleWrite(console_stall_threshold_ms + 50);
+
+			stats.RecordLogDepth(4096);
+			stats.RecordLogDepth(16);
+
+			auto snapshot = stats.Snapshot();
+			Assert::AreEqual(128ULL, snapshot.rx_bytes);
+			Assert::AreEqual(2ULL, snapshot.reads);
+			Assert::AreEqual(5ULL, snapshot.tx_bytes);
+			Assert::AreEqual(1ULL, snapshot.overruns);
+			Assert::AreEqual(1ULL, snapshot.framing_errors);
+			Assert::AreEqual(1ULL, snapshot.parity_errors);
+			Assert::AreEqual(0ULL, snapshot.breaks);
+			Assert::AreEqual(1ULL, snapshot.console_stalls);
+			Assert::AreEqual(console_stall_threshold_ms + 50, snapshot.console_max_stall_ms);
+			Assert::AreEqual(16ULL, snapshot.log_depth);
+			Assert::AreEqual(4096ULL, snapshot.log_max_depth);
+		}
+
+		TEST_METHOD(FormatOverlayTest)
+		{
+			SimpleCom::TStatsSnapshot prev = { .timestamp_ms = 1000, .rx_bytes = 1000, .reads = 10 };
+			SimpleCom::TStatsSnapshot current = { .timestamp_ms = 3000, .rx_bytes = 5000, .reads = 50, .overruns = 1, .rx_overflows = 1, .tx_bytes = 200 };
+
+			// Rates should be calculated from the difference in 2 seconds.
+			Assert::AreEqual(_T("RX 2000 B/s, 20 reads/s, avg 100 B | TX 100 B/s | overrun 2, framing 0, parity 0 | stall 0 | log queue 0 B"),
+				SimpleCom::SessionStats::FormatOverlay(current, prev).c_str());
+		}
+
+		TEST_METHOD(DumpTest)
+		{
+			SimpleCom::SessionStats stats;
+			stats.RecordRead(64);
+			stats.RecordCommErrors(CE_BREAK);
+			stats.Dump(STATS_TESTFILENAME);
+
+			std::string contents = ReadWholeFile(STATS_TESTFILENAME);
+			Assert::IsTrue(contents.find("rx_bytes: 64\r\n") != std::string::npos);
+			Assert::IsTrue(contents.find("avg_chunk_bytes: 64.00\r\n") != std::string::npos);
+			Assert::IsTrue(contents.find("breaks: 1\r\n") != std::string::npos);
+		}
+
+	};
+}
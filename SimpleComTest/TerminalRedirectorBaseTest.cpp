@@ -26,8 +26,14 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 static constexpr DWORD stdin_redirector_result = 100;
 static constexpr DWORD stdout_redirector_result = 200;
 
-static DWORD WINAPI RedirectorTestThreadEntry(_In_ LPVOID lpParameter) {
-	return reinterpret_cast<DWORD>(lpParameter);
+static DWORD WINAPI StdInRedirectorTestEntry(_In_ LPVOID lpParameter) {
+	*reinterpret_cast<DWORD*>(lpParameter) = stdin_redirector_result;
+	return 0;
+}
+
+static DWORD WINAPI StdOutRedirectorTestEntry(_In_ LPVOID lpParameter) {
+	*reinterpret_cast<DWORD*>(lpParameter) = stdout_redirector_result;
+	return 0;
 }
 
 namespace SimpleComTest
@@ -35,35 +41,37 @@ namespace SimpleComTest
 
 	class TestRedirector : public SimpleCom::TerminalRedirectorBase
 	{
+	private:
+		DWORD _stdin_result;
+		DWORD _stdout_result;
+
 	public:
-		TestRedirector() : SimpleCom::TerminalRedirectorBase(INVALID_HANDLE_VALUE) {}
+		TestRedirector() : SimpleCom::TerminalRedirectorBase(INVALID_HANDLE_VALUE), _stdin_result(-1), _stdout_result(-1) {}
+
+		virtual ~TestRedirector()
+		{
+			// Redirectors refer members of this class.
+			_tasks.Await();
+		}
 
 		virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdInRedirector() override
 		{
-			return { &RedirectorTestThreadEntry, reinterpret_cast<LPVOID>(stdin_redirector_result) };
+			return { &StdInRedirectorTestEntry, &_stdin_result };
 		}
 
 		virtual std::tuple<LPTHREAD_START_ROUTINE, LPVOID> GetStdOutRedirector() override
 		{
-			return { &RedirectorTestThreadEntry, reinterpret_cast<LPVOID>(stdout_redirector_result) };
+			return { &StdOutRedirectorTestEntry, &_stdout_result };
 		}
 
 		DWORD GetStdInRedirectorResult()
 		{
-			DWORD result;
-			if (!GetExitCodeThread(_hThreadStdIn, &result)) {
-				result = -1;
-			}
-			return result;
+			return _stdin_result;
 		}
 
 		DWORD GetStdOutRedirectorResult()
 		{
-			DWORD result;
-			if (!GetExitCodeThread(_hThreadStdOut, &result)) {
-				result = -1;
-			}
-			return result;
+			return _stdout_result;
 		}
 
 	};
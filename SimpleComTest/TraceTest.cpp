@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "Trace.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(TraceTest)
+	{
+	public:
+
+		TEST_METHOD(ChromeTraceTest)
+		{
+			LONGLONG start = SimpleCom::trace::Now();
+			SimpleCom::trace::Record("TraceTest::ChromeTraceTest", start, start);
+			{
+				SimpleCom::trace::Scope scope("TraceTest::Scope");
+			}
+
+			std::string json = SimpleCom::trace::FormatChromeTrace();
+			Assert::AreEqual(static_cast<size_t>(0), json.find("{\"traceEvents\":["));
+			Assert::IsTrue(json.find("\"name\":\"TraceTest::ChromeTraceTest\",\"ph\":\"X\"") != std::string::npos);
+			Assert::IsTrue(json.find("\"name\":\"TraceTest::Scope\"") != std::string::npos);
+		}
+
+		TEST_METHOD(WrapAroundTest)
+		{
+			// Only the latest events should be kept when the buffer is full.
+			HANDLE hThread = CreateThread(NULL, 0, [](LPVOID) -> DWORD {
+				for (DWORD idx = 0; idx < trace_buffer_events; idx++) {
+					SimpleCom::trace::Record("TraceTest::Old", 0, 0);
+				}
+				SimpleCom::trace::Record("TraceTest::New", 0, 0);
+				return 0;
+			}, NULL, 0, NULL);
+			if (hThread == NULL) {
+				Assert::Fail(_T("CreateThread() failed"));
+			}
+			WaitForSingleObject(hThread, INFINITE);
+			CloseHandle(hThread);
+
+			std::string json = SimpleCom::trace::FormatChromeTrace();
+			Assert::IsTrue(json.find("\"name\":\"TraceTest::New\"") != std::string::npos);
+
+			size_t old_events = 0;
+			for (size_t pos = json.find("TraceTest::Old"); pos != std::string::npos; pos = json.find("TraceTest::Old", pos + 1)) {
+				old_events++;
+			}
+			Assert::AreEqual(static_cast<size_t>(trace_buffer_events - 1), old_events);
+		}
+
+	};
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "pch.h"
+#include "CppUnitTest.h"
+
+#include "Trigger.h"
+#include "LogWriter.h"
+
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace SimpleComTest
+{
+	TEST_CLASS(TriggerTest)
+	{
+	public:
+
+		TEST_METHOD(ParseTest)
+		{
+			SimpleCom::TriggerSet triggers(
+				"# comment\n"
+				"on \"Kernel panic\" mark\n"
+				"on \"BUG:\" alert\n"
+				"on \"watchdog\" send \"\\x03\"\n"
+				"on \"panic\" exec \"snapshot.exe\"\n"
+				"on \"Switching to 1500000\" baud 1500000\n");
+			auto& list = triggers.GetTriggers();
+
+			Assert::AreEqual(static_cast<size_t>(5), list.size());
+			Assert::AreEqual(std::string("Kernel panic"), list[0].pattern);
+			Assert::IsTrue(list[0].action == SimpleCom::TriggerAction::MARK);
+			Assert::IsTrue(list[1].action == SimpleCom::TriggerAction::ALERT);
+			Assert::IsTrue(list[2].action == SimpleCom::TriggerAction::SEND);
+			Assert::AreEqual(std::string("\x03"), list[2].argument);
+			Assert::IsTrue(list[3].action == SimpleCom::TriggerAction::EXEC);
+			Assert::AreEqual(std::string("snapshot.exe"), list[3].argument);
+			Assert::AreEqual(5, list[3].line);
+			Assert::IsTrue(list[4].action == SimpleCom::TriggerAction::BAUD);
+			Assert::AreEqual(std::string("1500000"), list[4].argument);
+		}
+
+		TEST_METHOD(SyntaxErrorTest)
+		{
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("when \"a\" mark\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("on \"a\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("on \"a\" beep\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("on \"a\" mark \"b\"\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("on \"a\" send\n"); });
+			Assert::ExpectException<std::invalid_argument>([] { SimpleCom::TriggerSet triggers("on \"a\" baud \"115200\"\n"); });
+		}
+
+		TEST_METHOD(MarkTest)
+		{
+			SimpleCom::TriggerSet triggers("on \"panic\" mark\n");
+			SimpleCom::LogMarkerQueue markers;
+			SimpleCom::SerialHandle serial(INVALID_HANDLE_VALUE);
+			SimpleCom::TriggerEngine engine(triggers, serial, &markers, _T("test"));
+
+			// The pattern is split across chunks.
+			const std::string chunk1 = "Kernel pa";
+			const std::string chunk2 = "nic!\r\n";
+			std::string log;
+			auto writer = [&](const char* data, const DWORD len) { log.append(data, len); };
+
+			engine.Scan(chunk1.c_str(), static_cast<DWORD>(chunk1.length()), 0);
+			markers.Write(chunk1.c_str(), static_cast<DWORD>(chunk1.length()), 0, writer);
+			engine.Scan(chunk2.c_str(), static_cast<DWORD>(chunk2.length()), chunk1.length());
+			markers.Write(chunk2.c_str(), static_cast<DWORD>(chunk2.length()), chunk1.length(), writer);
+
+			Assert::AreEqual(static_cast<ULONGLONG>(1), engine.GetFiredCount());
+
+			// Marker should be placed just after the pattern.
+			Assert::AreEqual(static_cast<size_t>(0), log.find("Kernel panic\r\n[SimpleCom "));
+			Assert::IsTrue(log.find("] trigger: panic\r\n!\r\n") != std::string::npos);
+		}
+
+		TEST_METHOD(SendTest)
+		{
+			HANDLE hRead;
+			HANDLE hWrite;
+			if (!CreatePipe(&hRead, &hWrite, NULL, 0)) {
+				Assert::Fail(_T("CreatePipe() failed"));
+			}
+
+			{
+				SimpleCom::TriggerSet triggers("on \"login: \" send \"root\\r\"\n");
+				SimpleCom::SerialHandle serial(hWrite);
+				SimpleCom::TriggerEngine engine(triggers, serial, nullptr, _T("test"));
+				engine.Start();
+
+				engine.Scan("buildroot login: ", 17, 0);
+
+				char buf[6] = { 0 };
+				DWORD nBytesRead;
+				if (!ReadFile(hRead, buf, 5, &nBytesRead, NULL)) {
+					Assert::Fail(_T("ReadFile() failed"));
+				}
+				Assert::AreEqual("root\r", buf);
+			}
+
+			CloseHandle(hRead);
+			CloseHandle(hWrite);
+		}
+
+	};
+}
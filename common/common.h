@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2024, Yasumasa Suenaga
+ * Copyright (C) 2023, 2024, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -27,4 +27,47 @@
 /* marker (0x12) + ushort (up to 65535) + separator (;) + ushort + end marker */
 #define RINGBUF_SZ 13
 
+/*
+ * Protocol v2 (framed):
+ *
+ *   [0x12 (DC2)][#][type][length][payload...][CRC16][t]
+ *
+ * type, length, payload, and CRC16 are encoded in hex (2 chars per byte, big endian for CRC16).
+ * The frame should not contain any control chars because it goes through the line discipline of the target
+ * (e.g. 0x03 is VINTR, 0x11 / 0x13 are IXON, 0x0d is converted by ICRNL) before TTY Resizer sees it.
+ * CRC16 is CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff) of decoded type, length, and payload.
+ * Integers in payload are big endian.
+ *
+ * SimpleCom starts with v1. TTY Resizer which supports v2 replies the OSC below to v1 resize request and HELLO:
+ *
+ *   ESC ] 5379 ; [version] ; [capabilities in hex] BEL
+ *
+ * Then SimpleCom sends HELLO with its capabilities, and uses v2 from then.
+ * TTY Resizer which supports v1 only never replies, so SimpleCom keeps v1.
+ */
+#define RESIZER_V2_MARKER       '#'
+#define RESIZER_V2_MAX_PAYLOAD  16
+#define RESIZER_V2_OVERHEAD     11      // DC2 + marker + type (2) + length (2) + CRC16 (4) + end marker
+
+#define RESIZER_MSG_RESIZE      0x01    // rows (2 bytes), cols (2 bytes)
+#define RESIZER_MSG_KEEPALIVE   0x02    // sequence (4 bytes)
+#define RESIZER_MSG_CLOCK_SYNC  0x03    // UNIX time in microseconds (8 bytes)
+#define RESIZER_MSG_HELLO       0x04    // version (1 byte), capabilities (1 byte)
+
+#define RESIZER_CAP_KEEPALIVE   0x01
+#define RESIZER_CAP_CLOCK_SYNC  0x02
+#define RESIZER_CAPS            (RESIZER_CAP_KEEPALIVE | RESIZER_CAP_CLOCK_SYNC)
+
+#define RESIZER_PROTOCOL_VERSION 2
+#define RESIZER_REPLY_PREFIX     "\x1b]5379;"
+#define RESIZER_REPLY_TERMINATOR '\x07'  // BEL
+
+static inline unsigned short resizer_crc16_update(unsigned short crc, unsigned char data){
+  crc ^= (unsigned short)(data << 8);
+  for(int bit = 0; bit < 8; bit++){
+    crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) : (unsigned short)(crc << 1);
+  }
+  return crc;
+}
+
 #endif
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#define _GNU_SOURCE
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "common.h"
+#include "resize-parser.h"
+#include "resize-handler.h"
+#include "pty-proxy.h"
+
+/* Serial console does not send so much data at once, so this is enough. */
+#define PROXY_BUF_SZ 4096
+
+static volatile sig_atomic_t stop_requested = 0;
+
+
+static void on_stop(int signo){
+  (void)signo;
+  stop_requested = 1;
+}
+
+static int write_all(int fd, const char *buf, size_t len){
+  while(len > 0){
+    ssize_t written = write(fd, buf, len);
+    if(written == -1){
+      if(errno == EINTR){
+        continue;
+      }
+      return -1;
+    }
+    buf += written;
+    len -= written;
+  }
+  return 0;
+}
+
+/*
+ * Scrub resize sequences from buf in place, and apply completed ones to the pty.
+ * Reply to SimpleCom would be written to serial_fd.
+ * Returns the length of the data which should be passed to getty.
+ */
+static size_t filter_resize(struct resize_parser *parser, struct resize_session *session, int master_fd, int serial_fd, char *buf, size_t len){
+  struct resize_event event;
+  size_t out = 0;
+
+  for(size_t idx = 0; idx < len; idx++){
+    switch(resize_parser_feed(parser, buf[idx], &event)){
+      case PARSER_PASS:
+        buf[out++] = buf[idx];
+        break;
+      case PARSER_COMPLETED:
+        /* TIOCSWINSZ for the master is applied to the slave, and SIGWINCH would be sent to getty. */
+        handle_resize_event(session, master_fd, serial_fd, &event);
+        break;
+      default:
+        /* Consumed */
+        break;
+    }
+  }
+
+  return out;
+}
+
+static int open_serial(const char *serial){
+  struct termios tio;
+
+  int fd = open(serial, O_RDWR | O_NOCTTY);
+  if(fd == -1){
+    perror(serial);
+    return -1;
+  }
+
+  /* No line discipline in the proxy: line editing and echo are processed by getty side. */
+  if(tcgetattr(fd, &tio) == 0){
+    cfmakeraw(&tio);
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+
+  return fd;
+}
+
+static int open_pty(const char *pty_link, int *slave_fd){
+  struct stat statst;
+
+  int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if((master_fd == -1) || (grantpt(master_fd) == -1) || (unlockpt(master_fd) == -1)){
+    perror("posix_openpt");
+    return -1;
+  }
+
+  const char *slave = ptsname(master_fd);
+
+  /*
+   * Hold the slave in the proxy. Otherwise read() for the master would fail with EIO
+   * while getty is restarting.
+   */
+  *slave_fd = open(slave, O_RDWR | O_NOCTTY);
+  if(*slave_fd == -1){
+    perror(slave);
+    close(master_fd);
+    return -1;
+  }
+
+  /* Replace the stale link from previous run, but do not remove any other files. */
+  if((lstat(pty_link, &statst) == 0) && S_ISLNK(statst.st_mode)){
+    unlink(pty_link);
+  }
+  if(symlink(slave, pty_link) == -1){
+    perror(pty_link);
+    close(*slave_fd);
+    close(master_fd);
+    return -1;
+  }
+
+  return master_fd;
+}
+
+int run_pty_proxy(const char *pty_link, const char *serial){
+  struct resize_parser parser;
+  struct resize_session session = { .version_offered = false };
+  char buf[PROXY_BUF_SZ];
+  int slave_fd;
+  int ret = 0;
+
+  int serial_fd = open_serial(serial);
+  if(serial_fd == -1){
+    return -1;
+  }
+
+  int master_fd = open_pty(pty_link, &slave_fd);
+  if(master_fd == -1){
+    close(serial_fd);
+    return -2;
+  }
+
+  struct sigaction sa = { .sa_handler = on_stop };
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  resize_parser_reset(&parser);
+  struct pollfd fds[] = {
+    { .fd = serial_fd, .events = POLLIN },
+    { .fd = master_fd, .events = POLLIN }
+  };
+
+  while(!stop_requested){
+    if(poll(fds, 2, -1) == -1){
+      if(errno == EINTR){
+        continue;
+      }
+      perror("poll");
+      ret = -3;
+      break;
+    }
+
+    if(fds[0].revents & (POLLIN | POLLERR | POLLHUP)){
+      ssize_t len = read(serial_fd, buf, sizeof(buf));
+      if(len == 0){
+        /* The serial device is closed (e.g. USB serial is unplugged). */
+        fprintf(stderr, "Serial device is closed\n");
+        break;
+      }
+      else if(len == -1){
+        if(errno == EINTR || errno == EAGAIN){
+          continue;
+        }
+        perror("read from serial");
+        ret = -4;
+        break;
+      }
+      size_t out = filter_resize(&parser, &session, master_fd, serial_fd, buf, len);
+      if((out > 0) && (write_all(master_fd, buf, out) == -1)){
+        perror("write to pty");
+        ret = -5;
+        break;
+      }
+    }
+
+    if(fds[1].revents & (POLLIN | POLLERR | POLLHUP)){
+      ssize_t len = read(master_fd, buf, sizeof(buf));
+      if(len == 0){
+        fprintf(stderr, "pty is closed\n");
+        break;
+      }
+      else if(len == -1){
+        if(errno == EINTR || errno == EAGAIN){
+          continue;
+        }
+        perror("read from pty");
+        ret = -6;
+        break;
+      }
+      if(write_all(serial_fd, buf, len) == -1){
+        perror("write to serial");
+        ret = -7;
+        break;
+      }
+    }
+  }
+
+  unlink(pty_link);
+  close(slave_fd);
+  close(master_fd);
+  close(serial_fd);
+
+  return ret;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef PTY_PROXY_H
+#define PTY_PROXY_H
+
+/*
+ * Userspace fallback for kernels which cannot attach fexit/tty_read (no BTF, no fexit support).
+ * The proxy relays the serial device and a pty, and getty should run on the pty instead of the serial device.
+ * Resize sequences from the serial device are scrubbed in the proxy, and they are applied to the pty.
+ *
+ * pty_link: symlink to the slave of the pty which would be created by the proxy.
+ * serial:   serial device which SimpleCom connects to.
+ *
+ * This function would not return until the proxy is stopped by SIGINT / SIGTERM, or I/O error.
+ */
+int run_pty_proxy(const char *pty_link, const char *serial);
+
+#endif
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include "common.h"
+#include "resize-handler.h"
+
+
+static unsigned long long read_be(const unsigned char *buf, int len){
+  unsigned long long value = 0;
+  for(int idx = 0; idx < len; idx++){
+    value = (value << 8) | buf[idx];
+  }
+  return value;
+}
+
+/*
+ * Tell SimpleCom that v2 is available. caps is capabilities which both of SimpleCom and TTY Resizer support.
+ */
+static void reply_version(int reply_fd, unsigned char caps){
+  char reply[32];
+
+  int len = snprintf(reply, sizeof(reply), RESIZER_REPLY_PREFIX "%d;%02x%c", RESIZER_PROTOCOL_VERSION, caps, RESIZER_REPLY_TERMINATOR);
+  ssize_t written = write(reply_fd, reply, len);
+  if((written == -1) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))){
+    /* reply_fd might be non-blocking. SimpleCom keeps current version if the reply does not reach. */
+    fprintf(stderr, "Reply is dropped because the TTY is busy\n");
+  }
+  else if(written != len){
+    perror("reply");
+  }
+}
+
+void handle_resize_event(struct resize_session *session, int winsz_fd, int reply_fd, const struct resize_event *event){
+  if(event->version >= 2){
+    /* SimpleCom which connects next would start with v1 again. */
+    session->version_offered = false;
+  }
+
+  switch(event->type){
+    case RESIZER_MSG_RESIZE: {
+      struct winsize ws = {
+        .ws_row = event->rows,
+        .ws_col = event->cols
+      };
+      if(ioctl(winsz_fd, TIOCSWINSZ, &ws) == -1){
+        perror("ioctl");
+      }
+
+      /*
+       * SimpleCom starts with v1. The offer is sent only once because older SimpleCom or other v1 clients
+       * would show it as it is.
+       */
+      if((event->version == 1) && !session->version_offered){
+        reply_version(reply_fd, RESIZER_CAPS);
+        session->version_offered = true;
+      }
+      break;
+    }
+
+    case RESIZER_MSG_HELLO:
+      if(event->len >= 2){
+        reply_version(reply_fd, event->payload[1] & RESIZER_CAPS);
+      }
+      break;
+
+    case RESIZER_MSG_CLOCK_SYNC:
+      if(event->len >= 8){
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        long long local_us = ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+        long long offset_us = local_us - (long long)read_be(event->payload, 8);
+        fprintf(stderr, "Clock offset from SimpleCom: %lld us\n", offset_us);
+      }
+      break;
+
+    case RESIZER_MSG_KEEPALIVE:
+      /* Nothing to do. It is consumed so as not to reach to the TTY. */
+      break;
+
+    default:
+      fprintf(stderr, "Unknown message: %d\n", event->type);
+      break;
+  }
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef RESIZE_HANDLER_H
+#define RESIZE_HANDLER_H
+
+#include <stdbool.h>
+#include "resize-parser.h"
+
+/*
+ * Negotiation state with SimpleCom. It should be kept per TTY.
+ */
+struct resize_session {
+  bool version_offered;  // v2 has been offered for v1 request
+};
+
+/*
+ * Handle the event from the parser. It is shared between BPF mode and proxy mode.
+ *
+ * session: Negotiation state of the TTY which the event comes from.
+ * winsz_fd: TIOCSWINSZ would be issued to this fd for resize request.
+ * reply_fd: Reply for SimpleCom (OSC) would be written to this fd. It should reach to SimpleCom via the serial device.
+ */
+void handle_resize_event(struct resize_session *session, int winsz_fd, int reply_fd, const struct resize_event *event);
+
+#endif
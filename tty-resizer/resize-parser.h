@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef RESIZE_PARSER_H
+#define RESIZE_PARSER_H
+
+/*
+ * Parser for resize sequence: v1 ([0x12][Row];[Col]t) and v2 (framed, see common.h).
+ * This header is shared between the BPF program and userspace, so it should not depend on any headers.
+ * Both of them are decoded in one pass, one char at a time.
+ */
+
+#include "common.h"
+
+/* Record in the ring buffer. It would be sent when the request is completed. */
+struct resize_event {
+  unsigned long long ino;  /* inode of the TTY */
+  unsigned char version;   /* protocol version of the request */
+  unsigned char type;      /* RESIZER_MSG_* */
+  unsigned char len;       /* length of payload (v2 only) */
+  unsigned short rows;     /* RESIZER_MSG_RESIZE only */
+  unsigned short cols;     /* RESIZER_MSG_RESIZE only */
+  unsigned char payload[RESIZER_V2_MAX_PAYLOAD];
+};
+
+enum resize_parser_phase {
+  PARSER_IDLE = 0,
+  PARSER_ROWS,
+  PARSER_COLS,
+  PARSER_V2_TYPE,
+  PARSER_V2_LEN,
+  PARSER_V2_PAYLOAD,
+  PARSER_V2_CRC_HIGH,
+  PARSER_V2_CRC_LOW,
+  PARSER_V2_END
+};
+
+struct resize_parser {
+  int phase;
+  int digits;
+  unsigned int rows;
+  unsigned int cols;
+  unsigned char type;
+  unsigned char len;
+  unsigned char pos;
+  unsigned char has_nibble;
+  unsigned char high_nibble;
+  unsigned short crc;
+  unsigned short received_crc;
+  unsigned char payload[RESIZER_V2_MAX_PAYLOAD];
+};
+
+enum resize_parser_result {
+  PARSER_PASS = 0,   /* The char is not a part of the sequence. */
+  PARSER_CONSUMED,   /* The char is a part of the sequence. */
+  PARSER_COMPLETED   /* The char finishes the sequence, and the event is available. */
+};
+
+static inline void resize_parser_reset(struct resize_parser *parser){
+  parser->phase = PARSER_IDLE;
+  parser->digits = 0;
+  parser->rows = 0;
+  parser->cols = 0;
+  parser->len = 0;
+  parser->pos = 0;
+  parser->has_nibble = 0;
+}
+
+static inline int resize_parser_hex(char ch){
+  if(('0' <= ch) && (ch <= '9')){
+    return ch - '0';
+  }
+  if(('a' <= ch) && (ch <= 'f')){
+    return ch - 'a' + 10;
+  }
+  if(('A' <= ch) && (ch <= 'F')){
+    return ch - 'A' + 10;
+  }
+  return -1;
+}
+
+/*
+ * Feed one decoded byte of v2 frame. Too long frame is discarded silently.
+ */
+static inline void resize_parser_feed_v2(struct resize_parser *parser, unsigned char ch){
+  switch(parser->phase){
+    case PARSER_V2_TYPE:
+      parser->type = ch;
+      parser->crc = resizer_crc16_update(0xffff, ch);
+      parser->phase = PARSER_V2_LEN;
+      break;
+
+    case PARSER_V2_LEN:
+      if(ch > RESIZER_V2_MAX_PAYLOAD){
+        resize_parser_reset(parser);
+        break;
+      }
+      parser->len = ch;
+      parser->pos = 0;
+      parser->crc = resizer_crc16_update(parser->crc, ch);
+      parser->phase = (ch == 0) ? PARSER_V2_CRC_HIGH : PARSER_V2_PAYLOAD;
+      break;
+
+    case PARSER_V2_PAYLOAD:
+      /* Mask for the verifier. RESIZER_V2_MAX_PAYLOAD is power of 2. */
+      parser->payload[parser->pos & (RESIZER_V2_MAX_PAYLOAD - 1)] = ch;
+      parser->crc = resizer_crc16_update(parser->crc, ch);
+      if(++parser->pos >= parser->len){
+        parser->phase = PARSER_V2_CRC_HIGH;
+      }
+      break;
+
+    case PARSER_V2_CRC_HIGH:
+      parser->received_crc = (unsigned short)(ch << 8);
+      parser->phase = PARSER_V2_CRC_LOW;
+      break;
+
+    case PARSER_V2_CRC_LOW:
+      /* CRC would be checked at the end marker, then whole of the broken frame is consumed. */
+      parser->received_crc |= ch;
+      parser->phase = PARSER_V2_END;
+      break;
+
+    default:
+      resize_parser_reset(parser);
+      break;
+  }
+}
+
+/*
+ * Feed one char of v2 frame. Chars out of hex digits cancel the frame, and they are consumed.
+ * The event is available when the end marker follows valid CRC. Frame with CRC mismatch is discarded silently.
+ */
+static inline int resize_parser_feed_v2_char(struct resize_parser *parser, char ch, struct resize_event *event){
+  int nibble;
+
+  if(parser->phase == PARSER_V2_END){
+    if((ch != RESIZER_END_MARKER) || (parser->received_crc != parser->crc)){
+      resize_parser_reset(parser);
+      return PARSER_CONSUMED;
+    }
+
+    event->version = 2;
+    event->type = parser->type;
+    event->len = parser->len;
+    for(int idx = 0; idx < RESIZER_V2_MAX_PAYLOAD; idx++){
+      event->payload[idx] = parser->payload[idx];
+    }
+    if((parser->type == RESIZER_MSG_RESIZE) && (parser->len >= 4)){
+      event->rows = (unsigned short)((parser->payload[0] << 8) | parser->payload[1]);
+      event->cols = (unsigned short)((parser->payload[2] << 8) | parser->payload[3]);
+    }
+    resize_parser_reset(parser);
+    return PARSER_COMPLETED;
+  }
+
+  nibble = resize_parser_hex(ch);
+  if(nibble < 0){
+    resize_parser_reset(parser);
+  }
+  else if(!parser->has_nibble){
+    parser->high_nibble = (unsigned char)nibble;
+    parser->has_nibble = 1;
+  }
+  else{
+    parser->has_nibble = 0;
+    resize_parser_feed_v2(parser, (unsigned char)((parser->high_nibble << 4) | nibble));
+  }
+
+  return PARSER_CONSUMED;
+}
+
+/*
+ * Feed one char to the parser. v1 sequence is cancelled by RESIZER_CANCEL_MARKER or invalid chars,
+ * and they are consumed as well as valid chars.
+ */
+static inline int resize_parser_feed(struct resize_parser *parser, char ch, struct resize_event *event){
+  unsigned int *value;
+
+  if(parser->phase == PARSER_IDLE){
+    if(ch != RESIZER_START_MARKER){
+      return PARSER_PASS;
+    }
+    resize_parser_reset(parser);
+    parser->phase = PARSER_ROWS;
+    return PARSER_CONSUMED;
+  }
+
+  if(parser->phase >= PARSER_V2_TYPE){
+    return resize_parser_feed_v2_char(parser, ch, event);
+  }
+
+  if((ch == RESIZER_V2_MARKER) && (parser->phase == PARSER_ROWS) && (parser->digits == 0)){
+    parser->phase = PARSER_V2_TYPE;
+    return PARSER_CONSUMED;
+  }
+
+  value = (parser->phase == PARSER_ROWS) ? &parser->rows : &parser->cols;
+  if(('0' <= ch) && (ch <= '9')){
+    *value = *value * 10 + (ch - '0');
+    parser->digits++;
+    if(*value > 0xffff){
+      /* Out of unsigned short */
+      resize_parser_reset(parser);
+    }
+  }
+  else if((ch == *RESIZER_SEPARATOR) && (parser->phase == PARSER_ROWS) && (parser->digits > 0)){
+    parser->phase = PARSER_COLS;
+    parser->digits = 0;
+  }
+  else if((ch == RESIZER_END_MARKER) && (parser->phase == PARSER_COLS) && (parser->digits > 0)){
+    event->version = 1;
+    event->type = RESIZER_MSG_RESIZE;
+    event->len = 0;
+    event->rows = (unsigned short)parser->rows;
+    event->cols = (unsigned short)parser->cols;
+    resize_parser_reset(parser);
+    return PARSER_COMPLETED;
+  }
+  else{
+    /* RESIZER_CANCEL_MARKER or invalid char */
+    resize_parser_reset(parser);
+  }
+
+  return PARSER_CONSUMED;
+}
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Latency benchmark for the pty proxy mode of tty-resizer.
+ * A pty plays the serial device, and this benchmark plays both SimpleCom and getty.
+ * Latency of the proxy is compared with the direct pty. Root privilege is not needed.
+ *
+ * Usage: proxy-bench <path to tty-resizer> [samples]
+ */
+#define _GNU_SOURCE
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "common.h"
+
+/* Proxy should not add latency more than this. */
+#define MAX_ADDED_LATENCY_US 100.0
+
+#define DEFAULT_SAMPLES 10000
+#define STARTUP_WAIT_MS 2000
+
+
+static void sleep_ms(int ms){
+  struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+  nanosleep(&ts, NULL);
+}
+
+static double now_us(){
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000.0 + ts.tv_nsec / 1000.0;
+}
+
+static void make_raw(int fd){
+  struct termios tio;
+  tcgetattr(fd, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(fd, TCSANOW, &tio);
+}
+
+static int open_pty(int *master_fd, char *slave, size_t slave_sz){
+  *master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if((*master_fd == -1) || (grantpt(*master_fd) == -1) || (unlockpt(*master_fd) == -1)){
+    perror("posix_openpt");
+    return -1;
+  }
+  strncpy(slave, ptsname(*master_fd), slave_sz - 1);
+  slave[slave_sz - 1] = '\0';
+  return 0;
+}
+
+static int compare_double(const void *a, const void *b){
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Measure the time from write() on in_fd to read() on out_fd for one byte.
+ * Results are sorted.
+ */
+static int measure(int in_fd, int out_fd, double *results, int samples){
+  for(int idx = 0; idx < samples; idx++){
+    char ch = 'a' + (idx % 26);
+    char received;
+
+    double start = now_us();
+    if((write(in_fd, &ch, 1) != 1) || (read(out_fd, &received, 1) != 1)){
+      perror("transfer");
+      return -1;
+    }
+    results[idx] = now_us() - start;
+
+    if(received != ch){
+      fprintf(stderr, "Unexpected char: %02x\n", received);
+      return -2;
+    }
+  }
+
+  qsort(results, samples, sizeof(double), compare_double);
+  return 0;
+}
+
+static void report(const char *name, const double *results, int samples){
+  printf("%-6s: p50 %8.2f us, p99 %8.2f us, max %8.2f us\n",
+         name, results[samples / 2], results[samples * 99 / 100], results[samples - 1]);
+}
+
+/*
+ * Resize sequence should not be reached to getty, and the size should be applied to the pty.
+ */
+static bool check_resize(int serial_master_fd, int getty_fd){
+  char seq[32];
+  char received;
+  struct winsize ws;
+
+  snprintf(seq, sizeof(seq), "%c42" RESIZER_SEPARATOR "142%cz", RESIZER_START_MARKER, RESIZER_END_MARKER);
+  if(write(serial_master_fd, seq, strlen(seq)) != (ssize_t)strlen(seq)){
+    perror("write");
+    return false;
+  }
+  if((read(getty_fd, &received, 1) != 1) || (received != 'z')){
+    return false;
+  }
+
+  return (ioctl(getty_fd, TIOCGWINSZ, &ws) == 0) && (ws.ws_row == 42) && (ws.ws_col == 142);
+}
+
+int main(int argc, char *argv[]){
+  int direct_master_fd, serial_master_fd;
+  char direct_slave[64], serial_slave[64];
+  char pty_link[64];
+  int samples = DEFAULT_SAMPLES;
+
+  if((argc < 2) || (argc > 3)){
+    printf("Usage: %s <path to tty-resizer> [samples]\n", argv[0]);
+    return 1;
+  }
+  if(argc == 3){
+    samples = atoi(argv[2]);
+    if(samples < 100){
+      fprintf(stderr, "samples should be 100 or more\n");
+      return 1;
+    }
+  }
+
+  double *direct = (double *)malloc(sizeof(double) * samples);
+  double *proxied = (double *)malloc(sizeof(double) * samples);
+  if((direct == NULL) || (proxied == NULL)){
+    perror("malloc");
+    return 1;
+  }
+
+  /* Baseline: SimpleCom -> getty via pty */
+  if(open_pty(&direct_master_fd, direct_slave, sizeof(direct_slave)) != 0){
+    return 1;
+  }
+  int direct_slave_fd = open(direct_slave, O_RDWR | O_NOCTTY);
+  make_raw(direct_slave_fd);
+
+  /* Proxied: SimpleCom -> serial (pty) -> tty-resizer -> pty -> getty */
+  if(open_pty(&serial_master_fd, serial_slave, sizeof(serial_slave)) != 0){
+    return 1;
+  }
+  make_raw(serial_master_fd);
+  snprintf(pty_link, sizeof(pty_link), "/tmp/tty-resizer-bench.%d", getpid());
+
+  pid_t pid = fork();
+  if(pid == 0){
+    execl(argv[1], argv[1], "-p", pty_link, serial_slave, NULL);
+    perror("execl");
+    _exit(127);
+  }
+
+  int getty_fd = -1;
+  for(int elapsed = 0; (getty_fd == -1) && (elapsed < STARTUP_WAIT_MS); elapsed += 10){
+    sleep_ms(10);
+    getty_fd = open(pty_link, O_RDWR | O_NOCTTY);
+  }
+  if(getty_fd == -1){
+    perror(pty_link);
+    kill(pid, SIGTERM);
+    return 1;
+  }
+  make_raw(getty_fd);
+
+  int ret = 0;
+  if(!check_resize(serial_master_fd, getty_fd)){
+    printf("FAIL: resize sequence\n");
+    ret = 1;
+  }
+  else if((measure(direct_master_fd, direct_slave_fd, direct, samples) != 0) ||
+          (measure(serial_master_fd, getty_fd, proxied, samples) != 0)){
+    ret = 1;
+  }
+  else{
+    report("direct", direct, samples);
+    report("proxy", proxied, samples);
+
+    double added = proxied[samples / 2] - direct[samples / 2];
+    bool passed = added < MAX_ADDED_LATENCY_US;
+    printf("%s: added latency (p50) %.2f us\n", passed ? "PASS" : "FAIL", added);
+    ret = passed ? 0 : 1;
+  }
+
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  close(getty_fd);
+  close(serial_master_fd);
+  close(direct_slave_fd);
+  close(direct_master_fd);
+  free(proxied);
+  free(direct);
+
+  return ret;
+}
@@ -0,0 +1,557 @@
+/*
+ * Copyright (C) 2026, Yasumasa Suenaga
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+/*
+ * Test harness for tty-resizer with ptys.
+ * It runs tty-resizer for several ptys, and plays getty on the slave side of them.
+ * The stress test floods lines and resize sequences, then multiple bytes would be returned in one tty_read.
+ * BPF program should be loaded, so this harness should be run as root.
+ *
+ * Usage: pty-harness <path to tty-resizer>
+ */
+#define _GNU_SOURCE
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include "common.h"
+
+#define NUM_PTYS 3
+
+/* It should be same as MAX_TTYS in tty-resizer.bpf.c */
+#define MAX_WATCHED_TTYS 64
+
+/* tty-resizer should attach BPF program within this period. */
+#define STARTUP_WAIT_MS 2000
+
+#define WINSZ_WAIT_MS 1000
+
+/* Number of lines and resize sequences in the stress test */
+#define STRESS_ITERATIONS 20000
+
+struct pty {
+  int master_fd;
+  int slave_fd;
+  char path[64];
+};
+
+static int failures = 0;
+
+
+static void sleep_ms(int ms){
+  struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L };
+  nanosleep(&ts, NULL);
+}
+
+static int open_pty(struct pty *pty){
+  struct termios tio;
+
+  pty->master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if((pty->master_fd == -1) || (grantpt(pty->master_fd) == -1) || (unlockpt(pty->master_fd) == -1)){
+    perror("posix_openpt");
+    return -1;
+  }
+  strncpy(pty->path, ptsname(pty->master_fd), sizeof(pty->path) - 1);
+
+  pty->slave_fd = open(pty->path, O_RDWR | O_NOCTTY);
+  if(pty->slave_fd == -1){
+    perror(pty->path);
+    return -2;
+  }
+
+  /* Raw mode: every byte would be passed to read() as soon as it arrives. */
+  tcgetattr(pty->slave_fd, &tio);
+  cfmakeraw(&tio);
+  tcsetattr(pty->slave_fd, TCSANOW, &tio);
+
+  struct winsize ws = { .ws_row = 24, .ws_col = 80 };
+  ioctl(pty->slave_fd, TIOCSWINSZ, &ws);
+
+  return 0;
+}
+
+static int write_config(const char *config, struct pty *ptys, int num){
+  FILE *fp = fopen(config, "w");
+  if(fp == NULL){
+    perror(config);
+    return -1;
+  }
+
+  fprintf(fp, "# generated by pty-harness\n");
+  for(int idx = 0; idx < num; idx++){
+    fprintf(fp, "%s\n", ptys[idx].path);
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+/*
+ * Send data from the master, and read it on the slave as getty.
+ * The slave reads one byte per read() call.
+ * Bytes which are not scrubbed by tty-resizer are stored into passed.
+ */
+static int transfer(struct pty *pty, const char *data, size_t len, char *passed, size_t passed_sz){
+  size_t passed_len = 0;
+
+  if(write(pty->master_fd, data, len) != (ssize_t)len){
+    perror("write");
+    return -1;
+  }
+
+  for(size_t idx = 0; idx < len; idx++){
+    char ch;
+    if(read(pty->slave_fd, &ch, 1) != 1){
+      perror("read");
+      return -2;
+    }
+    if((ch != '\0') && (passed_len < passed_sz - 1)){
+      passed[passed_len++] = ch;
+    }
+  }
+  passed[passed_len] = '\0';
+
+  return 0;
+}
+
+static bool wait_winsize(struct pty *pty, unsigned short rows, unsigned short cols){
+  struct winsize ws;
+
+  for(int elapsed = 0; elapsed < WINSZ_WAIT_MS; elapsed += 10){
+    if((ioctl(pty->slave_fd, TIOCGWINSZ, &ws) == 0) && (ws.ws_row == rows) && (ws.ws_col == cols)){
+      return true;
+    }
+    sleep_ms(10);
+  }
+
+  return false;
+}
+
+static void expect(bool cond, const char *name, const struct pty *pty){
+  printf("%s: %s (%s)\n", cond ? "PASS" : "FAIL", name, pty->path);
+  if(!cond){
+    failures++;
+  }
+}
+
+/*
+ * The sequence should be consumed by tty-resizer, and the size should be applied.
+ */
+static void test_resize(struct pty *pty, unsigned short rows, unsigned short cols){
+  char seq[64];
+  char passed[64];
+
+  snprintf(seq, sizeof(seq), "a%c%hu" RESIZER_SEPARATOR "%hu%cb", RESIZER_START_MARKER, rows, cols, RESIZER_END_MARKER);
+  if(transfer(pty, seq, strlen(seq), passed, sizeof(passed)) != 0){
+    expect(false, "transfer", pty);
+    return;
+  }
+
+  expect(strcmp(passed, "ab") == 0, "sequence is scrubbed", pty);
+  expect(wait_winsize(pty, rows, cols), "window size is applied", pty);
+}
+
+/*
+ * The sequence should be passed through for TTYs which are not watched.
+ */
+static void test_unwatched(struct pty *pty){
+  char seq[64];
+  char passed[64];
+
+  snprintf(seq, sizeof(seq), "%c10" RESIZER_SEPARATOR "20%c", RESIZER_START_MARKER, RESIZER_END_MARKER);
+  if(transfer(pty, seq, strlen(seq), passed, sizeof(passed)) != 0){
+    expect(false, "transfer", pty);
+    return;
+  }
+
+  expect(strcmp(passed, seq) == 0, "sequence is passed through", pty);
+  expect(!wait_winsize(pty, 10, 20), "window size is not changed", pty);
+}
+
+/*
+ * Read data from the master (it is sent to SimpleCom) within timeout_ms.
+ */
+static size_t read_reply(struct pty *pty, char *buf, size_t buf_sz, int timeout_ms){
+  struct pollfd pfd = { .fd = pty->master_fd, .events = POLLIN };
+  size_t len = 0;
+
+  while((len < buf_sz - 1) && (poll(&pfd, 1, timeout_ms) == 1)){
+    ssize_t n = read(pty->master_fd, buf + len, buf_sz - 1 - len);
+    if(n <= 0){
+      break;
+    }
+    len += n;
+  }
+  buf[len] = '\0';
+
+  return len;
+}
+
+static size_t append_hex(char *buf, unsigned char value){
+  static const char hex[] = "0123456789abcdef";
+  buf[0] = hex[value >> 4];
+  buf[1] = hex[value & 0xf];
+  return 2;
+}
+
+static size_t build_v2_frame(char *buf, unsigned char type, const unsigned char *payload, unsigned char len){
+  unsigned short crc = 0xffff;
+  size_t pos = 0;
+
+  buf[pos++] = RESIZER_START_MARKER;
+  buf[pos++] = RESIZER_V2_MARKER;
+  pos += append_hex(buf + pos, type);
+  pos += append_hex(buf + pos, len);
+  crc = resizer_crc16_update(crc, type);
+  crc = resizer_crc16_update(crc, len);
+  for(int idx = 0; idx < len; idx++){
+    pos += append_hex(buf + pos, payload[idx]);
+    crc = resizer_crc16_update(crc, payload[idx]);
+  }
+  pos += append_hex(buf + pos, crc >> 8);
+  pos += append_hex(buf + pos, crc & 0xff);
+  buf[pos++] = RESIZER_END_MARKER;
+
+  return pos;
+}
+
+/*
+ * v2 should be offered only once for v1 requests, then v2 frames should be accepted.
+ * v2 should be offered again for v1 request after v2 frames (SimpleCom reconnects).
+ */
+static void test_v2(struct pty *pty){
+  char buf[128];
+  char passed[64];
+  char expected[32];
+  char offer[32];
+  size_t len;
+
+  /* Discard replies for previous tests. v2 has been offered for v1 request in them. */
+  read_reply(pty, buf, sizeof(buf), 100);
+
+  test_resize(pty, 33, 99);
+  snprintf(offer, sizeof(offer), RESIZER_REPLY_PREFIX "%d;%02x%c", RESIZER_PROTOCOL_VERSION, RESIZER_CAPS, RESIZER_REPLY_TERMINATOR);
+  read_reply(pty, buf, sizeof(buf), WINSZ_WAIT_MS);
+  expect(buf[0] == '\0', "v2 is offered only once", pty);
+
+  const unsigned char hello[] = { RESIZER_PROTOCOL_VERSION, RESIZER_CAP_CLOCK_SYNC };
+  buf[0] = 'a';
+  len = build_v2_frame(buf + 1, RESIZER_MSG_HELLO, hello, sizeof(hello)) + 1;
+  buf[len++] = 'b';
+  transfer(pty, buf, len, passed, sizeof(passed));
+  expect(strcmp(passed, "ab") == 0, "HELLO is scrubbed", pty);
+  snprintf(expected, sizeof(expected), RESIZER_REPLY_PREFIX "%d;%02x%c", RESIZER_PROTOCOL_VERSION, RESIZER_CAP_CLOCK_SYNC, RESIZER_REPLY_TERMINATOR);
+  read_reply(pty, buf, sizeof(buf), WINSZ_WAIT_MS);
+  expect(strcmp(buf, expected) == 0, "common capabilities are replied", pty);
+
+  /* Payload contains NUL and DC2 */
+  const unsigned char resize[] = { 0x00, 0x12, 0x01, 0x00 };
+  buf[0] = 'a';
+  len = build_v2_frame(buf + 1, RESIZER_MSG_RESIZE, resize, sizeof(resize)) + 1;
+  buf[len++] = 'b';
+  transfer(pty, buf, len, passed, sizeof(passed));
+  expect(strcmp(passed, "ab") == 0, "v2 resize is scrubbed", pty);
+  expect(wait_winsize(pty, 0x12, 0x100), "v2 resize is applied", pty);
+
+  /* Broken CRC */
+  const unsigned char broken[] = { 0x00, 0x10, 0x00, 0x20 };
+  buf[0] = 'a';
+  len = build_v2_frame(buf + 1, RESIZER_MSG_RESIZE, broken, sizeof(broken)) + 1;
+  buf[len - 2] = (buf[len - 2] == '0') ? '1' : '0';
+  buf[len++] = 'b';
+  transfer(pty, buf, len, passed, sizeof(passed));
+  expect(strcmp(passed, "ab") == 0, "broken frame is scrubbed", pty);
+  expect(!wait_winsize(pty, 0x10, 0x20), "broken frame is not applied", pty);
+
+  test_resize(pty, 34, 98);
+  read_reply(pty, buf, sizeof(buf), WINSZ_WAIT_MS);
+  expect(strcmp(buf, offer) == 0, "v2 is offered again after v2 frames", pty);
+}
+
+/*
+ * Send data from the master, and read one line on the slave in canonical mode.
+ * Bytes which are not scrubbed by tty-resizer are stored into passed.
+ */
+static int transfer_line(struct pty *pty, const char *data, size_t len, char *passed, size_t passed_sz){
+  struct pollfd pfd = { .fd = pty->slave_fd, .events = POLLIN };
+  size_t passed_len = 0;
+  char buf[256];
+
+  if(write(pty->master_fd, data, len) != (ssize_t)len){
+    perror("write");
+    return -1;
+  }
+
+  while((passed_len == 0) || (passed[passed_len - 1] != '\n')){
+    if(poll(&pfd, 1, WINSZ_WAIT_MS) != 1){
+      /* The line would not be completed if the line discipline eats the terminator. */
+      return -2;
+    }
+    ssize_t n = read(pty->slave_fd, buf, sizeof(buf));
+    if(n <= 0){
+      perror("read");
+      return -3;
+    }
+    for(ssize_t idx = 0; (idx < n) && (passed_len < passed_sz - 1); idx++){
+      if(buf[idx] != '\0'){
+        passed[passed_len++] = buf[idx];
+      }
+    }
+  }
+  passed[passed_len] = '\0';
+
+  return 0;
+}
+
+/*
+ * v2 frames should pass through the line discipline in cooked mode as they are.
+ * Their payload and CRC contain chars which are special for ISIG, ICANON, IXON, and ICRNL if they are sent in binary.
+ * IEXTEN is not enabled because DC2 (start marker since v1) is VREPRINT on it.
+ */
+static void test_v2_cooked(struct pty *pty){
+  struct termios raw;
+  struct termios cooked;
+  char buf[128];
+  char passed[64];
+  char expected[32];
+  size_t len;
+
+  tcgetattr(pty->slave_fd, &raw);
+  cooked = raw;
+  cooked.c_lflag |= ISIG | ICANON;
+  cooked.c_iflag |= IXON | ICRNL;
+  tcsetattr(pty->slave_fd, TCSANOW, &cooked);
+
+  /* Discard replies for previous tests. */
+  read_reply(pty, buf, sizeof(buf), 100);
+
+  /* Capabilities 0x03 is VINTR. */
+  const unsigned char hello[] = { RESIZER_PROTOCOL_VERSION, RESIZER_CAPS };
+  buf[0] = 'a';
+  len = build_v2_frame(buf + 1, RESIZER_MSG_HELLO, hello, sizeof(hello)) + 1;
+  buf[len++] = 'b';
+  buf[len++] = '\r';
+  expect((transfer_line(pty, buf, len, passed, sizeof(passed)) == 0) && (strcmp(passed, "ab\n") == 0), "HELLO is scrubbed in cooked mode", pty);
+  snprintf(expected, sizeof(expected), RESIZER_REPLY_PREFIX "%d;%02x%c", RESIZER_PROTOCOL_VERSION, RESIZER_CAPS, RESIZER_REPLY_TERMINATOR);
+  read_reply(pty, buf, sizeof(buf), WINSZ_WAIT_MS);
+  expect(strcmp(buf, expected) == 0, "HELLO is replied in cooked mode", pty);
+
+  /* rows is XOFF, and cols contains VSUSP. */
+  const unsigned char resize[] = { 0x00, 0x13, 0x01, 0x1a };
+  buf[0] = 'a';
+  len = build_v2_frame(buf + 1, RESIZER_MSG_RESIZE, resize, sizeof(resize)) + 1;
+  buf[len++] = 'b';
+  buf[len++] = '\r';
+  expect((transfer_line(pty, buf, len, passed, sizeof(passed)) == 0) && (strcmp(passed, "ab\n") == 0), "v2 resize is scrubbed in cooked mode", pty);
+  expect(wait_winsize(pty, 0x13, 0x11a), "v2 resize is applied in cooked mode", pty);
+
+  tcsetattr(pty->slave_fd, TCSANOW, &raw);
+}
+
+/*
+ * Reload with too many TTYs should fail without changing watched TTYs, and the next reload should succeed.
+ */
+static void test_failed_reload(pid_t pid, const char *config, struct pty *ptys){
+  struct pty all[MAX_WATCHED_TTYS + 1];
+
+  memcpy(all, ptys, sizeof(struct pty) * NUM_PTYS);
+  for(int idx = NUM_PTYS; idx < MAX_WATCHED_TTYS + 1; idx++){
+    if(open_pty(&all[idx]) != 0){
+      expect(false, "open extra pty", &ptys[0]);
+      return;
+    }
+  }
+
+  write_config(config, all, MAX_WATCHED_TTYS + 1);
+  kill(pid, SIGHUP);
+  sleep_ms(500);
+  test_resize(&ptys[0], 41, 121);
+  test_unwatched(&all[NUM_PTYS]);
+
+  /* Retry with the pty which is rejected above. */
+  write_config(config, all, NUM_PTYS + 1);
+  kill(pid, SIGHUP);
+  sleep_ms(500);
+  test_resize(&all[NUM_PTYS], 42, 122);
+  test_resize(&ptys[NUM_PTYS - 1], 43, 123);
+
+  write_config(config, ptys, NUM_PTYS);
+  kill(pid, SIGHUP);
+  sleep_ms(500);
+  for(int idx = NUM_PTYS; idx < MAX_WATCHED_TTYS + 1; idx++){
+    close(all[idx].slave_fd);
+    close(all[idx].master_fd);
+  }
+}
+
+static void stress_writer(struct pty *pty){
+  char line[32];
+  char seq[32];
+
+  for(int idx = 0; idx < STRESS_ITERATIONS; idx++){
+    int line_len = snprintf(line, sizeof(line), "line %05d\r\n", idx);
+    int seq_len = snprintf(seq, sizeof(seq), "%c%d" RESIZER_SEPARATOR "%d%c",
+                           RESIZER_START_MARKER, 20 + (idx % 50), 80 + (idx % 50), RESIZER_END_MARKER);
+
+    /* Some of sequences are split into two writes, then they might be split across tty_read calls. */
+    int split = (idx % 2 == 0) ? seq_len : (idx % seq_len);
+    if((write(pty->master_fd, line, line_len) != line_len) ||
+       (write(pty->master_fd, seq, split) != split) ||
+       (write(pty->master_fd, seq + split, seq_len - split) != seq_len - split)){
+      perror("write");
+      _exit(1);
+    }
+  }
+
+  _exit(0);
+}
+
+/*
+ * Flood lines and resize sequences, and read them in large chunks.
+ * Only lines should be reached to the slave, and the last size should be applied.
+ */
+static void test_stress(struct pty *pty){
+  char buf[4096];
+  char expected[32];
+  size_t expected_pos = 0;
+  int line_idx = 0;
+  bool matched = true;
+
+  snprintf(expected, sizeof(expected), "line %05d\r\n", line_idx);
+
+  pid_t writer = fork();
+  if(writer == 0){
+    stress_writer(pty);
+  }
+
+  /* Replies from tty-resizer should be read as SimpleCom. Otherwise they would be dropped. */
+  pid_t drainer = fork();
+  if(drainer == 0){
+    while(read(pty->master_fd, buf, sizeof(buf)) > 0);
+    _exit(0);
+  }
+
+  while(matched && (line_idx < STRESS_ITERATIONS)){
+    ssize_t len = read(pty->slave_fd, buf, sizeof(buf));
+    if(len <= 0){
+      perror("read");
+      matched = false;
+      break;
+    }
+
+    for(ssize_t idx = 0; idx < len; idx++){
+      if(buf[idx] == '\0'){
+        /* Scrubbed */
+        continue;
+      }
+      if(buf[idx] != expected[expected_pos]){
+        fprintf(stderr, "Unexpected char %02x at line %d\n", (unsigned char)buf[idx], line_idx);
+        matched = false;
+        break;
+      }
+      if(expected[++expected_pos] == '\0'){
+        snprintf(expected, sizeof(expected), "line %05d\r\n", ++line_idx);
+        expected_pos = 0;
+      }
+    }
+  }
+
+  if(!matched){
+    kill(writer, SIGTERM);
+  }
+  waitpid(writer, NULL, 0);
+  kill(drainer, SIGTERM);
+  waitpid(drainer, NULL, 0);
+
+  int last = STRESS_ITERATIONS - 1;
+  expect(matched, "only lines are passed under flood", pty);
+  expect(wait_winsize(pty, 20 + (last % 50), 80 + (last % 50)), "last window size is applied under flood", pty);
+}
+
+int main(int argc, char *argv[]){
+  struct pty ptys[NUM_PTYS];
+  char config[] = "/tmp/tty-resizer-harness-XXXXXX";
+
+  if(argc != 2){
+    printf("Usage: %s <path to tty-resizer>\n", argv[0]);
+    return 1;
+  }
+
+  int config_fd = mkstemp(config);
+  if(config_fd == -1){
+    perror("mkstemp");
+    return 1;
+  }
+  close(config_fd);
+
+  for(int idx = 0; idx < NUM_PTYS; idx++){
+    if(open_pty(&ptys[idx]) != 0){
+      return 1;
+    }
+  }
+  if(write_config(config, ptys, NUM_PTYS) != 0){
+    return 1;
+  }
+
+  pid_t pid = fork();
+  if(pid == 0){
+    execl(argv[1], argv[1], "-c", config, NULL);
+    perror("execl");
+    _exit(127);
+  }
+  sleep_ms(STARTUP_WAIT_MS);
+
+  /* All of ptys are watched by one daemon. */
+  for(int idx = 0; idx < NUM_PTYS; idx++){
+    test_resize(&ptys[idx], 30 + idx, 100 + idx);
+  }
+
+  /* Remove the last pty, and reload the config. */
+  write_config(config, ptys, NUM_PTYS - 1);
+  kill(pid, SIGHUP);
+  sleep_ms(500);
+  test_unwatched(&ptys[NUM_PTYS - 1]);
+  test_resize(&ptys[0], 40, 120);
+
+  /* Add it again. */
+  write_config(config, ptys, NUM_PTYS);
+  kill(pid, SIGHUP);
+  sleep_ms(500);
+  test_resize(&ptys[NUM_PTYS - 1], 50, 132);
+
+  test_failed_reload(pid, config, ptys);
+
+  test_v2(&ptys[1]);
+  test_v2_cooked(&ptys[2]);
+  test_stress(&ptys[0]);
+
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+  unlink(config);
+
+  printf("%s\n", (failures == 0) ? "ALL PASSED" : "FAILED");
+  return (failures == 0) ? 0 : 1;
+}
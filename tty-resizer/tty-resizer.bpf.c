@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, Yasumasa Suenaga
+ * Copyright (C) 2023, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -22,52 +22,121 @@
 #include <bpf/bpf_core_read.h>
 
 #include "common.h"
+#include "resize-parser.h"
+
+/* Ring buffer should be multiple of page size. */
+#define EVENT_RINGBUF_SZ 4096
+
+/* Max number of TTYs which can be watched at once */
+#define MAX_TTYS 64
+
+/* Max bytes to be scanned in one tty_read. It should be power of 2, and covers N_TTY_BUF_SIZE. */
+#define SCAN_BUF_SZ 4096
 
 char LICENSE[] SEC("license") = "GPL";
 
-volatile ino_t tty_ino = -1;
-volatile bool send_to_buffer = false;
-const int ringbuf_sz = RINGBUF_SZ;
+/*
+ * Watched TTYs (key: inode). Userspace adds / removes them at runtime.
+ * Parser state would be kept across tty_read calls per TTY.
+ */
+struct {
+  __uint(type, BPF_MAP_TYPE_HASH);
+  __uint(max_entries, MAX_TTYS);
+  __type(key, u64);
+  __type(value, struct resize_parser);
+} ttys SEC(".maps");
 
 struct {
   __uint(type, BPF_MAP_TYPE_RINGBUF);
-  __uint(max_entries, RINGBUF_SZ);
-} received_chars SEC(".maps");
+  __uint(max_entries, EVENT_RINGBUF_SZ);
+} resize_events SEC(".maps");
+
+/* Scratch buffer for tty_read. It is too large for BPF stack. */
+struct {
+  __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+  __uint(max_entries, 1);
+  __type(key, u32);
+  __type(value, char[SCAN_BUF_SZ]);
+} scan_buf SEC(".maps");
+
+struct scan_ctx {
+  struct resize_parser *parser;
+  struct resize_event *event;
+  char *buf;
+  bool scrubbed;
+};
+
+/*
+ * Callback for bpf_loop(). Chars of the resize sequence would be replaced with NUL.
+ */
+static long scan_char(u32 idx, void *data){
+  struct scan_ctx *ctx = (struct scan_ctx *)data;
+  int result;
+
+  /* Mask for the verifier. idx is less than SCAN_BUF_SZ. */
+  idx &= SCAN_BUF_SZ - 1;
+
+  result = resize_parser_feed(ctx->parser, ctx->buf[idx], ctx->event);
+  if(result == PARSER_PASS){
+    return 0;
+  }
+
+  /* Whole of the sequence would be sent in one record. */
+  if(result == PARSER_COMPLETED){
+    bpf_ringbuf_output(&resize_events, ctx->event, sizeof(*ctx->event), 0);
+  }
+
+  ctx->buf[idx] = '\0';
+  ctx->scrubbed = true;
+  return 0;
+}
 
 
 SEC("fexit/tty_read")
 int BPF_PROG(tty_read, struct kiocb *iocb, struct iov_iter *to, int ret){
-  char ch;
   void *ubuf;
+  u64 ino;
+  u32 zero = 0;
+  u32 len;
+  struct resize_parser *parser;
+  struct resize_event event;
+  struct scan_ctx ctx;
 
-  if (BPF_CORE_READ(iocb, ki_filp, f_inode, i_ino) != tty_ino){
+  if(ret <= 0){
     return 0;
   }
 
-  ubuf = BPF_CORE_READ(to, ubuf);
-  bpf_probe_read_user(&ch, 1, ubuf);
-  if(ch == RESIZER_START_MARKER){
-    send_to_buffer = true;
+  ino = BPF_CORE_READ(iocb, ki_filp, f_inode, i_ino);
+  parser = bpf_map_lookup_elem(&ttys, &ino);
+  if(parser == NULL){
+    /* Not a watched TTY */
+    return 0;
+  }
+  __builtin_memset(&event, 0, sizeof(event));
+  event.ino = ino;
 
-    ch = '\0';
-    bpf_probe_write_user(ubuf, &ch, 1);
+  ctx.buf = bpf_map_lookup_elem(&scan_buf, &zero);
+  if(ctx.buf == NULL){
+    return 0;
   }
-  else if(send_to_buffer){
-    u64 flags = BPF_RB_NO_WAKEUP;
-    if(ch == RESIZER_END_MARKER){
-      flags = BPF_RB_FORCE_WAKEUP;
-      send_to_buffer = false;
-    }
-    else if((ch != *RESIZER_SEPARATOR) && (('0' > ch) || ('9' < ch))){
-      /* handles invalid chars */
-      ch = RESIZER_CANCEL_MARKER;
-      flags = BPF_RB_FORCE_WAKEUP;
-      send_to_buffer = false;
-    }
-    bpf_ringbuf_output(&received_chars, &ch, 1, flags);
-
-    ch = '\0';
-    bpf_probe_write_user(ubuf, &ch, 1);
+
+  /*
+   * Multiple bytes might be returned under load. Scan all of them,
+   * and parser state in the map is kept for the sequence which continues to the next tty_read.
+   */
+  len = (ret > SCAN_BUF_SZ) ? SCAN_BUF_SZ : ret;
+  ubuf = BPF_CORE_READ(to, ubuf);
+  if(bpf_probe_read_user(ctx.buf, len, ubuf) != 0){
+    return 0;
+  }
+
+  ctx.parser = parser;
+  ctx.event = &event;
+  ctx.scrubbed = false;
+  bpf_loop(len, scan_char, &ctx, 0);
+
+  if(ctx.scrubbed){
+    bpf_probe_write_user(ubuf, ctx.buf, len);
   }
 
   return 0;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2023, 2025, Yasumasa Suenaga
+ * Copyright (C) 2023, 2025, 2026, Yasumasa Suenaga
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -22,71 +22,281 @@
 #include <limits.h>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <bpf/libbpf.h>
+#include <bpf/bpf.h>
 #include "tty-resizer.skel.h"
 #include "common.h"
+#include "resize-parser.h"
+#include "resize-handler.h"
+#include "pty-proxy.h"
 
 
-static char ttypath[PATH_MAX];
-static ino_t tty_ino;
+struct tty_entry {
+  unsigned long long ino;
+  char path[PATH_MAX];
+  int fd;  // opened at the first event, and kept while the TTY is watched
+  struct resize_session session;
+};
+
+static struct tty_entry *ttys = NULL;
+static int num_ttys = 0;
 static struct tty_resizer_bpf *skel = NULL;
 static struct ring_buffer *rb = NULL;
-static char *ringbuf_received = NULL;
-static int ringbuf_received_idx = 0;
+static volatile sig_atomic_t reload_requested = 0;
 
 
 static int libbpf_print(enum libbpf_print_level level, const char *format, va_list args){
   return vfprintf(stderr, format, args);
 }
 
-int on_char_received(void *ctx, void *data, size_t size){
-  char ch;
-  struct winsize ws;
-
-  ch = *(char *)data;
-  if(ch == RESIZER_END_MARKER){
-    ringbuf_received[ringbuf_received_idx] = '\0';
-    if(sscanf(ringbuf_received, "%hu" RESIZER_SEPARATOR "%hu", &ws.ws_row, &ws.ws_col) == 2){
-      int tty_fd = open(ttypath, O_RDONLY | O_NOCTTY);
-      if(tty_fd == -1){
-        perror("TTY open");
-        _exit(-100);
-      }
-      if(ioctl(tty_fd, TIOCSWINSZ, &ws) == -1){
-        perror("ioctl");
-        _exit(-200);
-      }
-      close(tty_fd);
-    }
-    ringbuf_received_idx = 0;
+static void on_sighup(int signo){
+  reload_requested = 1;
+}
+
+static void close_tty(struct tty_entry *entry){
+  if(entry->fd != -1){
+    close(entry->fd);
+    entry->fd = -1;
   }
-  else if(ch == RESIZER_CANCEL_MARKER){
-    ringbuf_received_idx = 0;
+}
+
+/*
+ * Returns the fd of the TTY. It is non-blocking because all of TTYs are handled in one thread.
+ */
+static int open_tty(struct tty_entry *entry){
+  struct pollfd pfd = { .fd = entry->fd, .events = 0 };
+
+  /* The fd would be hung up when getty calls vhangup(), then it should be reopened. */
+  if((entry->fd != -1) && (poll(&pfd, 1, 0) == 1) && (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))){
+    close_tty(entry);
   }
-  else{
-    ringbuf_received[ringbuf_received_idx++] = ch;
+
+  if(entry->fd == -1){
+    entry->fd = open(entry->path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  }
+  return entry->fd;
+}
+
+int on_resize_event(void *ctx, void *data, size_t size){
+  const struct resize_event *event = (const struct resize_event *)data;
+
+  for(int idx = 0; idx < num_ttys; idx++){
+    if(ttys[idx].ino != event->ino){
+      continue;
+    }
+
+    /* Other TTYs should be kept even if this TTY is not available. */
+    int tty_fd = open_tty(&ttys[idx]);
+    if(tty_fd == -1){
+      perror("TTY open");
+      return 0;
+    }
+    /* Reply to SimpleCom would be written to the TTY. */
+    handle_resize_event(&ttys[idx].session, tty_fd, tty_fd, event);
+    break;
   }
 
   return 0;
 }
 
-static int setup_tty(){
+static int add_tty(struct tty_entry **list, int *num, const char *path){
+  struct tty_entry entry;
   struct stat statst;
 
-  int tty_fd = open(ttypath, O_RDONLY | O_NOCTTY);
-  if(tty_fd == -1){
-    perror("open");
+  if(realpath(path, entry.path) == NULL){
+    perror(path);
     return -1;
   }
+  if((strncmp(entry.path, "/dev/tty", 8) != 0) && (strncmp(entry.path, "/dev/pts/", 9) != 0)){
+    fprintf(stderr, "Not a valid TTY device: %s\n", entry.path);
+    return -2;
+  }
 
+  int tty_fd = open(entry.path, O_RDONLY | O_NOCTTY);
+  if(tty_fd == -1){
+    perror("open");
+    return -3;
+  }
   if(fstat(tty_fd, &statst) == -1){
     perror("stat");
-    return -2;
+    close(tty_fd);
+    return -4;
   }
-  tty_ino = statst.st_ino;
   close(tty_fd);
+  entry.ino = statst.st_ino;
+  entry.fd = -1;
+  entry.session.version_offered = false;
+
+  for(int idx = 0; idx < *num; idx++){
+    if((*list)[idx].ino == entry.ino){
+      /* Duplicated */
+      return 0;
+    }
+  }
+
+  struct tty_entry *new_list = (struct tty_entry *)realloc(*list, sizeof(struct tty_entry) * (*num + 1));
+  if(new_list == NULL){
+    perror("realloc");
+    return -5;
+  }
+  new_list[(*num)++] = entry;
+  *list = new_list;
+
+  return 0;
+}
+
+/*
+ * Load TTY device files from the config file. Each line has one TTY device file, and `#` starts a comment.
+ */
+static int load_config(const char *config, struct tty_entry **list, int *num){
+  char line[PATH_MAX];
+
+  FILE *fp = fopen(config, "r");
+  if(fp == NULL){
+    perror(config);
+    return -1;
+  }
+
+  while(fgets(line, sizeof(line), fp) != NULL){
+    char *comment = strchr(line, '#');
+    if(comment != NULL){
+      *comment = '\0';
+    }
+
+    char *path = line + strspn(line, " \t");
+    path[strcspn(path, " \t\r\n")] = '\0';
+    if(*path == '\0'){
+      continue;
+    }
+
+    if(add_tty(list, num, path) != 0){
+      /* Skip invalid TTY, and watch others. */
+      fprintf(stderr, "Skipped: %s\n", path);
+    }
+  }
+
+  fclose(fp);
+  return 0;
+}
+
+static struct tty_entry *find_tty(struct tty_entry *list, int num, unsigned long long ino){
+  for(int idx = 0; idx < num; idx++){
+    if(list[idx].ino == ino){
+      return &list[idx];
+    }
+  }
+  return NULL;
+}
+
+static bool contains(struct tty_entry *list, int num, unsigned long long ino){
+  return find_tty(list, num, ino) != NULL;
+}
+
+static int watch_tty(int map_fd, unsigned long long ino){
+  struct resize_parser parser;
+
+  resize_parser_reset(&parser);
+  if((bpf_map_update_elem(map_fd, &ino, &parser, BPF_NOEXIST) != 0) && (errno != EEXIST)){
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * Replace watched TTYs with new_list. TTYs which are watched already keep their parser state.
+ * The map would be rolled back to current TTYs if new_list cannot be applied, so the map and ttys always agree.
+ */
+static int apply_ttys(struct tty_entry *new_list, int new_num){
+  int map_fd = bpf_map__fd(skel->maps.ttys);
+  int added;
+
+  if(new_num > (int)bpf_map__max_entries(skel->maps.ttys)){
+    fprintf(stderr, "Too many TTYs (%d)\n", new_num);
+    return -1;
+  }
+
+  /* Removed TTYs should be deleted at first to make a room for new TTYs. */
+  for(int idx = 0; idx < num_ttys; idx++){
+    if(!contains(new_list, new_num, ttys[idx].ino)){
+      bpf_map_delete_elem(map_fd, &ttys[idx].ino);
+    }
+  }
+
+  for(added = 0; added < new_num; added++){
+    if(!contains(ttys, num_ttys, new_list[added].ino) && (watch_tty(map_fd, new_list[added].ino) != 0)){
+      perror("bpf_map_update_elem");
+      break;
+    }
+  }
+
+  if(added < new_num){
+    for(int idx = 0; idx < added; idx++){
+      if(!contains(ttys, num_ttys, new_list[idx].ino)){
+        bpf_map_delete_elem(map_fd, &new_list[idx].ino);
+      }
+    }
+    /* Parser state of restored TTYs is reset. TTYs which cannot be restored are not watched anymore. */
+    int kept = 0;
+    for(int idx = 0; idx < num_ttys; idx++){
+      if(!contains(new_list, new_num, ttys[idx].ino) && (watch_tty(map_fd, ttys[idx].ino) != 0)){
+        perror("bpf_map_update_elem (rollback)");
+        fprintf(stderr, "Unwatched: %s\n", ttys[idx].path);
+        close_tty(&ttys[idx]);
+        continue;
+      }
+      ttys[kept++] = ttys[idx];
+    }
+    num_ttys = kept;
+    return -2;
+  }
+
+  /* Opened TTYs and their negotiation state are taken over to new_list. */
+  for(int idx = 0; idx < num_ttys; idx++){
+    struct tty_entry *entry = find_tty(new_list, new_num, ttys[idx].ino);
+    if(entry != NULL){
+      entry->fd = ttys[idx].fd;
+      entry->session = ttys[idx].session;
+    }
+    else{
+      close_tty(&ttys[idx]);
+    }
+  }
+
+  free(ttys);
+  ttys = new_list;
+  num_ttys = new_num;
+
+  return 0;
+}
+
+/*
+ * Collect TTYs from command line arguments and the config file, then apply them.
+ */
+static int load_ttys(int num_paths, char *paths[], const char *config){
+  struct tty_entry *new_list = NULL;
+  int new_num = 0;
+
+  for(int idx = 0; idx < num_paths; idx++){
+    if(add_tty(&new_list, &new_num, paths[idx]) != 0){
+      free(new_list);
+      return -1;
+    }
+  }
+
+  if((config != NULL) && (load_config(config, &new_list, &new_num) != 0)){
+    free(new_list);
+    return -2;
+  }
+
+  if(apply_ttys(new_list, new_num) != 0){
+    free(new_list);
+    return -3;
+  }
 
   return 0;
 }
@@ -100,49 +310,82 @@ static int setup_bpf(){
     return -1;
   }
 
-  skel->data->tty_ino = tty_ino;
-
   ret = tty_resizer_bpf__attach(skel);
   if(ret != 0){
     fprintf(stderr, "Could not attach BPF skeleton (%d)\n", ret);
     return -2;
   }
 
-  rb = ring_buffer__new(bpf_map__fd(skel->maps.received_chars), on_char_received, NULL, NULL);
+  rb = ring_buffer__new(bpf_map__fd(skel->maps.resize_events), on_resize_event, NULL, NULL);
   if (!rb) {
     fprintf(stderr, "Could not create ring buffer\n");
     return -3;
   }
 
-  ringbuf_received = (char *)malloc(skel->rodata->ringbuf_sz);
   return 0;
 }
 
+static void usage(const char *progname){
+  printf("Usage: %s [-v] [-c <config file>] [TTY device file...]\n", progname);
+  printf("       %s -p <pty link> <serial device file>\n", progname);
+}
+
 int main(int argc, char *argv[]){
-  if((argc == 3) && (strcmp(argv[1], "-v") == 0)){
-    libbpf_set_print(libbpf_print);
-    realpath(argv[2], ttypath);
+  int opt;
+  const char *config = NULL;
+  const char *pty_link = NULL;
+
+  while((opt = getopt(argc, argv, "vc:p:")) != -1){
+    switch(opt){
+      case 'v':
+        libbpf_set_print(libbpf_print);
+        break;
+      case 'c':
+        config = optarg;
+        break;
+      case 'p':
+        pty_link = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        return -100;
+    }
   }
-  else if(argc == 2){
-    realpath(argv[1], ttypath);
+
+  if(pty_link != NULL){
+    /* Proxy mode does not need BPF. */
+    if((config != NULL) || (argc - optind != 1)){
+      usage(argv[0]);
+      return -100;
+    }
+    return run_pty_proxy(pty_link, argv[optind]);
   }
-  else{
-    printf("Usage: %s <-v> [TTY device file]\n", argv[0]);
+
+  if((optind == argc) && (config == NULL)){
+    usage(argv[0]);
     return -100;
   }
 
-  if(strncmp(ttypath, "/dev/tty", 8) != 0){
-    fprintf(stderr, "Not a valid TTY device: %s\n", ttypath);
-    return -150;
-  }
+  /* ring_buffer__poll() should be interrupted by SIGHUP to reload the config. */
+  struct sigaction sa = { .sa_handler = on_sighup };
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGHUP, &sa, NULL);
 
-  if((setup_tty() == 0) && (setup_bpf() == 0)){
+  if((setup_bpf() == 0) && (load_ttys(argc - optind, argv + optind, config) == 0)){
     while(true){
       int ret = ring_buffer__poll(rb, -1);
       if (ret < 0 && errno != EINTR) {
         perror("ring_buffer__poll");
         break;
       }
+
+      if(reload_requested){
+        reload_requested = 0;
+        if(load_ttys(argc - optind, argv + optind, config) != 0){
+          /* Keep current TTYs */
+          fprintf(stderr, "Could not reload TTYs\n");
+        }
+      }
     }
   }
 
@@ -150,11 +393,14 @@ int main(int argc, char *argv[]){
     ring_buffer__free(rb);
   }
 
-  free(ringbuf_received);
-
   if(skel != NULL){
     tty_resizer_bpf__destroy(skel);
   }
 
+  for(int idx = 0; idx < num_ttys; idx++){
+    close_tty(&ttys[idx]);
+  }
+  free(ttys);
+
   return -1;
 }